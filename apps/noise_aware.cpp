@@ -33,7 +33,10 @@ int main(int argc, char** argv) {
         ("noise_prob_t1", "Probability for applying amplitude damping noise (default:2 x noise_prob)", cxxopts::value<std::optional<double>>())
         ("noise_prob_multi", "Noise factor for multi qubit operations", cxxopts::value<double>()->default_value("2"))
         ("unoptimized_sim", "Use unoptimized scheme for stochastic/deterministic noise-aware simulation")
+        ("measurement_threshold", "Deterministic simulation: basis states with a probability of at most this value are not reported", cxxopts::value<double>()->default_value("0.01"))
         ("stoch_runs", "Number of stochastic runs. When the value is 0, the deterministic simulator is started. ", cxxopts::value<std::size_t>()->default_value("0"))
+        ("stoch_target_error", "Stop the stochastic simulation early once all tracked amplitudes are known within +-this value (0 = always conduct all stoch_runs)", cxxopts::value<double>()->default_value("0"))
+        ("stoch_confidence", "Confidence level for the stoch_target_error stopping criterion", cxxopts::value<double>()->default_value("0.95"))
         ("properties", R"(Comma separated list of tracked amplitudes, when conducting a stochastic simulation. The "-" operator can be used to specify a range.)", cxxopts::value<std::string>()->default_value("0-100"))
 
     ; // end arguments list
@@ -78,6 +81,7 @@ int main(int argc, char** argv) {
                                                                   vm["steps"].as<unsigned int>(),
                                                                   vm["step_fidelity"].as<double>(),
                                                                   vm["seed"].as<std::size_t>());
+        ddsim->setTargetError(vm["stoch_target_error"].as<double>(), vm["stoch_confidence"].as<double>());
 
         auto t1 = std::chrono::steady_clock::now();
 
@@ -118,6 +122,7 @@ int main(int argc, char** argv) {
                                                                      noise_prob_t1,
                                                                      vm["noise_prob_multi"].as<double>(),
                                                                      vm.count("unoptimized_sim"), seed);
+        ddsim->setMeasurementThreshold(vm["measurement_threshold"].as<double>());
 
         auto t1 = std::chrono::steady_clock::now();
 
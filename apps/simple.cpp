@@ -1,6 +1,8 @@
 #include "CircuitSimulator.hpp"
 #include "GroverSimulator.hpp"
 #include "HybridSchrodingerFeynmanSimulator.hpp"
+#include "ModularArithmeticCache.hpp"
+#include "OperationStream.hpp"
 #include "ShorFastSimulator.hpp"
 #include "ShorSimulator.hpp"
 #include "Simulator.hpp"
@@ -17,6 +19,10 @@
 #include <memory>
 #include <string>
 
+#ifdef DDSIM_MPI
+#include <mpi.h>
+#endif
+
 namespace nl = nlohmann;
 
 int main(int argc, char** argv) {
@@ -33,9 +39,11 @@ int main(int argc, char** argv) {
         ("dump_complex", "dump edge weights in final state DD to file", cxxopts::value<std::string>())
         ("verbose", "Causes some simulators to print additional information to STDERR")
         ("simulate_file", "simulate a quantum circuit given by file (detection by the file extension)", cxxopts::value<std::string>())
+        ("simulate_file_streamed", "simulate an OpenQASM 2 file by streaming its operations from disk, which never holds the whole circuit in memory", cxxopts::value<std::string>())
         ("simulate_file_hybrid", "simulate a quantum circuit given by file (detection by the file extension) using the hybrid Schrodinger-Feynman simulator", cxxopts::value<std::string>())
-        ("hybrid_mode", "mode used for hybrid Schrodinger-Feynman simulation (*amplitude*, dd)", cxxopts::value<std::string>())
+        ("hybrid_mode", "mode used for hybrid Schrodinger-Feynman simulation (*amplitude*, shared_amplitude, dd)", cxxopts::value<std::string>())
         ("nthreads", "#threads used for hybrid simulation", cxxopts::value<unsigned int>()->default_value("2"))
+        ("hybrid_mpi", "distribute the slices of the hybrid simulation in an amplitude mode over all MPI ranks (requires DDSIM_MPI)")
         ("simulate_qft", "simulate Quantum Fourier Transform for given number of qubits", cxxopts::value<unsigned int>())
         ("simulate_ghz", "simulate state preparation of GHZ state for given number of qubits", cxxopts::value<unsigned int>())
         ("step_fidelity", "target fidelity for each approximation run (>=1 = disable approximation)", cxxopts::value<double>()->default_value("1.0"))
@@ -45,11 +53,18 @@ int main(int argc, char** argv) {
         ("simulate_grover", "simulate Grover's search for given number of qubits with random oracle", cxxopts::value<unsigned int>())
         ("simulate_grover_emulated", "simulate Grover's search for given number of qubits with random oracle and emulation", cxxopts::value<unsigned int>())
         ("simulate_grover_oracle_emulated", "simulate Grover's search for given number of qubits with given oracle and emulation", cxxopts::value<std::string>())
+        ("grover_strategy", "how the emulated Grover iteration is applied (*unrolled*, squaring, adaptive)", cxxopts::value<std::string>()->default_value("unrolled"))
         ("simulate_shor", "simulate Shor's algorithm factoring this number", cxxopts::value<unsigned int>())
         ("simulate_shor_coprime", "coprime number to use with Shor's algorithm (zero randomly generates a coprime)", cxxopts::value<unsigned int>()->default_value("0"))
         ("simulate_shor_no_emulation", "Force Shor simulator to do modular exponentiation instead of using emulation (you'll usually want emulation)")
         ("simulate_fast_shor", "simulate Shor's algorithm factoring this number with intermediate measurements", cxxopts::value<unsigned int>())
-        ("simulate_fast_shor_coprime","coprime number to use with Shor's algorithm (zero randomly generates a coprime)", cxxopts::value<unsigned int>()->default_value("0"));
+        ("simulate_fast_shor_coprime","coprime number to use with Shor's algorithm (zero randomly generates a coprime)", cxxopts::value<unsigned int>()->default_value("0"))
+        ("shor_cache_dir", "load the DDs of the modular arithmetic of Shor's algorithm from this directory and store the new ones there", cxxopts::value<std::string>())
+        ("checkpoint_file", "periodically write checkpoints of the simulation to this file", cxxopts::value<std::string>())
+        ("checkpoint_ops", "write a checkpoint after this many operations (0 = disabled)", cxxopts::value<std::size_t>()->default_value("0"))
+        ("checkpoint_seconds", "write a checkpoint after this many seconds (0 = disabled)", cxxopts::value<double>()->default_value("0"))
+        ("resume", "continue the simulation from the given checkpoint file", cxxopts::value<std::string>())
+        ("trace_file", "write a trace of all operations to this file (CSV for *.csv, Chrome trace JSON otherwise; requires DDSIM_TRACING)", cxxopts::value<std::string>());
     // clang-format on
 
     auto vm = options.parse(argc, argv);
@@ -58,6 +73,21 @@ int main(int argc, char** argv) {
         std::exit(0);
     }
 
+    int rank = 0;
+#ifdef DDSIM_MPI
+    if (vm.count("hybrid_mpi")) {
+        // only the main thread of every rank communicates
+        int provided = 0;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    }
+#else
+    if (vm.count("hybrid_mpi")) {
+        std::cerr << "Distributing the hybrid simulation requires DDSIM to be built with DDSIM_MPI\n";
+        std::exit(1);
+    }
+#endif
+
     const auto seed          = vm["seed"].as<unsigned long long>();
     const auto shots         = vm["shots"].as<unsigned int>();
     const auto nthreads      = vm["nthreads"].as<unsigned int>();
@@ -79,11 +109,22 @@ int main(int argc, char** argv) {
     std::unique_ptr<Simulator<dd::Package<>>> ddsim{nullptr};
     ApproximationInfo                         approx_info(step_fidelity, approx_steps, approx_when);
     const bool                                verbose = vm.count("verbose") > 0;
+    std::ifstream                             streamedFile;
+    std::unique_ptr<QasmOperationReader>      streamReader{nullptr};
 
     if (vm.count("simulate_file")) {
         const std::string fname = vm["simulate_file"].as<std::string>();
         quantumComputation      = std::make_unique<qc::QuantumComputation>(fname);
         ddsim                   = std::make_unique<CircuitSimulator<>>(std::move(quantumComputation), approx_info, seed);
+    } else if (vm.count("simulate_file_streamed")) {
+        const std::string fname = vm["simulate_file_streamed"].as<std::string>();
+        streamedFile.open(fname);
+        if (!streamedFile.good()) {
+            std::cerr << "Cannot open " << fname << "\n";
+            std::exit(1);
+        }
+        streamReader = std::make_unique<QasmOperationReader>(streamedFile);
+        ddsim        = std::make_unique<CircuitSimulator<>>(streamReader->circuit(), approx_info, seed);
     } else if (vm.count("simulate_file_hybrid")) {
         const std::string fname = vm["simulate_file_hybrid"].as<std::string>();
         quantumComputation      = std::make_unique<qc::QuantumComputation>(fname);
@@ -91,6 +132,8 @@ int main(int argc, char** argv) {
             const std::string mname = vm["hybrid_mode"].as<std::string>();
             if (mname == "amplitude") {
                 mode = HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude;
+            } else if (mname == "shared_amplitude") {
+                mode = HybridSchrodingerFeynmanSimulator<>::Mode::SharedAmplitude;
             } else if (mname == "dd") {
                 mode = HybridSchrodingerFeynmanSimulator<>::Mode::DD;
             }
@@ -100,6 +143,11 @@ int main(int argc, char** argv) {
         } else {
             ddsim = std::make_unique<HybridSchrodingerFeynmanSimulator<>>(std::move(quantumComputation), mode, nthreads);
         }
+#ifdef DDSIM_MPI
+        if (vm.count("hybrid_mpi")) {
+            dynamic_cast<HybridSchrodingerFeynmanSimulator<>*>(ddsim.get())->setCommunicator(MPI_COMM_WORLD);
+        }
+#endif
     } else if (vm.count("simulate_qft")) {
         const unsigned int n_qubits = vm["simulate_qft"].as<unsigned int>();
         quantumComputation          = std::make_unique<qc::QFT>(n_qubits);
@@ -126,10 +174,18 @@ int main(int argc, char** argv) {
         const unsigned int n_qubits = vm["simulate_grover"].as<unsigned int>();
         quantumComputation          = std::make_unique<qc::Grover>(n_qubits, seed);
         ddsim                       = std::make_unique<CircuitSimulator<>>(std::move(quantumComputation), approx_info, seed);
-    } else if (vm.count("simulate_grover_emulated")) {
-        ddsim = std::make_unique<GroverSimulator>(vm["simulate_grover_emulated"].as<unsigned int>(), seed);
-    } else if (vm.count("simulate_grover_oracle_emulated")) {
-        ddsim = std::make_unique<GroverSimulator>(vm["simulate_grover_oracle_emulated"].as<std::string>(), seed);
+    } else if (vm.count("simulate_grover_emulated") || vm.count("simulate_grover_oracle_emulated")) {
+        auto grover = vm.count("simulate_grover_emulated") ? std::make_unique<GroverSimulator>(vm["simulate_grover_emulated"].as<unsigned int>(), seed) : std::make_unique<GroverSimulator>(vm["simulate_grover_oracle_emulated"].as<std::string>(), seed);
+
+        const std::string strategy = vm["grover_strategy"].as<std::string>();
+        if (strategy == "squaring") {
+            grover->setIterationStrategy(GroverSimulator::IterationStrategy::RepeatedSquaring);
+        } else if (strategy == "adaptive") {
+            grover->setIterationStrategy(GroverSimulator::IterationStrategy::Adaptive);
+        } else if (strategy != "unrolled") {
+            throw std::runtime_error("Unknown Grover strategy '" + strategy + "'.");
+        }
+        ddsim = std::move(grover);
     } else if (vm.count("simulate_ghz")) {
         const unsigned int n_qubits = vm["simulate_ghz"].as<unsigned int>();
         quantumComputation          = std::make_unique<qc::Entanglement>(n_qubits);
@@ -144,12 +200,35 @@ int main(int argc, char** argv) {
         std::clog << "[WARNING] Quantum computation contains quite a few qubits. You're jumping into the deep end.\n";
     }
 
+    if (vm.count("checkpoint_file")) {
+        ddsim->setCheckpointing(vm["checkpoint_file"].as<std::string>(), vm["checkpoint_ops"].as<std::size_t>(), vm["checkpoint_seconds"].as<double>());
+    }
+    if (vm.count("resume")) {
+        ddsim->resumeFrom(vm["resume"].as<std::string>());
+    }
+    if (vm.count("trace_file")) {
+        ddsim->enableTracing();
+    }
+
+    if (vm.count("shor_cache_dir")) {
+        ModularArithmeticCache::instance().setEnabled(true);
+        ModularArithmeticCache::instance().load(vm["shor_cache_dir"].as<std::string>());
+    }
+
     auto t1 = std::chrono::high_resolution_clock::now();
-    auto m  = ddsim->Simulate(shots);
+    auto m  = streamReader ? dynamic_cast<CircuitSimulator<>*>(ddsim.get())->SimulateStream(streamReader->source(), shots) : ddsim->Simulate(shots);
     auto t2 = std::chrono::high_resolution_clock::now();
 
+    if (vm.count("shor_cache_dir")) {
+        ModularArithmeticCache::instance().save(vm["shor_cache_dir"].as<std::string>());
+    }
+
     std::chrono::duration<float> duration_simulation = t2 - t1;
 
+    if (vm.count("trace_file")) {
+        ddsim->writeTrace(vm["trace_file"].as<std::string>());
+    }
+
     if (vm.count("approx_state")) {
         // TargetFidelity
         ddsim->ApproximateByFidelity(1 / 100.0, false, false, true);
@@ -213,6 +292,16 @@ int main(int argc, char** argv) {
         }
     }
 
+#ifdef DDSIM_MPI
+    if (vm.count("hybrid_mpi")) {
+        MPI_Finalize();
+    }
+#endif
+    // every rank obtains the same result, which is printed once
+    if (rank != 0) {
+        return 0;
+    }
+
     nl::json output_obj;
 
     if (vm.count("pm")) {
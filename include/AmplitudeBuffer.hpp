@@ -0,0 +1,65 @@
+#ifndef DDSIM_AMPLITUDEBUFFER_HPP
+#define DDSIM_AMPLITUDEBUFFER_HPP
+
+#include "dd/Definitions.hpp"
+
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Dense, zero-initialized array of amplitudes. The memory is obtained from mmap, either anonymously or backed by a file,
+// and aligned to huge pages, so the kernel may back anonymous buffers with transparent huge pages. A file-backed buffer
+// holds the raw std::complex<dd::fp> values in native byte order, hence it can be opened without copying, e.g., by
+// np.memmap(file, dtype=np.complex128, mode="r"). The file remains when the buffer is destroyed.
+// The buffer is split into one contiguous chunk per thread, each being a multiple of a huge page. The chunks are zeroed in
+// parallel upon construction and forEachChunk hands them to the same number of threads, so with the first-touch policy of
+// NUMA systems every chunk tends to reside on the node of the thread processing it.
+class AmplitudeBuffer {
+public:
+    static constexpr std::size_t ALIGNMENT = 2U << 20U;
+
+    AmplitudeBuffer() = default;
+    // an empty file means anonymous memory; an existing file is overwritten
+    explicit AmplitudeBuffer(std::size_t size, std::string file = {}, unsigned int nThreads = std::thread::hardware_concurrency());
+    ~AmplitudeBuffer();
+
+    AmplitudeBuffer(AmplitudeBuffer&& other) noexcept;
+    AmplitudeBuffer& operator=(AmplitudeBuffer&& other) noexcept;
+    AmplitudeBuffer(const AmplitudeBuffer&)            = delete;
+    AmplitudeBuffer& operator=(const AmplitudeBuffer&) = delete;
+
+    [[nodiscard]] std::complex<dd::fp>*       data() { return amplitudes; }
+    [[nodiscard]] const std::complex<dd::fp>* data() const { return amplitudes; }
+    [[nodiscard]] std::size_t                 size() const { return length; }
+    [[nodiscard]] bool                        empty() const { return length == 0; }
+
+    std::complex<dd::fp>&       operator[](std::size_t i) { return amplitudes[i]; }
+    const std::complex<dd::fp>& operator[](std::size_t i) const { return amplitudes[i]; }
+
+    [[nodiscard]] std::complex<dd::fp>*       begin() { return amplitudes; }
+    [[nodiscard]] std::complex<dd::fp>*       end() { return amplitudes + length; }
+    [[nodiscard]] const std::complex<dd::fp>* begin() const { return amplitudes; }
+    [[nodiscard]] const std::complex<dd::fp>* end() const { return amplitudes + length; }
+
+    [[nodiscard]] const std::string& getFile() const { return file; }
+    [[nodiscard]] bool               isFileBacked() const { return !file.empty(); }
+
+    // writes the modified pages of a file-backed buffer to the file
+    void flush();
+
+    // calls f(begin, end) for every chunk [begin, end) on a thread of its own and rethrows the first exception of f
+    void forEachChunk(const std::function<void(std::size_t, std::size_t)>& f) const;
+
+private:
+    std::complex<dd::fp>* amplitudes  = nullptr;
+    std::size_t           length      = 0;
+    std::size_t           mappedBytes = 0;
+    std::string           file{};
+    unsigned int          nThreads = 1;
+
+    void release();
+};
+
+#endif //DDSIM_AMPLITUDEBUFFER_HPP
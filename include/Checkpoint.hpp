@@ -0,0 +1,60 @@
+#ifndef DDSIM_CHECKPOINT_HPP
+#define DDSIM_CHECKPOINT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <string>
+#include <vector>
+
+// Snapshot of a running state vector simulation: everything that is needed to continue with the operation at opIndex.
+struct Checkpoint {
+    std::uint32_t               nQubits     = 0;
+    std::uint64_t               nOps        = 0;
+    std::uint64_t               circuitHash = 0; // see Simulator::circuitHash
+    std::uint64_t               opIndex     = 0;
+    std::map<std::size_t, bool> classicValues{};
+    std::uint64_t               approximationRuns = 0;
+    double                      fidelity          = 1.;
+    std::vector<std::uint64_t>  extra{};    // simulator specific values, e.g., the coprime chosen in Shor's algorithm
+    std::string                 rngState{}; // std::mt19937_64 in its standard text representation
+    std::string                 state{};    // root edge in the binary format of dd::serialize
+
+    // Binary layout: magic, version, and the fields above in order; containers and strings are prefixed by their size.
+    void               write(const std::string& file) const;
+    static Checkpoint  read(const std::string& file);
+    static bool        exists(const std::string& file);
+    static const char* magic() { return "DDSIMCKP"; }
+
+    static constexpr std::uint32_t VERSION = 2U;
+};
+
+// Writes checkpoints in the background so the simulation does not wait for the file system. There is at most one write in
+// flight; a new checkpoint first waits for the previous one. A checkpoint is synced to disk before it atomically replaces the
+// previous file, so a crash never leaves a partial one.
+class CheckpointWriter {
+public:
+    CheckpointWriter() = default;
+    ~CheckpointWriter() {
+        if (pending.valid()) {
+            pending.wait();
+        }
+    }
+
+    CheckpointWriter(const CheckpointWriter&)            = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void write(Checkpoint checkpoint, const std::string& file);
+
+    // blocks until the pending write is done and rethrows its errors
+    void wait();
+
+    [[nodiscard]] std::size_t getWritten() const { return written; }
+
+private:
+    std::future<void> pending{};
+    std::size_t       written = 0;
+};
+
+#endif //DDSIM_CHECKPOINT_HPP
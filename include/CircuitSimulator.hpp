@@ -1,15 +1,19 @@
 #ifndef DDSIM_CIRCUITSIMULATOR_HPP
 #define DDSIM_CIRCUITSIMULATOR_HPP
 
+#include "OperationCache.hpp"
+#include "OperationStream.hpp"
 #include "QuantumComputation.hpp"
 #include "Simulator.hpp"
 
 #include <cstddef>
+#include <cstdint>
 #include <istream>
 #include <map>
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 struct ApproximationInfo {
     enum ApproximationWhen {
@@ -69,32 +73,147 @@ public:
         Simulator<DDPackage>::dd->resize(qc->getNqubits());
     }
 
+    // the pinned operation DDs have to be released while the package still exists
+    ~CircuitSimulator() override {
+        op_cache.clear(Simulator<DDPackage>::dd);
+    }
+
     std::map<std::string, std::size_t> Simulate(unsigned int shots) override;
 
+    // Computes only the amplitudes of the given basis states. The state is evolved up to the last projectedLayers layers of
+    // the circuit, which are instead applied in reverse (as inverses) to each requested basis state, so the final state is
+    // never built. The intermediate state is kept as the current state. Measurements and barriers are ignored.
+    virtual AmplitudeMap SimulateAmplitudes(const std::vector<std::size_t>& indices, std::size_t projectedLayers = 1);
+
     std::map<std::string, std::string> AdditionalStatistics() override {
-        return {
+        std::map<std::string, std::string> stats{
                 {"step_fidelity", std::to_string(approx_info.step_fidelity)},
                 {"approximation_runs", std::to_string(approximation_runs)},
                 {"final_fidelity", std::to_string(final_fidelity)},
                 {"single_shots", std::to_string(single_shots)},
+                {"branches", std::to_string(branches)},
+                {"fusion_max_width", std::to_string(fusion_max_width)},
+                {"fused_ops", std::to_string(fused_ops)},
+                {"fused_blocks", std::to_string(fused_blocks)},
+                {"op_cache_hits", std::to_string(op_cache.getHits())},
+                {"op_cache_misses", std::to_string(op_cache.getMisses())},
+                {"op_cache_size", std::to_string(op_cache.size())},
+                {"memory_limit", std::to_string(Simulator<DDPackage>::memory_limit)},
+                {"memory_limit_approximations", std::to_string(Simulator<DDPackage>::memory_limit_approximations)},
+                {"memory_limit_fidelity_loss", std::to_string(1.0 - memory_limit_fidelity)},
+                {"memory_limit_aborted_shots", std::to_string(memory_limit_aborts)},
+                {"checkpoints_written", std::to_string(Simulator<DDPackage>::getCheckpointsWritten())},
+                {"streamed_ops", std::to_string(streamed_ops)},
         };
+        stats.merge(Simulator<DDPackage>::GarbageCollectionStatistics());
+        return stats;
     };
 
+    // simulate circuits with intermediate measurements once per distinct measurement outcome instead of once per shot
+    void setShotBranching(bool enable) { shot_branching = enable; }
+
+    [[nodiscard]] bool getShotBranching() const { return shot_branching; }
+
+    // multiply runs of gates acting on at most maxWidth qubits into a single matrix DD before applying them (0 or 1 disables fusion)
+    void setGateFusion(std::size_t maxWidth) { fusion_max_width = maxWidth; }
+
+    [[nodiscard]] std::size_t getGateFusion() const { return fusion_max_width; }
+
+    // number of distinct operation DDs kept alive for reuse across operations and shots (0 disables the cache)
+    void setOperationCacheCapacity(std::size_t capacity) { op_cache.setCapacity(capacity); }
+
+    // Rotation angles of all RX, RY, RZ, P, U2, and U3 operations in circuit order; the angles of U2 and U3 are listed in
+    // Qiskit's argument order, i.e., (phi, lambda) and (theta, phi, lambda).
+    [[nodiscard]] static std::vector<dd::fp> parametersOf(const qc::QuantumComputation& circuit);
+
+    [[nodiscard]] std::vector<dd::fp> getParameters() const { return parametersOf(*qc); }
+
+    // Replaces the rotation angles (in the order of getParameters) and releases the state of the previous simulation, so
+    // the package and its operation cache can be reused for the next one.
+    void setParameters(const std::vector<dd::fp>& values);
+
+    // Sessions simulate a circuit incrementally: the state is kept across calls and advance() only applies the operations
+    // appended to the circuit (see getCircuit) since the previous call. A session is started implicitly by the first
+    // advance() and discarded by Simulate. Returns the number of operations that were applied.
+    std::size_t advance();
+
+    // restarts the session from the all-zero state with no operations applied
+    void startSession();
+
+    [[nodiscard]] std::size_t getAppliedOperations() const { return session_ops; }
+
+    [[nodiscard]] const std::map<std::size_t, bool>& getSessionClassicValues() const { return session_classic_values; }
+
+    // Pins the current state of the session by a reference on its DD and returns an id for restore. Snapshots share all
+    // nodes with the session state, so taking one is O(1).
+    std::size_t snapshot();
+
+    // Continues the session from the given snapshot, which stays valid, so several continuations can be tried from one
+    // state. The operations appended after the snapshot was taken are removed from the circuit.
+    void restore(std::size_t snapshotId);
+
+    void releaseSnapshot(std::size_t snapshotId);
+
+    // Simulates the operations yielded by source on the registers of the circuit given on construction (whose own operations
+    // are ignored) without ever storing them: a producer thread pulls the operations from source into a queue holding at
+    // most queueCapacity of them, while the calling thread applies and discards them. Hence, memory and start-up latency do
+    // not depend on the length of the stream. Measurements are deferred until another operation follows them, so final
+    // measurements are sampled for all shots; intermediate ones collapse the single pass and are only allowed for one shot.
+    std::map<std::string, std::size_t> SimulateStream(const OperationSource& source, unsigned int shots, std::size_t queueCapacity = 1024);
+
+    [[nodiscard]] std::size_t getStreamedOperations() const { return streamed_ops; }
+
+    [[nodiscard]] qc::QuantumComputation& getCircuit() { return *qc; }
+
     [[nodiscard]] dd::QubitCount getNumberOfQubits() const override { return qc->getNqubits(); };
 
     [[nodiscard]] std::size_t getNumberOfOps() const override { return qc->getNops(); };
 
     [[nodiscard]] std::string getName() const override { return qc->getName(); };
 
+    [[nodiscard]] bool supportsCheckpoints() const override { return true; }
+
 protected:
     std::unique_ptr<qc::QuantumComputation> qc;
     std::size_t                             single_shots{0};
+    bool                                    shot_branching{false};
+    std::size_t                             branches{0};
+    qc::VectorDD                            branch_state{};
+    std::size_t                             fusion_max_width{0};
+    std::size_t                             fused_ops{0};
+    std::size_t                             fused_blocks{0};
+    OperationCache<DDPackage>               op_cache{};
 
     const ApproximationInfo approx_info;
     std::size_t             approximation_runs{0};
     long double             final_fidelity{1.0L};
+    double                  memory_limit_fidelity{1.0};
+    std::size_t             memory_limit_aborts{0};
+
+    struct SessionSnapshot {
+        qc::VectorDD                edge{};
+        std::size_t                 ops = 0;
+        std::map<std::size_t, bool> classicValues{};
+    };
+
+    bool                                   session_started{false};
+    std::size_t                            session_ops{0};
+    std::map<std::size_t, bool>            session_classic_values{};
+    std::map<std::size_t, SessionSnapshot> snapshots{};
+    std::size_t                            next_snapshot{0};
+
+    std::size_t streamed_ops{0};
+
+    // checkpointing enables writing and resuming checkpoints, which is only meaningful if the circuit is simulated just once
+    std::map<std::size_t, bool> single_shot(bool ignore_nonunitaries, bool checkpointing = false);
+
+    // applies a single operation to the current state, as done by sessions and streams, reading and writing classic_values
+    void apply_operation(const qc::Operation& op, std::size_t index, std::map<std::size_t, bool>& classic_values);
+
+    void branch_shots(std::size_t op_idx, std::size_t measurement_idx, std::map<std::size_t, bool> classic_values, std::size_t shots, std::map<std::string, std::size_t>& m_counter);
 
-    std::map<std::size_t, bool> single_shot(bool ignore_nonunitaries);
+    // hash of the types, qubits, and parameters of all operations
+    [[nodiscard]] std::uint64_t circuitHash() const override;
 };
 
 #endif //DDSIM_CIRCUITSIMULATOR_HPP
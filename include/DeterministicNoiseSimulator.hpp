@@ -5,6 +5,13 @@
 #include "StochasticNoiseSimulator.hpp"
 #include "dd/NoiseFunctionality.hpp"
 
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
 template<class DDPackage = DensityMatrixPackage>
 class DeterministicNoiseSimulator: public Simulator<DDPackage> {
 public:
@@ -31,14 +38,55 @@ public:
     explicit DeterministicNoiseSimulator(std::unique_ptr<qc::QuantumComputation>& qc, unsigned long long seed = 0):
         DeterministicNoiseSimulator(qc, std::string("APD"), 0.001, std::optional<double>{}, 2, false, seed) {}
 
+    // basis states (bit i of the index is qubit i) and their probabilities, sorted by index
+    using SparseProbabilities = std::vector<std::pair<std::uint64_t, dd::fp>>;
+    // basis states and the number of shots they were sampled in, sorted by index
+    using SparseCounts = std::vector<std::pair<std::uint64_t, std::size_t>>;
+
     std::map<std::string, std::size_t> Simulate(unsigned int shots) override {
-        return sampleFromProbabilityMap(this->DeterministicSimulate(), shots);
+        std::map<std::string, std::size_t> result;
+        for (const auto& [index, count]: sampleIndices(DeterministicSimulateSparse(), shots)) {
+            result.emplace(toBitString(index), count);
+        }
+        return result;
     };
 
+    std::map<std::string, std::string> AdditionalStatistics() override {
+        auto stats                     = Simulator<DDPackage>::GarbageCollectionStatistics();
+        stats["memory_limit"]          = std::to_string(Simulator<DDPackage>::memory_limit);
+        stats["memory_limit_exceeded"] = Simulator<DDPackage>::memory_limit_exceeded ? "1" : "0";
+        return stats;
+    }
+
     std::map<std::string, dd::fp> DeterministicSimulate();
 
+    // like DeterministicSimulate, but without building a string for each basis state
+    SparseProbabilities DeterministicSimulateSparse();
+
     std::map<std::string, std::size_t> sampleFromProbabilityMap(const std::map<std::string, dd::fp>& resultProbabilityMap, unsigned int shots);
 
+    // draws shots samples in a single pass using an alias table over probabilities
+    SparseCounts sampleIndices(const SparseProbabilities& probabilities, unsigned int shots);
+
+    // the bitstring of a basis state as used by DeterministicSimulate, i.e., with qubit 0 first
+    [[nodiscard]] std::string toBitString(std::uint64_t index) const {
+        std::string bits(qc->getNqubits(), '0');
+        for (std::size_t i = 0; i < bits.size(); ++i) {
+            bits[i] = ((index >> i) & 1U) != 0U ? '1' : '0';
+        }
+        return bits;
+    }
+
+    // basis states with a probability of at most threshold are dropped from the results
+    void setMeasurementThreshold(double threshold) {
+        if (threshold < 0.) {
+            throw std::invalid_argument("The measurement threshold must not be negative.");
+        }
+        measurementThreshold = threshold;
+    }
+
+    [[nodiscard]] double getMeasurementThreshold() const { return measurementThreshold; }
+
     [[nodiscard]] dd::QubitCount getNumberOfQubits() const override { return qc->getNqubits(); };
 
     [[nodiscard]] std::size_t getNumberOfOps() const override { return qc->getNops(); };
@@ -71,8 +119,13 @@ private:
     const double noiseProbMultiQubit{};
     const double ampDampingProbMultiQubit{};
 
-    const double measurementThreshold = 0.01;
+    double measurementThreshold = 0.01;
 
     const bool sequentiallyApplyNoise{};
     const bool useDensityMatrixType{};
+
+    void simulateDensityMatrix();
+
+    // diagonal entries of rootEdge above measurementThreshold, found by a DFS that skips subtrees which cannot exceed it
+    SparseProbabilities extractProbabilities();
 };
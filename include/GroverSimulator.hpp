@@ -4,11 +4,20 @@
 #include "QuantumComputation.hpp"
 #include "Simulator.hpp"
 
+#include <array>
 #include <cmath>
+#include <string>
 #include <utility>
 
 class GroverSimulator: public Simulator<dd::Package<>> {
 public:
+    // how the Grover iteration is applied `iterations` times to the state
+    enum class IterationStrategy {
+        Unrolled,         // one matrix-vector product per iteration
+        RepeatedSquaring, // square the iteration DD and apply the powers selected by the binary representation of iterations
+        Adaptive          // repeated squaring as long as the squares stay compact, unrolled with the last square otherwise
+    };
+
     explicit GroverSimulator(const std::string& oracle, const unsigned long long seed):
         Simulator(seed),
         oracle{oracle.rbegin(), oracle.rend()},
@@ -38,12 +47,20 @@ public:
     std::map<std::string, std::size_t> Simulate(unsigned int shots) override;
 
     std::map<std::string, std::string> AdditionalStatistics() override {
+        static const std::array<std::string, 3> strategies{"unrolled", "repeated_squaring", "adaptive"};
         return {
                 {"oracle", std::string(oracle.rbegin(), oracle.rend())},
                 {"iterations", std::to_string(iterations)},
+                {"iteration_strategy", strategies.at(static_cast<std::size_t>(strategy))},
+                {"matrix_squarings", std::to_string(matrix_squarings)},
+                {"state_multiplications", std::to_string(state_multiplications)},
         };
     }
 
+    void setIterationStrategy(IterationStrategy newStrategy) { strategy = newStrategy; }
+
+    [[nodiscard]] IterationStrategy getIterationStrategy() const { return strategy; }
+
     static unsigned long long CalculateIterations(const unsigned short n_qubits) {
         constexpr long double PI_4 = 0.785398163397448309615660845819875721049292349843776455243L; // dd::PI_4 is of type fp and hence possibly smaller than long double
         if (n_qubits <= 3) {
@@ -66,6 +83,16 @@ protected:
     const dd::QubitCount n_qubits;
     const dd::QubitCount n_anciallae = 1;
     const std::size_t    iterations;
+
+    IterationStrategy strategy{IterationStrategy::Unrolled};
+    std::size_t       matrix_squarings{0};
+    std::size_t       state_multiplications{0};
+
+    // the adaptive strategy stops squaring once a square has this many times the nodes of the single iteration
+    static constexpr std::size_t ADAPTIVE_MAX_GROWTH = 16U;
+
+    void applyUnrolled(const qc::MatrixDD& op, std::size_t repetitions);
+    void applyRepeatedSquaring(const qc::MatrixDD& op, std::size_t repetitions, bool adaptive);
 };
 
 #endif //DDSIM_GROVERSIMULATOR_HPP
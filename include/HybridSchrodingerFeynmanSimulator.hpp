@@ -1,6 +1,7 @@
 #ifndef DDSIM_HYBRIDSCHRODINGERFEYNMANSIMULATOR_HPP
 #define DDSIM_HYBRIDSCHRODINGERFEYNMANSIMULATOR_HPP
 
+#include "AmplitudeBuffer.hpp"
 #include "CircuitOptimizer.hpp"
 #include "CircuitSimulator.hpp"
 #include "QuantumComputation.hpp"
@@ -8,14 +9,34 @@
 #include "dd/Package.hpp"
 
 #include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 
-template<class DDPackage = dd::Package<>>
+#ifdef DDSIM_MPI
+#include "SliceDistribution.hpp"
+
+#include <mpi.h>
+#endif
+
+namespace tf {
+    class Executor;
+} // namespace tf
+
+// The slices are simulated in packages of type SliceDDPackage, one per worker thread, whose tables can be tuned
+// independently of the package holding the final state (see HybridSlicePackage).
+template<class DDPackage = dd::Package<>, class SliceDDPackage = HybridSlicePackage>
 class HybridSchrodingerFeynmanSimulator: public CircuitSimulator<DDPackage> {
 public:
     enum class Mode {
         DD,
-        Amplitude
+        Amplitude,
+        // like Amplitude, but all threads accumulate into a single shared state vector instead of one vector per thread
+        SharedAmplitude
     };
 
     explicit HybridSchrodingerFeynmanSimulator(std::unique_ptr<qc::QuantumComputation>&& qc, Mode mode = Mode::Amplitude, const std::size_t nthreads = 2):
@@ -32,22 +53,127 @@ public:
 
     std::map<std::string, std::size_t> Simulate(unsigned int shots) override;
 
-    Mode                                                   mode = Mode::Amplitude;
-    [[nodiscard]] const std::vector<std::complex<dd::fp>>& getFinalAmplitudes() const { return finalAmplitudes; }
+    // Sums the amplitudes of the given basis states over all slices, each being the product of the amplitudes read off the
+    // lower and the upper slice DD, so neither the slices' Kronecker products nor the final state are ever built.
+    // projectedLayers is ignored.
+    AmplitudeMap SimulateAmplitudes(const std::vector<std::size_t>& indices, std::size_t projectedLayers = 1) override;
+
+    Mode                                 mode = Mode::Amplitude;
+    [[nodiscard]] const AmplitudeBuffer& getFinalAmplitudes() const { return finalAmplitudes; }
 
     //  Get # of decisions for given split_qubit, so that lower slice: q0 < i < qubit; upper slice: qubit <= i < nqubits
     std::size_t getNDecisions(dd::Qubit split_qubit);
 
     [[nodiscard]] Mode getMode() const { return mode; }
 
+    [[nodiscard]] bool supportsCheckpoints() const override { return false; }
+
+    std::map<std::string, std::string> AdditionalStatistics() override {
+        auto stats                     = CircuitSimulator<DDPackage>::AdditionalStatistics();
+        stats["split_qubit"]           = std::to_string(usedSplitQubit);
+        stats["decisions"]             = std::to_string(usedDecisions);
+        stats["split_qubit_selection"] = splitQubit.has_value() ? "fixed" : "auto";
+        stats["memory_budget"]         = std::to_string(memoryBudget);
+        stats["spilled_partial_sums"]  = std::to_string(spilledPartialSums);
+        stats["local_slices"]          = std::to_string(localSlices);
+        return stats;
+    }
+
+    // cut the circuit at the given qubit (lower slice: q < qubit; upper slice: qubit <= q); unset means automatic selection
+    void setSplitQubit(std::optional<dd::Qubit> qubit) { splitQubit = qubit; }
+
+    [[nodiscard]] std::optional<dd::Qubit> getSplitQubit() const { return splitQubit; }
+
+    // returns the cut minimizing the estimated cost, i.e., the number of slices times the size of the slice DDs, among the
+    // cuts all operations can be sliced at (n/2 if there is none)
+    dd::Qubit findBestSplitQubit();
+
+    // bound (in bytes) on the partial sums of the DD mode reduction that are kept in memory; 0 means unbounded
+    void setMemoryBudget(std::size_t bytes) { memoryBudget = bytes; }
+
+    [[nodiscard]] std::size_t getMemoryBudget() const { return memoryBudget; }
+
+    // directory partial sums are spilled to once the memory budget is exceeded
+    void setScratchDirectory(const std::string& directory) { scratchDirectory = directory; }
+
+    [[nodiscard]] const std::string& getScratchDirectory() const { return scratchDirectory; }
+
+    // File the final amplitudes of the amplitude modes are mapped to instead of anonymous memory, which allows for states
+    // exceeding the main memory and for opening the result with np.memmap (see AmplitudeBuffer). An existing file is
+    // overwritten by every simulation; empty (the default) disables the mapping. Like the amplitudes in memory, the file
+    // holds the prefix sums of the probabilities once shots have been sampled. Distributed ranks need distinct files.
+    // With a file, the Amplitude mode accumulates like the SharedAmplitude mode instead of using one buffer per thread.
+    void setAmplitudeFile(const std::string& file) { amplitudeFile = file; }
+
+    [[nodiscard]] const std::string& getAmplitudeFile() const { return amplitudeFile; }
+
+#ifdef DDSIM_MPI
+    // Distributes the slices of the amplitude modes (and of SimulateAmplitudes) over the ranks of comm, which all have to
+    // simulate the same circuit with the same split qubit and seed. Every rank obtains the complete result. The DD mode is
+    // not supported. MPI_COMM_NULL (the default) disables the distribution.
+    void setCommunicator(MPI_Comm comm) { communicator = comm; }
+
+    [[nodiscard]] MPI_Comm getCommunicator() const { return communicator; }
+#endif
+
 private:
-    std::size_t                       nthreads = 2;
-    std::vector<std::complex<dd::fp>> finalAmplitudes{};
+    std::size_t     nthreads = 2;
+    AmplitudeBuffer finalAmplitudes{};
+    std::string     amplitudeFile{};
+
+    std::optional<dd::Qubit> splitQubit{};
+    dd::Qubit                usedSplitQubit = 0;
+    std::size_t              usedDecisions  = 0;
+
+    std::size_t memoryBudget       = 0;
+    std::string scratchDirectory   = std::filesystem::temp_directory_path().string();
+    std::size_t spilledPartialSums = 0;
+    // slices simulated by this process, which are all of them unless they are distributed
+    std::size_t localSlices = 0;
+
+#ifdef DDSIM_MPI
+    MPI_Comm communicator = MPI_COMM_NULL;
+#endif
+
+    // rough footprint of a single vector node including its edge weights, used to check the memory budget
+    static constexpr std::size_t BYTES_PER_NODE = sizeof(dd::vNode) + 2 * sizeof(dd::CTEntry);
+
+    // sum of a range of slices; either held in its own package or spilled to a file
+    struct PartialSum {
+        std::unique_ptr<SliceDDPackage> dd{};
+        qc::VectorDD                    edge{};
+        std::string                     file{};
+        std::size_t                     bytes = 0;
+    };
+
+    // validates or determines the split qubit and records it together with the resulting number of decisions
+    dd::Qubit selectSplitQubit();
 
     void SimulateHybridTaskflow(dd::Qubit split_qubit);
     void SimulateHybridAmplitudes(dd::Qubit split_qubit);
+    void SimulateHybridSharedAmplitudes(dd::Qubit split_qubit);
 
-    qc::VectorDD SimulateSlicing(std::unique_ptr<dd::Package<>>& dd, dd::Qubit split_qubit, std::size_t controls);
+    static bool isSplitOperation(const qc::Operation& op, dd::Qubit split_qubit);
+    // false if Slice::apply rejects (or cannot correctly apply) op for this cut, e.g., targets in both slices
+    static bool isSliceableOperation(const qc::Operation& op, dd::Qubit split_qubit);
+
+    [[nodiscard]] bool isDistributed() const;
+
+    // Runs simulateBlock on executor for the first slice of every aligned block of blockSize slices this process is
+    // responsible for and waits for all of them to finish.
+    void runSliceBlocks(tf::Executor& executor, std::int64_t blockSize, const std::function<void(std::int64_t)>& simulateBlock);
+    // sums up the amplitudes of all processes in place, so each one ends up with the complete result
+    void reduceAmplitudes(std::complex<dd::fp>* amplitudes, std::size_t size);
+
+    class Slice;
+
+    // Simulates the slices with controls in [firstControl, firstControl + nslices), nslices being a power of two, in a DFS over
+    // the decision tree, so the operations before a decision are applied only once for all slices below it.
+    // Every resulting DD is handed to consume together with one reference to it.
+    void SimulateSlices(std::unique_ptr<SliceDDPackage>& dd, dd::Qubit split_qubit, std::size_t firstControl, std::size_t nslices, const std::function<void(qc::VectorDD)>& consume);
+    // as above, but hands the upper and the lower slice DD of every slice to consume, which are only valid during the call
+    void SimulateSlicePairs(std::unique_ptr<SliceDDPackage>& dd, dd::Qubit split_qubit, std::size_t firstControl, std::size_t nslices, const std::function<void(const qc::VectorDD&, const qc::VectorDD&)>& consume);
+    void SimulateSlicesRec(std::unique_ptr<SliceDDPackage>& dd, const std::vector<bool>& splitOps, std::size_t opIdx, Slice lower, Slice upper, std::size_t firstFreeDecision, typename Simulator<DDPackage>::GarbageCollectionState& gcState, const std::function<void(const qc::VectorDD&, const qc::VectorDD&)>& consume);
 
     class Slice {
     protected:
@@ -62,24 +188,30 @@ private:
     public:
         const dd::Qubit      start;
         const dd::Qubit      end;
-        const std::size_t    controls;
+        std::size_t          controls;
         const dd::QubitCount nqubits;
         std::size_t          nDecisionsExecuted = 0;
         qc::VectorDD         edge{};
 
-        explicit Slice(std::unique_ptr<dd::Package<>>& dd, dd::Qubit start, dd::Qubit end, const std::size_t controls):
+        explicit Slice(std::unique_ptr<SliceDDPackage>& dd, dd::Qubit start, dd::Qubit end, const std::size_t controls):
             start(start), end(end), controls(controls), nqubits(end - start + 1) {
             edge = dd->makeZeroState(nqubits, start);
             dd->incRef(edge);
         }
 
-        explicit Slice(std::unique_ptr<dd::Package<>>& dd, qc::VectorDD edge, dd::Qubit start, dd::Qubit end, const std::size_t controls):
+        explicit Slice(std::unique_ptr<SliceDDPackage>& dd, qc::VectorDD edge, dd::Qubit start, dd::Qubit end, const std::size_t controls):
             start(start), end(end), controls(controls), nqubits(end - start + 1), edge(edge) {
             dd->incRef(edge);
         }
 
+        // fixes the outcome of the given decision (i.e., the value of the corresponding bit of controls)
+        void setDecision(std::size_t decision, bool value) {
+            const std::size_t bit = 1UL << decision;
+            controls              = value ? (controls | bit) : (controls & ~bit);
+        }
+
         // returns true if this operation was a split operation
-        bool apply(std::unique_ptr<dd::Package<>>& dd, const std::unique_ptr<qc::Operation>& op);
+        bool apply(std::unique_ptr<SliceDDPackage>& dd, const std::unique_ptr<qc::Operation>& op);
     };
 };
 
@@ -0,0 +1,60 @@
+#ifndef DDSIM_MODULARARITHMETICCACHE_HPP
+#define DDSIM_MODULARARITHMETICCACHE_HPP
+
+#include "dd/Package.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+
+// Process-wide store of the matrix DDs for modular arithmetic, shared by ShorSimulator and ShorFastSimulator and keyed by
+// the kind of the DD, the modulus n, and the constant (e.g., a^(2^i) mod n). Every simulator has its own package, so the DDs
+// are kept in the binary format of dd::serialize and loaded into the package asking for them, which is much cheaper than
+// building them from scratch. The store can be saved to and loaded from a directory to reuse it across processes.
+// Entries are never evicted, so the store is disabled by default and has to be enabled (and cleared) by the application,
+// otherwise every run in a long-lived process would keep its DDs forever.
+class ModularArithmeticCache {
+public:
+    enum class Kind : std::uint8_t {
+        AddConstMod, // x -> x + constant mod n
+        Multiplier   // x -> constant * x mod n as built by ShorSimulator::u_a_emulate
+    };
+
+    static ModularArithmeticCache& instance();
+
+    // returns the DD of (kind, modulus, constant) in dd, calling build only if it is not stored yet; the result carries no reference
+    dd::mEdge get(std::unique_ptr<dd::Package<>>& dd, Kind kind, unsigned long long modulus, unsigned long long constant, const std::function<dd::mEdge()>& build);
+
+    void setEnabled(bool enable) { enabled = enable; }
+
+    [[nodiscard]] bool isEnabled() const { return enabled; }
+
+    void clear();
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t getHits() const { return hits; }
+    [[nodiscard]] std::size_t getMisses() const { return misses; }
+
+    // one file per DD named <kind>_<modulus>_<constant>.dd; load adds the DDs found in directory and returns their number
+    void        save(const std::string& directory) const;
+    std::size_t load(const std::string& directory);
+
+private:
+    ModularArithmeticCache() = default;
+
+    using Key = std::tuple<Kind, unsigned long long, unsigned long long>;
+
+    mutable std::mutex         mutex{};
+    std::map<Key, std::string> entries{};
+    std::atomic<bool>          enabled{false};
+    std::atomic<std::size_t>   hits{0};
+    std::atomic<std::size_t>   misses{0};
+};
+
+#endif //DDSIM_MODULARARITHMETICCACHE_HPP
@@ -0,0 +1,53 @@
+#ifndef DDSIM_OPERATIONCACHE_HPP
+#define DDSIM_OPERATIONCACHE_HPP
+
+#include "Simulator.hpp"
+#include "dd/Operations.hpp"
+#include "operations/Operation.hpp"
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Cache of operation DDs for a single package, keyed by the signature of the operation
+// (type, qubits, controls, and parameters). Cached DDs are pinned by a reference until they are erased or the cache is cleared.
+template<class DDPackage = dd::Package<>>
+class OperationCache {
+public:
+    static constexpr std::size_t DEFAULT_CAPACITY = 1024U;
+
+    explicit OperationCache(std::size_t capacity = DEFAULT_CAPACITY):
+        capacity(capacity) {}
+
+    // returns the DD of op in dd, building and pinning it on first use; once the capacity is reached, new operations are built but not cached
+    qc::MatrixDD get(const qc::Operation* op, std::unique_ptr<DDPackage>& dd, bool inverse = false);
+
+    // releases all pinned DDs; has to be called before the package is destroyed, reset, or resized
+    void clear(std::unique_ptr<DDPackage>& dd);
+
+    // releases the pinned DDs of op and its inverse, e.g., before op is replaced by an operation with other parameters
+    void erase(const qc::Operation* op, std::unique_ptr<DDPackage>& dd);
+
+    void setCapacity(std::size_t newCapacity) { capacity = newCapacity; }
+
+    [[nodiscard]] std::size_t getCapacity() const { return capacity; }
+    [[nodiscard]] std::size_t size() const { return entries.size(); }
+    [[nodiscard]] std::size_t getHits() const { return hits; }
+    [[nodiscard]] std::size_t getMisses() const { return misses; }
+
+private:
+    using Signature = std::tuple<qc::OpType, dd::QubitCount, dd::Qubit, qc::Targets, std::vector<std::pair<dd::Qubit, dd::Control::Type>>, std::array<dd::fp, 3>, bool>;
+
+    static Signature signatureOf(const qc::Operation* op, bool inverse);
+
+    std::size_t                       capacity;
+    std::map<Signature, qc::MatrixDD> entries{};
+    std::size_t                       hits   = 0;
+    std::size_t                       misses = 0;
+};
+
+#endif //DDSIM_OPERATIONCACHE_HPP
@@ -0,0 +1,93 @@
+#ifndef DDSIM_OPERATIONSTREAM_HPP
+#define DDSIM_OPERATIONSTREAM_HPP
+
+#include "QuantumComputation.hpp"
+#include "operations/Operation.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Yields the operations of a streamed circuit one after another and nullptr once the stream is exhausted.
+using OperationSource = std::function<std::unique_ptr<qc::Operation>()>;
+
+// Bounded FIFO handing operations from a producer thread to a consumer thread. The producer blocks while the queue is
+// full, so at most capacity operations are held at any time.
+class OperationQueue {
+public:
+    explicit OperationQueue(std::size_t capacity):
+        capacity(capacity == 0 ? 1 : capacity) {}
+
+    // returns false if the queue was cancelled by the consumer, in which case op is discarded
+    bool push(std::unique_ptr<qc::Operation> op);
+
+    // blocks until an operation is available; returns nullptr once the producer closed the queue and all operations were
+    // popped, and rethrows the exception the producer failed with
+    std::unique_ptr<qc::Operation> pop();
+
+    // signals the end of the stream
+    void close();
+    // ends the stream with the given exception, which pop rethrows after the operations queued before
+    void fail(std::exception_ptr error);
+    // makes the producer stop at its next push, e.g., because the consumer failed
+    void cancel();
+
+private:
+    std::size_t                                capacity;
+    std::mutex                                 mutex{};
+    std::condition_variable                    notEmpty{};
+    std::condition_variable                    notFull{};
+    std::deque<std::unique_ptr<qc::Operation>> ops{};
+    bool                                       closed    = false;
+    bool                                       cancelled = false;
+    std::exception_ptr                         error{};
+};
+
+// Reads an OpenQASM 2 circuit from a stream in chunks of statements, so arbitrarily long gate lists can be simulated
+// without ever holding the whole circuit. The leading declarations (version, includes, registers, and gate definitions)
+// form a header that is parsed once for circuit() and again together with every chunk of gate statements by the regular
+// OpenQASM parser. Registers have to be declared before the first operation; gate definitions may appear anywhere.
+class QasmOperationReader {
+public:
+    explicit QasmOperationReader(std::istream& is, std::size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    // an empty circuit with the registers of the streamed one, e.g., to construct the simulator from
+    [[nodiscard]] std::unique_ptr<qc::QuantumComputation> circuit() const;
+
+    // the next operation of the circuit or nullptr at its end
+    std::unique_ptr<qc::Operation> next();
+
+    // a source yielding the operations of this reader, which has to outlive the source
+    OperationSource source() {
+        return [this]() { return next(); };
+    }
+
+    [[nodiscard]] std::size_t getStatementsRead() const { return statementsRead; }
+
+private:
+    std::istream& is;
+    std::size_t   chunkSize;
+    std::string   header{};
+    std::string   pendingStatement{};
+    std::size_t   statementsRead = 0;
+
+    std::deque<std::unique_ptr<qc::Operation>> ops{};
+
+    // the next complete statement (a gate definition including its body) or an empty string at the end of the stream
+    std::string readStatement();
+    // parses the next chunk of statements into ops; returns false at the end of the stream
+    bool readChunk();
+
+    static bool isDeclaration(const std::string& statement);
+    static bool isRegisterDeclaration(const std::string& statement);
+};
+
+#endif //DDSIM_OPERATIONSTREAM_HPP
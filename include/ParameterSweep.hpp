@@ -0,0 +1,57 @@
+#ifndef DDSIM_PARAMETERSWEEP_HPP
+#define DDSIM_PARAMETERSWEEP_HPP
+
+#include "CircuitSimulator.hpp"
+#include "QuantumComputation.hpp"
+#include "Simulator.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Simulates one circuit for many assignments of its rotation angles (see CircuitSimulator::getParameters). Every worker
+// thread owns a simulator, whose package and operation cache stay warm across all parameter sets and calls, so only the
+// gates depending on the parameters have to be rebuilt. Parameter set i is always handled by worker i mod #workers, hence
+// results with a fixed seed do not depend on the scheduling.
+template<class DDPackage = dd::Package<>>
+class ParameterSweep {
+public:
+    explicit ParameterSweep(std::unique_ptr<qc::QuantumComputation>&& circuit, std::size_t nthreads = std::thread::hardware_concurrency()):
+        circuit(std::move(circuit)), nthreads(std::max<std::size_t>(nthreads, 1U)) {}
+
+    ParameterSweep(std::unique_ptr<qc::QuantumComputation>&& circuit, unsigned long long seed, std::size_t nthreads = std::thread::hardware_concurrency()):
+        circuit(std::move(circuit)), nthreads(std::max<std::size_t>(nthreads, 1U)), seed(seed) {}
+
+    [[nodiscard]] std::size_t getNumberOfParameters() const { return CircuitSimulator<DDPackage>::parametersOf(*circuit).size(); }
+
+    // rotation angles of a bound instance of the template; throws if other differs from the template in more than its angles
+    [[nodiscard]] std::vector<dd::fp> parametersOf(const qc::QuantumComputation& other) const;
+
+    // the counts of Simulate(shots) for every row of parameters
+    std::vector<std::map<std::string, std::size_t>> Simulate(const std::vector<std::vector<dd::fp>>& parameters, unsigned int shots);
+
+    // expectation values of observable in the final states for every row of parameters
+    std::vector<double> ExpectationValues(const std::vector<std::vector<dd::fp>>& parameters, const PauliSum& observable);
+
+    std::map<std::string, std::string> AdditionalStatistics() const;
+
+    [[nodiscard]] std::size_t getNumberOfWorkers() const { return workers.size(); }
+
+private:
+    std::unique_ptr<qc::QuantumComputation>                    circuit;
+    std::size_t                                                nthreads;
+    std::optional<unsigned long long>                          seed{};
+    std::vector<std::unique_ptr<CircuitSimulator<DDPackage>>> workers{};
+    std::size_t                                                parameterSets = 0;
+
+    // binds every row of parameters in one of the workers and hands the worker and the row index to task
+    template<class Task>
+    void forEachParameterSet(const std::vector<std::vector<dd::fp>>& parameters, const Task& task);
+};
+
+#endif //DDSIM_PARAMETERSWEEP_HPP
@@ -7,6 +7,8 @@
 
 #include <future>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <taskflow/taskflow.hpp>
 #include <thread>
 #include <unordered_map>
@@ -50,7 +52,8 @@ public:
             PairwiseRecursiveGrouping,
             BracketGrouping,
             Alternating,
-            Cotengra
+            Cotengra,
+            Auto
         };
 
         // mode to use
@@ -64,9 +67,16 @@ public:
         // random seed
         std::size_t seed;
 
+        // number of worker threads. With more than one thread, independent branches of the simulation path are executed
+        // concurrently, each worker thread using its own DD package
+        std::size_t nthreads;
+
+        // time limit (in seconds) for the search of the automatic path planner
+        double autoTimeLimit = 1.0;
+
         //Add new variables here
-        explicit Configuration(Mode mode = Mode::Sequential, std::size_t bracketSize = 2, std::size_t alternatingStart = 0, std::size_t seed = 0):
-            mode(mode), bracketSize(bracketSize), alternatingStart(alternatingStart), seed(seed){};
+        explicit Configuration(Mode mode = Mode::Sequential, std::size_t bracketSize = 2, std::size_t alternatingStart = 0, std::size_t seed = 0, std::size_t nthreads = 1):
+            mode(mode), bracketSize(bracketSize), alternatingStart(alternatingStart), seed(seed), nthreads(nthreads){};
 
         static Mode modeFromString(const std::string& mode) {
             if (mode == "sequential" || mode == "0") {
@@ -79,6 +89,8 @@ public:
                 return Mode::Alternating;
             } else if (mode == "cotengra" || mode == "4") {
                 return Mode::Cotengra;
+            } else if (mode == "auto" || mode == "5") {
+                return Mode::Auto;
             } else {
                 throw std::invalid_argument("Invalid simulation path mode: " + mode);
             }
@@ -96,6 +108,8 @@ public:
                     return "alternating";
                 case Mode::Cotengra:
                     return "cotengra";
+                case Mode::Auto:
+                    return "auto";
                 default:
                     throw std::invalid_argument("Invalid simulation path mode");
             }
@@ -108,10 +122,15 @@ public:
                 conf["bracket_size"] = bracketSize;
             } else if (mode == Mode::Alternating) {
                 conf["alternating_start"] = alternatingStart;
+            } else if (mode == Mode::Auto) {
+                conf["auto_time_limit"] = autoTimeLimit;
             }
             if (seed != 0) {
                 conf["seed"] = seed;
             }
+            if (nthreads > 1) {
+                conf["nthreads"] = nthreads;
+            }
             return conf;
         }
 
@@ -121,7 +140,7 @@ public:
     };
 
     explicit PathSimulator(std::unique_ptr<qc::QuantumComputation>&& qc, Configuration configuration = Configuration()):
-        CircuitSimulator<DDPackage>(std::move(qc)), executor(1) {
+        CircuitSimulator<DDPackage>(std::move(qc)), executor(std::max<std::size_t>(1U, configuration.nthreads)), parallel(configuration.nthreads > 1) {
         if (configuration.seed != 0) {
             // override seed in case a non-trivial one is given
             Simulator<DDPackage>::mt.seed(Simulator<DDPackage>::seed);
@@ -148,6 +167,9 @@ public:
             case Configuration::Mode::Alternating:
                 generateAlternatingSimulationPath(configuration.alternatingStart);
                 break;
+            case Configuration::Mode::Auto:
+                generateAutoSimulationPath(configuration.autoTimeLimit);
+                break;
             case Configuration::Mode::Sequential:
             default:
                 generateSequentialSimulationPath();
@@ -160,6 +182,8 @@ public:
 
     std::map<std::string, std::size_t> Simulate(unsigned int shots) override;
 
+    [[nodiscard]] bool supportsCheckpoints() const override { return false; }
+
     const SimulationPath& getSimulationPath() const {
         return simulationPath;
     }
@@ -175,15 +199,45 @@ public:
     void generatePairwiseRecursiveGroupingSimulationPath();
     void generateBracketSimulationPath(std::size_t bracketSize);
     void generateAlternatingSimulationPath(std::size_t startingPoint);
+    // Plans the path with an estimate of the DD sizes of all intermediate results (derived from the qubits the operations
+    // act on and the number of multi-qubit operations). Contiguous runs of operations are combined to matrices (MxM) and
+    // then applied to the state (MxV), where the split points are chosen by dynamic programming. The maximal length of the
+    // runs is doubled for as long as the time limit permits.
+    void generateAutoSimulationPath(double timeLimit);
 
 private:
-    std::unordered_map<std::size_t, tf::Task>                                 tasks{};
-    std::unordered_map<std::size_t, std::variant<qc::VectorDD, qc::MatrixDD>> results{};
+    using Result = std::variant<qc::VectorDD, qc::MatrixDD>;
+
+    // DDs whose last reference is held by a task running on a different thread than the one owning the respective package.
+    // They are released by the owning thread before it executes its next task.
+    struct ReleaseQueue {
+        std::mutex          mutex{};
+        std::vector<Result> edges{};
+    };
+
+    std::unordered_map<std::size_t, tf::Task> tasks{};
+    // indexed by the IDs of the simulation path steps, so concurrent tasks never modify the container itself
+    std::vector<Result>      results{};
+    std::vector<std::size_t> resultOwners{};
 
     tf::Taskflow   taskflow{};
     tf::Executor   executor{};
     SimulationPath simulationPath{};
 
+    // in parallel mode every worker thread owns a package and results are transferred between packages as needed
+    const bool                                                         parallel;
+    std::vector<std::unique_ptr<DDPackage>>                            workerPackages{};
+    std::vector<ReleaseQueue>                                          releaseQueues{};
+    std::vector<typename Simulator<DDPackage>::GarbageCollectionState> gcStates{};
+
+    // owner ID of the package of the simulator itself, worker thread i owns package i
+    [[nodiscard]] std::size_t mainPackage() const { return workerPackages.size(); }
+
+    std::unique_ptr<DDPackage>& getPackage(std::size_t owner);
+    Result                      acquireResult(std::size_t id, std::size_t owner);
+    void                        enqueueRelease(std::size_t owner, const Result& result);
+    void                        releaseQueuedEdges(std::size_t owner);
+
     void constructTaskGraph();
     void addSimulationTask(std::size_t leftID, std::size_t rightID, std::size_t resultID);
 };
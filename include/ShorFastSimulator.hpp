@@ -4,6 +4,9 @@
 #include "QuantumComputation.hpp"
 #include "Simulator.hpp"
 
+#include <unordered_map>
+#include <vector>
+
 class ShorFastSimulator: public Simulator<dd::Package<>> {
     static unsigned long long modpow(unsigned long long base, unsigned long long exp, unsigned long long modulus) {
         base %= modulus;
@@ -42,8 +45,9 @@ class ShorFastSimulator: public Simulator<dd::Package<>> {
 
     void ApplyGate(dd::GateMatrix matrix, dd::Qubit target);
 
-    std::vector<unsigned long long>              ts;
-    std::vector<std::map<dd::vNode*, dd::vEdge>> nodesOnLevel;
+    std::vector<unsigned long long>                        ts;
+    std::vector<std::unordered_map<dd::vNode*, dd::vEdge>> nodesOnLevel;
+    std::vector<dd::vEdge>                                 dfsStack;
 
     dd::mEdge addConst(unsigned long long a);
 
@@ -65,8 +69,6 @@ class ShorFastSimulator: public Simulator<dd::Package<>> {
 
     const bool verbose;
 
-    std::map<dd::vNode*, dd::vEdge> dag_edges;
-
 public:
     ShorFastSimulator(int composite_number, int coprime_a, bool verbose = false):
         Simulator(), n(composite_number), coprime_a(coprime_a),
@@ -98,6 +100,15 @@ public:
         return number_of_operations;
     }
 
+    [[nodiscard]] bool supportsCheckpoints() const override {
+        return true;
+    }
+
+    // the circuit only depends on the composite number
+    [[nodiscard]] std::uint64_t circuitHash() const override {
+        return n;
+    }
+
     std::pair<unsigned, unsigned> getFactors() {
         return sim_factors;
     }
@@ -108,7 +119,8 @@ public:
                 {"coprime_a", std::to_string(coprime_a)},
                 {"sim_result", sim_result},
                 {"sim_factor1", std::to_string(sim_factors.first)},
-                {"sim_factor2", std::to_string(sim_factors.second)}};
+                {"sim_factor2", std::to_string(sim_factors.second)},
+                {"checkpoints_written", std::to_string(getCheckpointsWritten())}};
     }
 };
 
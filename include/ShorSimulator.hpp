@@ -56,6 +56,9 @@ class ShorSimulator: public Simulator<dd::Package<>> {
 
     void u_a_emulate(unsigned long long a, int q);
 
+    // the DD of x -> a * x mod n on the lower required_bits qubits
+    dd::mEdge multiplier(unsigned long long a);
+
     void ApplyGate(dd::GateMatrix matrix, dd::Qubit target, const dd::Controls& controls);
 
     void ApplyGate(dd::GateMatrix matrix, dd::Qubit target, dd::Control control);
@@ -139,6 +142,15 @@ public:
         return 0;
     }
 
+    [[nodiscard]] bool supportsCheckpoints() const override {
+        return true;
+    }
+
+    // the circuit only depends on the composite number
+    [[nodiscard]] std::uint64_t circuitHash() const override {
+        return n;
+    }
+
     std::pair<unsigned, unsigned> getFactors() {
         return sim_factors;
     }
@@ -157,6 +169,7 @@ public:
                 {"approximation_runs", std::to_string(approximation_runs)},
                 {"step_fidelity", std::to_string(step_fidelity)},
                 {"final_fidelity", std::to_string(final_fidelity)},
+                {"checkpoints_written", std::to_string(getCheckpointsWritten())},
         };
     }
 };
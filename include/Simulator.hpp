@@ -1,21 +1,77 @@
 #ifndef DDSIMULATOR_H
 #define DDSIMULATOR_H
 
+#include "AmplitudeBuffer.hpp"
+#include "Checkpoint.hpp"
+#include "Trace.hpp"
 #include "dd/Package.hpp"
 #include "operations/OpType.hpp"
+#include "operations/Operation.hpp"
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <complex>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
+#include <optional>
 #include <random>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+// Progress of a running simulation in units of work, which are operations for simulators evolving a single state, slices
+// for the hybrid Schrodinger-Feynman simulator, steps of the simulation path for the path simulator, and trajectories for
+// the stochastic noise simulator. total is 0 if the amount of work is not known in advance. nodes is the number of vector
+// nodes alive in the package that reported last.
+struct SimulationProgress {
+    std::size_t done  = 0;
+    std::size_t total = 0;
+    std::size_t nodes = 0;
+};
+
+// thrown by a simulation that was cancelled (see Simulator::cancel)
+class SimulationCancelled: public std::runtime_error {
+public:
+    SimulationCancelled():
+        std::runtime_error("The simulation was cancelled.") {}
+};
+
+// Decides after which operations the garbage of a package is collected
+struct GarbageCollectionPolicy {
+    enum class Trigger {
+        EveryOperation,   // ask the package after every operation, it collects once its tables are filled up (default)
+        EveryNOperations, // collect after every interval operations
+        NodeLimit,        // collect as soon as the unique tables hold more than nodeLimit nodes beyond those that survived the last collection
+        Adaptive          // collect as soon as the unique tables grew by growthFactor since the last collection
+    };
+
+    Trigger     trigger      = Trigger::EveryOperation;
+    std::size_t interval     = 1U;
+    std::size_t nodeLimit    = 1U << 20U;
+    double      growthFactor = 2.;
+};
+
+// Weighted tensor product of Pauli operators. As in Qiskit, the last character of pauli acts on qubit 0.
+struct PauliTerm {
+    double      coefficient = 1.;
+    std::string pauli{};
+};
+
+using PauliSum = std::vector<PauliTerm>;
+
+// selected amplitudes of a state, keyed by the index of the basis state (bit i corresponds to qubit i)
+using AmplitudeMap = std::map<std::size_t, std::complex<dd::fp>>;
+
 template<class DDPackage = dd::Package<>>
 class Simulator {
 public:
@@ -40,24 +96,118 @@ public:
 
     virtual std::map<std::string, std::string> AdditionalStatistics() { return {}; };
 
-    std::string MeasureAll(bool collapse = false) {
-        return dd->measureAll(rootEdge, collapse, mt, epsilon);
+    void setGarbageCollectionPolicy(const GarbageCollectionPolicy& policy) {
+        if (policy.interval == 0 || policy.growthFactor <= 1.) {
+            throw std::invalid_argument("Garbage collection interval has to be positive and the growth factor larger than one.");
+        }
+        gc_policy = policy;
+    }
+
+    [[nodiscard]] const GarbageCollectionPolicy& getGarbageCollectionPolicy() const { return gc_policy; }
+
+    // Upper bound on the bytes held in the node and complex tables (0 disables the bound). Once the tables approach it, the
+    // state is approximated with decreasing target fidelities. If that is not enough, the simulation stops early and keeps
+    // the state reached so far.
+    void setMemoryLimit(std::size_t bytes) { memory_limit = bytes; }
+
+    [[nodiscard]] std::size_t getMemoryLimit() const { return memory_limit; }
+
+    [[nodiscard]] bool memoryLimitExceeded() const { return memory_limit_exceeded; }
+
+    // Writes a checkpoint of the running simulation to file after every `operations` operations and/or every `seconds` seconds
+    // (0 disables the respective trigger). Only simulations that evolve a single state without sampling in between write checkpoints.
+    void setCheckpointing(const std::string& file, std::size_t operations, double seconds = 0.) {
+        if (file.empty() || (operations == 0 && seconds <= 0.)) {
+            throw std::invalid_argument("Checkpointing requires a file and a positive interval.");
+        }
+        checkpoint_file       = file;
+        checkpoint_operations = operations;
+        checkpoint_seconds    = seconds;
+    }
+
+    // the next simulation continues from the checkpoint in file instead of starting from the initial state
+    void resumeFrom(const std::string& file) {
+        if (!supportsCheckpoints()) {
+            throw std::invalid_argument("The " + getName() + " simulation cannot be resumed from a checkpoint.");
+        }
+        resume_checkpoint = Checkpoint::read(file);
     }
 
-    std::map<std::string, std::size_t> MeasureAllNonCollapsing(unsigned int shots) {
-        std::map<std::string, std::size_t> results;
-        for (unsigned int i = 0; i < shots; i++) {
-            const auto m = MeasureAll(false);
-            results[m]++;
+    // whether the simulation writes and resumes checkpoints at all
+    [[nodiscard]] virtual bool supportsCheckpoints() const { return false; }
+
+    [[nodiscard]] std::size_t getCheckpointsWritten() const { return checkpoint_writer.getWritten(); }
+
+    // Records the wall time, DD sizes, and table hit rates of every operation and garbage collection of the following
+    // simulations. Only available if the library was built with DDSIM_TRACING.
+    void enableTracing(bool enable = true) {
+        if (enable && !Tracer::ENABLED) {
+            throw std::runtime_error("Tracing is not available, the library has to be built with -DDDSIM_TRACING=ON.");
         }
-        return results;
+        tracing = enable;
+    }
+
+    [[nodiscard]] bool tracingEnabled() const { return Tracer::ENABLED && tracing; }
+
+    [[nodiscard]] Tracer& getTracer() { return tracer; }
+
+    // writes the recorded events as CSV if file ends in ".csv" and as Chrome trace JSON otherwise
+    void writeTrace(const std::string& file) const { tracer.write(file); }
+
+    // Runs Simulate(shots) on a thread of its own. The simulator must not be used otherwise, let alone destroyed, until the
+    // returned future is ready; only cancel and getProgress may be called meanwhile.
+    std::future<std::map<std::string, std::size_t>> SimulateAsync(unsigned int shots) {
+        return std::async(std::launch::async, [this, shots]() { return Simulate(shots); });
+    }
+
+    // Asks the running (or the next) simulation to stop. Simulations check for the request before every unit of work (see
+    // SimulationProgress) and throw SimulationCancelled, which resets the request; the state is undefined afterwards.
+    void cancel() { cancel_requested = true; }
+
+    [[nodiscard]] bool cancellationRequested() const { return cancel_requested; }
+
+    // may be called from any thread while a simulation is running
+    [[nodiscard]] SimulationProgress getProgress() const { return {progress_done, progress_total, progress_nodes}; }
+
+    // estimated number of bytes held in the unique and complex tables of package
+    template<class Package>
+    [[nodiscard]] static std::size_t tableMemory(const std::unique_ptr<Package>& package) {
+        return package->vUniqueTable.getNodeCount() * sizeof(dd::vNode) +
+               package->mUniqueTable.getNodeCount() * sizeof(dd::mNode) +
+               package->dUniqueTable.getNodeCount() * sizeof(dd::dNode) +
+               package->cn.complexTable.getCount() * sizeof(dd::CTEntry);
     }
 
+    std::string MeasureAll(bool collapse = false) {
+        return dd->measureAll(rootEdge, collapse, mt, epsilon);
+    }
+
+    std::map<std::string, std::size_t> MeasureAllNonCollapsing(unsigned int shots);
+
+    // Draws all shots in a single descent through the DD, where the shots arriving at a node are split binomially between its
+    // successors. The result maps the index of each sampled basis state (bit i corresponds to qubit i) to its number of occurrences.
+    std::unordered_map<std::size_t, std::size_t> SampleBasisStateIndices(std::size_t shots);
+
+    // <psi|H|psi> of the current state for a Hermitian sum of Pauli strings, computed on the DD without building the operators.
+    // Terms are distributed among nThreads threads; terms agreeing on their lower qubits share intermediate results.
+    [[nodiscard]] double expectationValue(const PauliSum& observable, unsigned int nThreads = std::thread::hardware_concurrency()) const;
+
+    // amplitude of the basis state index in the vector represented by edge, found on a single path through the DD
+    [[nodiscard]] static std::complex<dd::fp> amplitudeOf(const dd::vEdge& edge, std::size_t index);
+
+    // the amplitudes of the given basis states in the current state
+    [[nodiscard]] AmplitudeMap getAmplitudes(const std::vector<std::size_t>& indices) const;
+
+    // throws if one of the indices does not denote a basis state of nqubits qubits
+    static void checkAmplitudeIndices(const std::vector<std::size_t>& indices, dd::QubitCount nqubits);
+
     char MeasureOneCollapsing(dd::Qubit index, bool assume_probability_normalization = true) {
         return dd->measureOneCollapsing(rootEdge, index, assume_probability_normalization, mt, epsilon);
     }
 
     std::map<std::string, std::size_t> SampleFromAmplitudeVectorInPlace(std::vector<std::complex<dd::fp>>& amplitudes, unsigned int shots);
+    // as above, but the prefix sums are computed in the chunks of the buffer in parallel
+    std::map<std::string, std::size_t> SampleFromAmplitudeVectorInPlace(AmplitudeBuffer& amplitudes, unsigned int shots);
 
     [[nodiscard]] std::vector<dd::ComplexValue> getVector() const;
 
@@ -65,6 +215,20 @@ public:
 
     [[nodiscard]] std::vector<std::complex<dd::fp>> getVectorComplex() const;
 
+    // Writes all 2^n amplitudes into the caller-provided buffer. The top-level subtrees of the DD are exported in parallel.
+    void getVectorComplexInto(std::complex<dd::fp>* buffer, unsigned int nThreads = std::thread::hardware_concurrency()) const;
+
+    // Passes the state vector to the callback in consecutive chunks of chunkSize amplitudes (a power of two), together with the
+    // index of the first amplitude of the chunk. Only a single chunk is kept in memory at any time.
+    void streamVectorComplex(std::size_t chunkSize, const std::function<void(std::size_t, const std::complex<dd::fp>*, std::size_t)>& callback) const;
+
+    // The state vector in a buffer that is mapped to file unless file is empty (see AmplitudeBuffer), so vectors exceeding the
+    // main memory can be exported to fast local storage.
+    [[nodiscard]] AmplitudeBuffer getVectorComplexMapped(const std::string& file = {}, unsigned int nThreads = std::thread::hardware_concurrency()) const;
+
+    // Writes the state vector as raw std::complex<dd::fp> values to a binary file, chunk by chunk.
+    void dumpVectorComplex(const std::string& filename, std::size_t chunkSize = 1ULL << 20U) const;
+
     [[nodiscard]] virtual std::size_t getActiveNodeCount() const { return dd->vUniqueTable.getActiveNodeCount(); }
 
     [[nodiscard]] virtual std::size_t getMaxNodeCount() const { return dd->vUniqueTable.getMaxActiveNodes(); }
@@ -104,7 +268,12 @@ public:
         return ApproximateBySampling(dd, rootEdge, nSamples, threshold, removeNodes, verbose);
     }
 
-    dd::vEdge static RemoveNodes(std::unique_ptr<DDPackage>& localDD, dd::vEdge edge, std::map<dd::vNode*, dd::vEdge>& dag_edges);
+    // Keeps the tables of localDD below limit by collecting garbage and approximating edge with decreasing target fidelities,
+    // which are multiplied into fidelity. Returns false if the limit is still exceeded afterwards.
+    bool EnforceMemoryLimit(std::unique_ptr<DDPackage>& localDD, dd::vEdge& edge, std::size_t limit, double& fidelity);
+
+    // returns edge with the nodes in dag_edges replaced by the respective edges; the map is extended by the rebuilt nodes
+    dd::vEdge static RemoveNodes(std::unique_ptr<DDPackage>& localDD, dd::vEdge edge, std::unordered_map<const dd::vNode*, dd::vEdge>& dag_edges);
 
     std::unique_ptr<DDPackage> dd = std::make_unique<DDPackage>();
     dd::vEdge                  rootEdge{};
@@ -116,6 +285,231 @@ protected:
     const bool               has_fixed_seed;
     const dd::fp             epsilon = 0.001L;
 
+    static constexpr std::size_t PARALLEL_EXPORT_MIN_DIM = 1ULL << 16U;
+
+    // samples shots basis states from the inclusive prefix sums of the probabilities kept in the real parts of amplitudes
+    std::map<std::string, std::size_t> SampleFromProbabilityPrefixSums(const std::complex<dd::fp>* prefixSums, std::size_t size, unsigned int shots);
+
+    // per package bookkeeping of the garbage collection policy
+    struct GarbageCollectionState {
+        std::size_t operations           = 0U;
+        std::size_t nodesAfterCollection = 0U;
+    };
+
+    GarbageCollectionPolicy  gc_policy{};
+    GarbageCollectionState   gc_state{}; // state of dd, other packages keep their own
+    std::atomic<std::size_t> gc_runs{0U};
+    std::atomic<std::size_t> gc_freed_nodes{0U};
+    std::atomic<long long>   gc_time_ns{0};
+
+    std::size_t              memory_limit{0U};
+    std::atomic<bool>        memory_limit_exceeded{false};
+    std::atomic<std::size_t> memory_limit_approximations{0U};
+
+    // approximation starts once the tables hold this fraction of the memory limit
+    static constexpr double                MEMORY_LIMIT_THRESHOLD  = 0.9;
+    static constexpr std::array<double, 5> MEMORY_LIMIT_FIDELITIES = {0.99, 0.95, 0.9, 0.75, 0.5};
+
+    // the adaptive policy never collects tables smaller than this
+    static constexpr std::size_t ADAPTIVE_GC_MIN_NODES = 1U << 16U;
+
+    std::string                           checkpoint_file{};
+    std::size_t                           checkpoint_operations{0U};
+    double                                checkpoint_seconds{0.};
+    std::size_t                           operations_since_checkpoint{0U};
+    std::chrono::steady_clock::time_point last_checkpoint{};
+    std::optional<Checkpoint>             resume_checkpoint{};
+    CheckpointWriter                      checkpoint_writer{};
+
+    bool   tracing{false};
+    Tracer tracer{};
+
+    std::atomic<bool>        cancel_requested{false};
+    std::atomic<std::size_t> progress_done{0U};
+    std::atomic<std::size_t> progress_total{0U};
+    std::atomic<std::size_t> progress_nodes{0U};
+
+    void beginProgress(std::size_t total) {
+        progress_done  = 0U;
+        progress_total = total;
+    }
+
+    // to be called once per unit of work, possibly by several threads with their own packages
+    template<class Package>
+    void advanceProgress(const std::unique_ptr<Package>& package) {
+        ++progress_done;
+        progress_nodes = package->vUniqueTable.getNodeCount();
+    }
+
+    void checkCancellation() {
+        if (cancel_requested.exchange(false)) {
+            throw SimulationCancelled();
+        }
+    }
+
+    // state at the beginning of a traced operation
+    struct TraceSpan {
+        std::int64_t  start       = 0;
+        std::size_t   nodesBefore = 0;
+        TableCounters counters{};
+    };
+
+    template<class Package, class Edge>
+    static std::size_t traceNodeCount(const std::unique_ptr<Package>& package, Edge edge) {
+        if constexpr (std::is_same_v<Edge, dd::Edge<dd::dNode>>) {
+            dd::Edge<dd::dNode>::alignDensityEdge(edge);
+        }
+        return package->size(edge);
+    }
+
+    // Both calls enclose the application of an operation to edge in package. Without DDSIM_TRACING they compile to nothing,
+    // so name (an operation or anything convertible to a string) is only evaluated if tracing is enabled.
+    template<class Package, class Edge>
+    TraceSpan traceBegin(const std::unique_ptr<Package>& package, const Edge& edge) {
+        TraceSpan span{};
+        if constexpr (Tracer::ENABLED) {
+            if (tracing) {
+                span.nodesBefore = traceNodeCount(package, edge);
+                span.counters    = TableCounters::of(package);
+                span.start       = tracer.now();
+            }
+        }
+        return span;
+    }
+
+    template<class Package, class Edge, class Name>
+    void traceEnd(const TraceSpan& span, const std::unique_ptr<Package>& package, const Edge& edge, std::size_t index, const Name& name) {
+        if constexpr (Tracer::ENABLED) {
+            if (tracing) {
+                const auto end   = tracer.now();
+                const auto after = TableCounters::of(package);
+                TraceEvent event{};
+                event.kind = TraceEvent::Kind::Operation;
+                if constexpr (std::is_base_of_v<qc::Operation, Name>) {
+                    event.name = name.getName();
+                } else {
+                    event.name = name;
+                }
+                event.index          = index;
+                event.thread         = tracer.threadIndex();
+                event.start          = span.start;
+                event.duration       = end - span.start;
+                event.nodesBefore    = span.nodesBefore;
+                event.nodesAfter     = traceNodeCount(package, edge);
+                event.uniqueLookups  = after.uniqueLookups - span.counters.uniqueLookups;
+                event.uniqueHits     = after.uniqueHits - span.counters.uniqueHits;
+                event.computeLookups = after.computeLookups - span.counters.computeLookups;
+                event.computeHits    = after.computeHits - span.counters.computeHits;
+                tracer.record(std::move(event));
+            }
+        }
+    }
+
+    // to be called after every operation; returns true if a checkpoint is due now
+    bool checkpointDue() {
+        if (checkpoint_file.empty()) {
+            return false;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        if (last_checkpoint == std::chrono::steady_clock::time_point{}) {
+            last_checkpoint = now;
+        }
+        ++operations_since_checkpoint;
+        const bool due = (checkpoint_operations > 0 && operations_since_checkpoint >= checkpoint_operations) ||
+                         (checkpoint_seconds > 0. && std::chrono::duration<double>(now - last_checkpoint).count() >= checkpoint_seconds);
+        if (due) {
+            operations_since_checkpoint = 0U;
+            last_checkpoint             = now;
+        }
+        return due;
+    }
+
+    // Serializes rootEdge and the RNG on the calling thread and hands them to the background writer together with the
+    // bookkeeping of the simulator. opIndex is the index of the next operation to apply.
+    void writeCheckpoint(std::size_t opIndex, const std::map<std::size_t, bool>& classicValues, std::size_t approximationRuns, double fidelity, std::vector<std::uint64_t> extra = {});
+
+    // Fingerprint of the simulated circuit stored in checkpoints, so a checkpoint is only resumed by the circuit it was taken
+    // for; simulators that build their circuit from their parameters may leave it at 0.
+    [[nodiscard]] virtual std::uint64_t circuitHash() const { return 0; }
+
+    // If a checkpoint is to be resumed, replaces rootEdge (holding a reference) and the RNG by its contents and returns it.
+    std::optional<Checkpoint> restoreCheckpoint();
+
+    template<class Package>
+    static std::size_t tableNodeCount(const std::unique_ptr<Package>& package) {
+        return package->vUniqueTable.getNodeCount() + package->mUniqueTable.getNodeCount() + package->dUniqueTable.getNodeCount();
+    }
+
+    // to be called after an operation has been applied in package; collects garbage according to the policy
+    template<class Package>
+    void collectGarbage(std::unique_ptr<Package>& package, GarbageCollectionState& state) {
+        ++state.operations;
+        const auto nodesBefore = tableNodeCount(package);
+        bool       force       = true;
+        switch (gc_policy.trigger) {
+            case GarbageCollectionPolicy::Trigger::EveryOperation:
+                force = false;
+                break;
+            case GarbageCollectionPolicy::Trigger::EveryNOperations:
+                if (state.operations < gc_policy.interval) {
+                    return;
+                }
+                break;
+            case GarbageCollectionPolicy::Trigger::NodeLimit:
+                // the live nodes do not count, otherwise a state exceeding the limit would be collected after every operation
+                if (nodesBefore <= state.nodesAfterCollection + gc_policy.nodeLimit) {
+                    return;
+                }
+                break;
+            case GarbageCollectionPolicy::Trigger::Adaptive:
+                if (static_cast<double>(nodesBefore) < std::max(static_cast<double>(ADAPTIVE_GC_MIN_NODES), gc_policy.growthFactor * static_cast<double>(state.nodesAfterCollection))) {
+                    return;
+                }
+                break;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        package->garbageCollect(force);
+        const auto nodesAfter = tableNodeCount(package);
+        const auto duration   = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        gc_time_ns += duration;
+
+        if constexpr (Tracer::ENABLED) {
+            // unlike operations, collections report the node counts of all unique tables
+            if (tracing && (force || nodesAfter < nodesBefore)) {
+                TraceEvent event{};
+                event.kind        = TraceEvent::Kind::GarbageCollection;
+                event.name        = "garbage_collection";
+                event.index       = gc_runs;
+                event.thread      = tracer.threadIndex();
+                event.duration    = duration;
+                event.start       = tracer.now() - duration;
+                event.nodesBefore = nodesBefore;
+                event.nodesAfter  = nodesAfter;
+                tracer.record(std::move(event));
+            }
+        }
+
+        if (force || nodesAfter < nodesBefore) {
+            ++gc_runs;
+            gc_freed_nodes += nodesBefore - std::min(nodesBefore, nodesAfter);
+            state.operations           = 0U;
+            state.nodesAfterCollection = nodesAfter;
+        }
+    }
+
+    void collectGarbage() { collectGarbage(dd, gc_state); }
+
+    [[nodiscard]] std::map<std::string, std::string> GarbageCollectionStatistics() const {
+        static const std::array<std::string, 4> triggers{"every_operation", "every_n_operations", "node_limit", "adaptive"};
+        return {
+                {"gc_policy", triggers.at(static_cast<std::size_t>(gc_policy.trigger))},
+                {"gc_runs", std::to_string(gc_runs)},
+                {"gc_freed_nodes", std::to_string(gc_freed_nodes)},
+                {"gc_time", std::to_string(static_cast<double>(gc_time_ns) / 1e9)},
+        };
+    }
+
     static void NextPath(std::string& s);
 };
 
@@ -188,4 +582,83 @@ using DensityMatrixPackage = dd::Package<DensityMatrixSimulatorDDPackageConfig::
                                          DensityMatrixSimulatorDDPackageConfig::CT_DM_ADD_NBUCKET,
                                          DensityMatrixSimulatorDDPackageConfig::STOCHASTIC_CACHE_OPS>;
 
+// Packages of the slices of HybridSchrodingerFeynmanSimulator. A slice only spans part of the qubits and is only ever
+// multiplied with gates and added up, so the unique tables and the compute tables of these operations are smaller than
+// the default ones and the tables of unused operations are reduced to a single bucket. Every worker thread holds such a
+// package, hence this saves memory per thread and keeps the tables in the caches.
+struct HybridSliceDDPackageConfig: public dd::DDPackageConfig {
+    static constexpr std::size_t UT_VEC_NBUCKET                 = 8192U;
+    static constexpr std::size_t UT_VEC_INITIAL_ALLOCATION_SIZE = 1024U;
+    static constexpr std::size_t UT_MAT_NBUCKET                 = 4096U;
+    static constexpr std::size_t UT_MAT_INITIAL_ALLOCATION_SIZE = 512U;
+
+    static constexpr std::size_t CT_VEC_ADD_NBUCKET      = 4096U;
+    static constexpr std::size_t CT_MAT_VEC_MULT_NBUCKET = 8192U;
+    static constexpr std::size_t CT_VEC_KRON_NBUCKET     = 1024U;
+    static constexpr std::size_t CT_MAT_ADD_NBUCKET      = 1024U;
+    static constexpr std::size_t CT_MAT_MAT_MULT_NBUCKET = 256U;
+
+    static constexpr std::size_t CT_MAT_TRANS_NBUCKET          = 1U;
+    static constexpr std::size_t CT_MAT_CONJ_TRANS_NBUCKET     = 1U;
+    static constexpr std::size_t CT_MAT_KRON_NBUCKET           = 1U;
+    static constexpr std::size_t CT_VEC_INNER_PROD_NBUCKET     = 1U;
+    static constexpr std::size_t CT_DM_NOISE_NBUCKET           = 1U;
+    static constexpr std::size_t UT_DM_NBUCKET                 = 1U;
+    static constexpr std::size_t UT_DM_INITIAL_ALLOCATION_SIZE = 1U;
+    static constexpr std::size_t CT_DM_DM_MULT_NBUCKET         = 1U;
+    static constexpr std::size_t CT_DM_ADD_NBUCKET             = 1U;
+    static constexpr std::size_t STOCHASTIC_CACHE_OPS          = 1U;
+};
+
+using HybridSlicePackage = dd::Package<HybridSliceDDPackageConfig::UT_VEC_NBUCKET,
+                                       HybridSliceDDPackageConfig::UT_VEC_INITIAL_ALLOCATION_SIZE,
+                                       HybridSliceDDPackageConfig::UT_MAT_NBUCKET,
+                                       HybridSliceDDPackageConfig::UT_MAT_INITIAL_ALLOCATION_SIZE,
+                                       HybridSliceDDPackageConfig::CT_VEC_ADD_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_MAT_ADD_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_MAT_TRANS_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_MAT_CONJ_TRANS_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_MAT_VEC_MULT_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_MAT_MAT_MULT_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_VEC_KRON_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_MAT_KRON_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_VEC_INNER_PROD_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_DM_NOISE_NBUCKET,
+                                       HybridSliceDDPackageConfig::UT_DM_NBUCKET,
+                                       HybridSliceDDPackageConfig::UT_DM_INITIAL_ALLOCATION_SIZE,
+                                       HybridSliceDDPackageConfig::CT_DM_DM_MULT_NBUCKET,
+                                       HybridSliceDDPackageConfig::CT_DM_ADD_NBUCKET,
+                                       HybridSliceDDPackageConfig::STOCHASTIC_CACHE_OPS>;
+
+// Packages for deep circuits on many qubits, whose states consist of far more nodes than the default unique table is
+// tuned for. The vector unique table and the compute tables of matrix-vector multiplication and vector addition are
+// enlarged accordingly, at the cost of a higher memory footprint even for small states.
+struct DeepCircuitDDPackageConfig: public dd::DDPackageConfig {
+    static constexpr std::size_t UT_VEC_NBUCKET                 = 262144U;
+    static constexpr std::size_t UT_VEC_INITIAL_ALLOCATION_SIZE = 32768U;
+
+    static constexpr std::size_t CT_VEC_ADD_NBUCKET      = 65536U;
+    static constexpr std::size_t CT_MAT_VEC_MULT_NBUCKET = 65536U;
+};
+
+using DeepCircuitPackage = dd::Package<DeepCircuitDDPackageConfig::UT_VEC_NBUCKET,
+                                       DeepCircuitDDPackageConfig::UT_VEC_INITIAL_ALLOCATION_SIZE,
+                                       DeepCircuitDDPackageConfig::UT_MAT_NBUCKET,
+                                       DeepCircuitDDPackageConfig::UT_MAT_INITIAL_ALLOCATION_SIZE,
+                                       DeepCircuitDDPackageConfig::CT_VEC_ADD_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_MAT_ADD_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_MAT_TRANS_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_MAT_CONJ_TRANS_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_MAT_VEC_MULT_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_MAT_MAT_MULT_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_VEC_KRON_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_MAT_KRON_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_VEC_INNER_PROD_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_DM_NOISE_NBUCKET,
+                                       DeepCircuitDDPackageConfig::UT_DM_NBUCKET,
+                                       DeepCircuitDDPackageConfig::UT_DM_INITIAL_ALLOCATION_SIZE,
+                                       DeepCircuitDDPackageConfig::CT_DM_DM_MULT_NBUCKET,
+                                       DeepCircuitDDPackageConfig::CT_DM_ADD_NBUCKET,
+                                       DeepCircuitDDPackageConfig::STOCHASTIC_CACHE_OPS>;
+
 #endif //DDSIMULATOR_H
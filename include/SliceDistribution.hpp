@@ -0,0 +1,48 @@
+#ifndef DDSIM_SLICEDISTRIBUTION_HPP
+#define DDSIM_SLICEDISTRIBUTION_HPP
+
+#include "dd/Definitions.hpp"
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <mpi.h>
+#include <utility>
+
+// Hands out the slices of a hybrid Schrodinger-Feynman simulation to the ranks of a communicator on demand. The index of
+// the next slice to be simulated is a counter on rank 0 that all ranks increment through one-sided communication, so
+// faster ranks simply fetch more batches. Batches are aligned blocks of slices whose size is a power of two. Construction
+// and destruction are collective operations over the communicator; next is only called from the thread that created the
+// distribution, hence MPI_THREAD_FUNNELED suffices.
+class SliceDistribution {
+public:
+    // blockSize (a power of two dividing nslices) is the number of slices simulated by a single task, every batch consists
+    // of at least minBlocksPerBatch blocks
+    SliceDistribution(MPI_Comm comm, std::int64_t nslices, std::int64_t blockSize, std::int64_t minBlocksPerBatch);
+    ~SliceDistribution();
+
+    SliceDistribution(const SliceDistribution&)            = delete;
+    SliceDistribution& operator=(const SliceDistribution&) = delete;
+
+    // the next range [first, last) of slices for this rank, which is empty once all slices have been handed out
+    std::pair<std::int64_t, std::int64_t> next();
+
+    [[nodiscard]] std::int64_t getBatchSize() const { return batchSize; }
+
+    // sums up amplitudes element-wise over all ranks of comm, so every rank ends up with the complete result
+    static void allreduce(MPI_Comm comm, std::complex<dd::fp>* amplitudes, std::size_t size);
+
+    // true on all ranks if it is true on any of them
+    static bool any(MPI_Comm comm, bool value);
+
+private:
+    // few large batches keep the traffic to rank 0 low, enough batches per rank balance the load
+    static constexpr std::int64_t BATCHES_PER_RANK = 64;
+
+    std::int64_t  nslices;
+    std::int64_t  batchSize;
+    MPI_Win       window  = MPI_WIN_NULL;
+    std::int64_t* counter = nullptr;
+};
+
+#endif //DDSIM_SLICEDISTRIBUTION_HPP
@@ -1,10 +1,15 @@
 #pragma once
 
+#include "OperationCache.hpp"
 #include "QuantumComputation.hpp"
 #include "Simulator.hpp"
 #include "dd/NoiseFunctionality.hpp"
 
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <stdexcept>
+#include <taskflow/taskflow.hpp>
 #include <thread>
 #include <vector>
 
@@ -47,6 +52,7 @@ public:
     std::vector<std::pair<long, std::string>>        recordedProperties;
     std::vector<std::vector<double>>                 recordedPropertiesPerInstance;
     std::vector<double>                              finalProperties;
+    std::vector<double>                              finalPropertyErrors; // half-widths of the confidence intervals of finalProperties
     std::vector<std::map<std::string, unsigned int>> classicalMeasurementsMaps;
     std::map<std::string, unsigned int>              finalClassicalMeasurementsMap;
 
@@ -96,6 +102,22 @@ public:
 
     void setRecordedProperties(const std::string& input);
 
+    // Stop the stochastic simulation as soon as the confidence intervals of all recorded amplitudes are narrower than
+    // +-maxError. The number of stochastic runs passed to the constructor serves as upper limit. A maxError of 0 disables the check.
+    void setTargetError(double maxError, double confidence = 0.95) {
+        if (maxError < 0. || confidence <= 0. || confidence >= 1.) {
+            throw std::invalid_argument("Target error must be non-negative and confidence must be in (0, 1).");
+        }
+        targetError     = maxError;
+        confidenceLevel = confidence;
+    }
+
+    // Every worker keeps its package and gate DDs for all of its runs. Disabling the reuse builds a fresh package for every
+    // run instead, which is only useful as a baseline for benchmarks.
+    void setPackageReuse(bool reuse) { packageReuse = reuse; }
+
+    [[nodiscard]] bool getPackageReuse() const { return packageReuse; }
+
     std::map<std::string, std::string> AdditionalStatistics() override {
         return {
                 {"step_fidelity", std::to_string(stepFidelity)},
@@ -105,7 +127,16 @@ public:
                 {"mean_stoch_run_time", std::to_string(meanStochTime)},
                 {"parallel_instances", std::to_string(maxInstances)},
                 {"stoch_runs", std::to_string(stochasticRuns)},
+                {"stoch_chunks", std::to_string(stochChunks)},
+                {"executed_stoch_runs", std::to_string(executedRuns)},
+                {"target_error", std::to_string(targetError)},
+                {"confidence_level", std::to_string(confidenceLevel)},
+                {"max_error_bar", std::to_string(maxPropertyError)},
                 {"threads", std::to_string(maxInstances)},
+                {"memory_limit", std::to_string(Simulator<DDPackage>::memory_limit)},
+                {"memory_limit_approximations", std::to_string(Simulator<DDPackage>::memory_limit_approximations)},
+                {"memory_limit_fidelity_loss", std::to_string(executedRuns > 0U ? memoryLimitFidelityLoss / static_cast<double>(executedRuns) : 0.)},
+                {"memory_limit_exceeded", Simulator<DDPackage>::memory_limit_exceeded ? "1" : "0"},
         };
     };
 
@@ -129,14 +160,55 @@ private:
     double stochRunTime{};
     double meanStochTime{};
 
+    std::size_t stochChunks{};
+    bool        packageReuse{true};
+
+    double                       targetError{0.};
+    double                       confidenceLevel{0.95};
+    std::size_t                  executedRuns{};
+    double                       maxPropertyError{};
+    static constexpr std::size_t minimumBatchSize{128U};
+
+    // summed over all executed runs; guarded by memoryLimitMutex since it is updated by the workers
+    double     memoryLimitFidelityLoss{};
+    std::mutex memoryLimitMutex;
+
     void perfectSimulationRun();
 
-    void runStochSimulationForId(std::size_t                                stochRun,
-                                 dd::Qubit                                  nQubits,
-                                 std::vector<double>&                       recordedPropertiesStorage,
-                                 std::vector<std::pair<long, std::string>>& recordedPropertiesList,
-                                 std::map<std::string, unsigned int>&       classicalMeasurementsMap,
-                                 unsigned long long                         localSeed);
+    // the package of a worker thread and the gate DDs pinned in it, both kept for all runs of a simulation
+    struct WorkerPackage {
+        std::unique_ptr<StochasticNoisePackage> dd{};
+        OperationCache<StochasticNoisePackage>  opCache{};
+
+        WorkerPackage()                                = default;
+        WorkerPackage(const WorkerPackage&)            = delete;
+        WorkerPackage& operator=(const WorkerPackage&) = delete;
+        ~WorkerPackage() {
+            if (dd) {
+                opCache.clear(dd);
+            }
+        }
+    };
+
+    // returns the number of completed runs, which is less than runs if the memory limit was exceeded
+    std::size_t runStochBatch(std::size_t                 runs,
+                              tf::Executor&               executor,
+                              std::vector<WorkerPackage>& workerPackages,
+                              std::vector<double>&        squaredPropertySums);
+
+    double updatePropertyErrors(const std::vector<double>& squaredPropertySums, double zScore);
+
+    static double confidenceToZScore(double confidence);
+
+    std::size_t runStochSimulationForId(std::size_t                                numberOfRuns,
+                                        dd::Qubit                                  nQubits,
+                                        std::unique_ptr<StochasticNoisePackage>&   localDD,
+                                        OperationCache<StochasticNoisePackage>&    opCache,
+                                        std::vector<double>&                       recordedPropertiesStorage,
+                                        std::vector<double>&                       squaredPropertiesStorage,
+                                        std::vector<std::pair<long, std::string>>& recordedPropertiesList,
+                                        std::map<std::string, unsigned int>&       classicalMeasurementsMap,
+                                        unsigned long long                         localSeed);
 
     [[nodiscard]] std::string intToString(long targetNumber) const;
 };
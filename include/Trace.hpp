@@ -0,0 +1,104 @@
+#ifndef DDSIM_TRACE_HPP
+#define DDSIM_TRACE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A single timed span of a simulation. Node counts refer to the DD the simulator evolves, the table counters are the
+// lookups and hits of the unique and compute tables of the package during the span.
+struct TraceEvent {
+    enum class Kind {
+        Operation,        // application of a single operation (or of a block of fused operations)
+        GarbageCollection // a garbage collection of the package
+    };
+
+    Kind          kind           = Kind::Operation;
+    std::string   name{};
+    std::size_t   index          = 0; // position of the operation in the simulated sequence
+    std::size_t   thread         = 0;
+    std::int64_t  start          = 0; // ns since the tracer was created
+    std::int64_t  duration       = 0; // ns
+    std::size_t   nodesBefore    = 0;
+    std::size_t   nodesAfter     = 0;
+    std::uint64_t uniqueLookups  = 0;
+    std::uint64_t uniqueHits     = 0;
+    std::uint64_t computeLookups = 0;
+    std::uint64_t computeHits    = 0;
+};
+
+// Collects trace events of one or more threads. Tracing is only compiled in if DDSIM_TRACING is defined (see the CMake
+// option of the same name); otherwise ENABLED is false and all instrumentation in the simulators is discarded at compile time.
+class Tracer {
+public:
+#ifdef DDSIM_TRACING
+    static constexpr bool ENABLED = true;
+#else
+    static constexpr bool ENABLED = false;
+#endif
+
+    Tracer() = default;
+
+    void record(TraceEvent event) {
+        const std::lock_guard lock(mutex);
+        events.emplace_back(std::move(event));
+    }
+
+    [[nodiscard]] std::vector<TraceEvent> getEvents() const {
+        const std::lock_guard lock(mutex);
+        return events;
+    }
+
+    void clear() {
+        const std::lock_guard lock(mutex);
+        events.clear();
+    }
+
+    [[nodiscard]] std::int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count();
+    }
+
+    // index of the calling thread, counting threads in the order they were first seen
+    std::size_t threadIndex();
+
+    // complete events ("ph": "X") in the Trace Event Format understood by chrome://tracing and Perfetto
+    void writeChromeTrace(std::ostream& os) const;
+    // one line per event with a header line
+    void writeCSV(std::ostream& os) const;
+    // picks the format by the extension of file: CSV for ".csv", Chrome trace JSON otherwise
+    void write(const std::string& file) const;
+
+private:
+    mutable std::mutex                    mutex{};
+    std::vector<TraceEvent>               events{};
+    std::vector<std::size_t>              threads{}; // hashes of the thread ids in the order of threadIndex()
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
+
+// lookups and hits of the tables of a package that dominate the simulation of states and operations
+struct TableCounters {
+    std::uint64_t uniqueLookups  = 0;
+    std::uint64_t uniqueHits     = 0;
+    std::uint64_t computeLookups = 0;
+    std::uint64_t computeHits    = 0;
+
+    template<class Package>
+    static TableCounters of(const std::unique_ptr<Package>& package) {
+        TableCounters counters{};
+        counters.uniqueLookups  = package->vUniqueTable.getLookups() + package->mUniqueTable.getLookups() + package->dUniqueTable.getLookups();
+        counters.uniqueHits     = package->vUniqueTable.getHits() + package->mUniqueTable.getHits() + package->dUniqueTable.getHits();
+        counters.computeLookups = package->matrixVectorMultiplication.getLookups() + package->matrixMatrixMultiplication.getLookups() +
+                                  package->vectorAdd.getLookups() + package->matrixAdd.getLookups();
+        counters.computeHits    = package->matrixVectorMultiplication.getHits() + package->matrixMatrixMultiplication.getHits() +
+                                  package->vectorAdd.getHits() + package->matrixAdd.getHits();
+        return counters;
+    }
+};
+
+#endif //DDSIM_TRACE_HPP
@@ -6,14 +6,22 @@
 #include "QuantumComputation.hpp"
 #include "dd/Package.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <map>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 template<class DDPackage = dd::Package<>>
 class UnitarySimulator: public CircuitSimulator<DDPackage> {
 public:
     enum class Mode {
         Sequential,
-        Recursive
+        Recursive,
+        // balanced tree over the operations; the leaves are built in separate packages on a thread pool and multiplied pairwise
+        ParallelRecursive
     };
 
     explicit UnitarySimulator(std::unique_ptr<qc::QuantumComputation>&& qc, Mode mode = Mode::Recursive):
@@ -34,7 +42,25 @@ public:
     [[nodiscard]] qc::MatrixDD getConstructedDD() const { return e; }
     [[nodiscard]] double       getConstructionTime() const { return constructionTime; }
     [[nodiscard]] std::size_t  getFinalNodeCount() const { return Simulator<DDPackage>::dd->size(e); }
-    [[nodiscard]] std::size_t  getMaxNodeCount() const override { return Simulator<DDPackage>::dd->mUniqueTable.getPeakNodeCount(); }
+    [[nodiscard]] std::size_t  getMaxNodeCount() const override { return std::max<std::size_t>(Simulator<DDPackage>::dd->mUniqueTable.getPeakNodeCount(), parallelMaxNodeCount); }
+
+    // number of threads used by Mode::ParallelRecursive
+    void setThreads(std::size_t threads) { nthreads = std::max<std::size_t>(threads, 1U); }
+
+    [[nodiscard]] std::size_t getThreads() const { return nthreads; }
+
+    // per level of the ParallelRecursive tree (leaves first): wall time and largest peak node count of the packages involved
+    [[nodiscard]] const std::vector<double>&      getLevelConstructionTimes() const { return levelConstructionTimes; }
+    [[nodiscard]] const std::vector<std::size_t>& getLevelMaxNodeCounts() const { return levelMaxNodeCounts; }
+
+    std::map<std::string, std::string> AdditionalStatistics() override {
+        auto stats = CircuitSimulator<DDPackage>::AdditionalStatistics();
+        for (std::size_t level = 0; level < levelConstructionTimes.size(); ++level) {
+            stats["level_" + std::to_string(level) + "_construction_time"] = std::to_string(levelConstructionTimes[level]);
+            stats["level_" + std::to_string(level) + "_max_nodes"]         = std::to_string(levelMaxNodeCounts[level]);
+        }
+        return stats;
+    }
 
 private:
     qc::MatrixDD e{};
@@ -42,6 +68,16 @@ private:
     Mode mode = Mode::Recursive;
 
     double constructionTime = 0.;
+
+    std::size_t              nthreads             = std::max(std::thread::hardware_concurrency(), 1U);
+    std::size_t              parallelMaxNodeCount = 0;
+    std::vector<double>      levelConstructionTimes{};
+    std::vector<std::size_t> levelMaxNodeCounts{};
+
+    // leaves with fewer operations do not pay off the transfer between packages
+    static constexpr std::size_t MIN_OPS_PER_LEAF = 64U;
+
+    qc::MatrixDD ConstructParallel();
 };
 
 #endif //DDSIM_UNITARYSIMULATOR_HPP
@@ -1,3 +1,3 @@
 from mqt.ddsim.provider import DDSIMProvider
-from mqt.ddsim.pyddsim import CircuitSimulator, HybridCircuitSimulator, PathCircuitSimulator, UnitarySimulator, HybridMode, \
-    PathSimulatorMode, PathSimulatorConfiguration, ConstructionMode, get_matrix, dump_tensor_network, __version__
+from mqt.ddsim.pyddsim import CircuitSimulator, DeepCircuitSimulator, HybridCircuitSimulator, PathCircuitSimulator, UnitarySimulator, ParameterSweep, HybridMode, \
+    SimulationCancelled, SimulationProgress, PathSimulatorMode, PathSimulatorConfiguration, ConstructionMode, get_matrix, dump_tensor_network, __version__
@@ -5,23 +5,28 @@
 // clang-format off
 #include "CircuitSimulator.hpp"
 #include "HybridSchrodingerFeynmanSimulator.hpp"
+#include "ParameterSweep.hpp"
 #include "PathSimulator.hpp"
 #include "UnitarySimulator.hpp"
 #include "qiskit/QasmQobjExperiment.hpp"
 #include "qiskit/QuantumCircuit.hpp"
 
+#include <pybind11/complex.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 // clang-format on
 
 namespace py = pybind11;
 using namespace pybind11::literals;
 
-template<class Simulator, typename... Args>
-std::unique_ptr<Simulator> create_simulator(const py::object& circ, const long long int seed, Args&&... args) {
+std::unique_ptr<qc::QuantumComputation> import_circuit(const py::object& circ) {
     py::object QuantumCircuit       = py::module::import("qiskit").attr("QuantumCircuit");
     py::object pyQasmQobjExperiment = py::module::import("qiskit.qobj").attr("QasmQobjExperiment");
 
@@ -37,6 +42,12 @@ std::unique_ptr<Simulator> create_simulator(const py::object& circ, const long l
     } else {
         throw std::runtime_error("PyObject is neither py::str, QuantumCircuit, nor QasmQobjExperiment");
     }
+    return qc;
+}
+
+template<class Simulator, typename... Args>
+std::unique_ptr<Simulator> create_simulator(const py::object& circ, const long long int seed, Args&&... args) {
+    auto qc = import_circuit(circ);
 
     if constexpr (std::is_same_v<Simulator, PathSimulator<>>) {
         return std::make_unique<Simulator>(std::move(qc),
@@ -54,6 +65,22 @@ std::unique_ptr<Simulator> create_simulator(const py::object& circ, const long l
     }
 }
 
+std::unique_ptr<ParameterSweep<>> create_parameter_sweep(const py::object& circ, const long long int seed, const std::size_t nthreads) {
+    auto qc = import_circuit(circ);
+    if (seed < 0) {
+        return std::make_unique<ParameterSweep<>>(std::move(qc), nthreads);
+    }
+    return std::make_unique<ParameterSweep<>>(std::move(qc), static_cast<unsigned long long>(seed), nthreads);
+}
+
+PauliSum to_pauli_sum(const std::vector<std::pair<std::string, double>>& observable) {
+    PauliSum sum;
+    for (const auto& [pauli, coefficient]: observable) {
+        sum.push_back({coefficient, pauli});
+    }
+    return sum;
+}
+
 template<class Simulator, typename... Args>
 std::unique_ptr<Simulator> create_simulator_without_seed(const py::object& circ, Args&&... args) {
     return create_simulator<Simulator>(circ, -1, std::forward<Args>(args)...);
@@ -103,6 +130,35 @@ void getNumpyMatrix(UnitarySimulator<DDPackage>& sim, py::array_t<std::complex<d
     getNumpyMatrixRec(e, std::complex<dd::fp>{1.0, 0.0}, 0, 0, dim, dataPtr);
 }
 
+template<class Sim>
+py::array_t<std::complex<dd::fp>> getNumpyVector(Sim& sim) {
+    if (sim.getNumberOfQubits() >= 60) {
+        throw std::range_error("getNumpyVector only supports up to 59 qubits.");
+    }
+    const auto                        dim = static_cast<py::ssize_t>(1ULL << sim.getNumberOfQubits());
+    py::array_t<std::complex<dd::fp>> vector(dim);
+    auto*                             dataPtr = vector.mutable_data();
+    {
+        // the amplitudes are written straight into the numpy buffer, no Python objects are touched in between
+        py::gil_scoped_release release;
+        sim.getVectorComplexInto(dataPtr);
+    }
+    return vector;
+}
+
+template<class Sim>
+void exportNumpyVector(const Sim& sim, const std::string& file) {
+    auto amplitudes = sim.getVectorComplexMapped(file);
+    amplitudes.flush();
+}
+
+py::array_t<std::complex<dd::fp>> getNumpyFinalAmplitudes(const HybridSchrodingerFeynmanSimulator<>& sim) {
+    const auto&                       amplitudes = sim.getFinalAmplitudes();
+    py::array_t<std::complex<dd::fp>> vector(static_cast<py::ssize_t>(amplitudes.size()));
+    std::copy(amplitudes.begin(), amplitudes.end(), vector.mutable_data());
+    return vector;
+}
+
 void dump_tensor_network(const py::object& circ, const std::string& filename) {
     py::object QuantumCircuit       = py::module::import("qiskit").attr("QuantumCircuit");
     py::object pyQasmQobjExperiment = py::module::import("qiskit.qobj").attr("QasmQobjExperiment");
@@ -122,21 +178,82 @@ void dump_tensor_network(const py::object& circ, const std::string& filename) {
     }
 }
 
+// the circuit simulator is bound once per package configuration it is instantiated for
+template<class Sim>
+void bind_circuit_simulator(py::module& m, const char* name, const char* doc = "") {
+    py::class_<Sim>(m, name, doc)
+            .def(py::init<>(&create_simulator<Sim>), "circ"_a, "seed"_a)
+            .def(py::init<>(&create_simulator_without_seed<Sim>), "circ"_a)
+            .def("get_number_of_qubits", &Sim::getNumberOfQubits)
+            .def("get_name", &Sim::getName)
+            .def("simulate", &Sim::Simulate, "shots"_a, py::call_guard<py::gil_scoped_release>())
+            .def("simulate_amplitudes", &Sim::SimulateAmplitudes, "indices"_a, "projected_layers"_a = 1, py::call_guard<py::gil_scoped_release>(),
+                 R"pbdoc(Amplitudes of the given basis states (bit i of an index corresponds to qubit i) without building the final state)pbdoc")
+            .def("get_amplitudes", &Sim::getAmplitudes, "indices"_a)
+            .def("set_gate_fusion", &Sim::setGateFusion, "max_width"_a)
+            .def("enable_tracing", &Sim::enableTracing, "enable"_a = true)
+            .def("write_trace", &Sim::writeTrace, "file"_a)
+            .def("cancel", &Sim::cancel, R"pbdoc(Asks a running simulate call, e.g., on another thread, to raise SimulationCancelled)pbdoc")
+            .def("get_progress", &Sim::getProgress)
+            .def(
+                    "expectation_value", [](const Sim& sim, const std::vector<std::pair<std::string, double>>& observable) {
+                        return sim.expectationValue(to_pauli_sum(observable));
+                    },
+                    "observable"_a, py::call_guard<py::gil_scoped_release>())
+            .def("statistics", &Sim::AdditionalStatistics)
+            .def("get_vector", &getNumpyVector<Sim>)
+            .def("export_vector", &exportNumpyVector<Sim>, "file"_a, py::call_guard<py::gil_scoped_release>(),
+                 R"pbdoc(Writes the state vector to file without holding it in memory, it can be opened with np.memmap(file, dtype=np.complex128))pbdoc");
+}
+
 PYBIND11_MODULE(pyddsim, m) {
     m.doc() = "Python interface for the MQT DDSIM quantum circuit simulator";
+    m.attr("tracing_available") = Tracer::ENABLED;
 
-    py::class_<CircuitSimulator<>>(m, "CircuitSimulator")
-            .def(py::init<>(&create_simulator<CircuitSimulator<>>), "circ"_a, "seed"_a)
-            .def(py::init<>(&create_simulator_without_seed<CircuitSimulator<>>), "circ"_a)
-            .def("get_number_of_qubits", &CircuitSimulator<>::getNumberOfQubits)
-            .def("get_name", &CircuitSimulator<>::getName)
-            .def("simulate", &CircuitSimulator<>::Simulate, "shots"_a)
-            .def("statistics", &CircuitSimulator<>::AdditionalStatistics)
-            .def("get_vector", &CircuitSimulator<>::getVectorComplex);
+    py::register_exception<SimulationCancelled>(m, "SimulationCancelled");
+
+    py::class_<SimulationProgress>(m, "SimulationProgress", "Units of work done so far by a running simulation")
+            .def_readonly("done", &SimulationProgress::done)
+            .def_readonly("total", &SimulationProgress::total, R"pbdoc(0 if the amount of work is not known in advance)pbdoc")
+            .def_readonly("nodes", &SimulationProgress::nodes)
+            .def("__repr__", [](const SimulationProgress& p) {
+                return "SimulationProgress(done=" + std::to_string(p.done) + ", total=" + std::to_string(p.total) + ", nodes=" + std::to_string(p.nodes) + ")";
+            });
+
+    bind_circuit_simulator<CircuitSimulator<>>(m, "CircuitSimulator");
+    bind_circuit_simulator<CircuitSimulator<DeepCircuitPackage>>(m, "DeepCircuitSimulator", "Circuit simulator whose package is tuned for deep circuits with large states (see DeepCircuitPackage)");
+
+    py::class_<ParameterSweep<>>(m, "ParameterSweep", "Simulates a circuit template for many parameter sets with one warm simulator per worker thread")
+            .def(py::init<>(&create_parameter_sweep),
+                 "circ"_a, "seed"_a = -1, "nthreads"_a = std::thread::hardware_concurrency())
+            .def("get_number_of_parameters", &ParameterSweep<>::getNumberOfParameters)
+            .def(
+                    "parameters_of", [](const ParameterSweep<>& sweep, const py::object& circ) {
+                        return sweep.parametersOf(*import_circuit(circ));
+                    },
+                    "circ"_a, R"pbdoc(Rotation angles of a bound instance of the template, raises ValueError if its structure differs)pbdoc")
+            .def("simulate", &ParameterSweep<>::Simulate, "parameters"_a, "shots"_a, py::call_guard<py::gil_scoped_release>())
+            .def(
+                    "simulate_circuits", [](ParameterSweep<>& sweep, const py::list& circuits, const unsigned int shots) {
+                        std::vector<std::vector<dd::fp>> parameters;
+                        for (const auto& circ: circuits) {
+                            parameters.emplace_back(sweep.parametersOf(*import_circuit(py::reinterpret_borrow<py::object>(circ))));
+                        }
+                        const py::gil_scoped_release release;
+                        return sweep.Simulate(parameters, shots);
+                    },
+                    "circuits"_a, "shots"_a, R"pbdoc(Counts for every bound instance of the template)pbdoc")
+            .def(
+                    "expectation_values", [](ParameterSweep<>& sweep, const std::vector<std::vector<dd::fp>>& parameters, const std::vector<std::pair<std::string, double>>& observable) {
+                        return sweep.ExpectationValues(parameters, to_pauli_sum(observable));
+                    },
+                    "parameters"_a, "observable"_a, py::call_guard<py::gil_scoped_release>())
+            .def("statistics", &ParameterSweep<>::AdditionalStatistics);
 
     py::enum_<HybridSchrodingerFeynmanSimulator<>::Mode>(m, "HybridMode")
             .value("DD", HybridSchrodingerFeynmanSimulator<>::Mode::DD)
             .value("amplitude", HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude)
+            .value("shared_amplitude", HybridSchrodingerFeynmanSimulator<>::Mode::SharedAmplitude)
             .export_values();
 
     py::class_<HybridSchrodingerFeynmanSimulator<>>(m, "HybridCircuitSimulator")
@@ -146,17 +263,27 @@ PYBIND11_MODULE(pyddsim, m) {
                  "circ"_a, "mode"_a = HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, "nthreads"_a = 2)
             .def("get_number_of_qubits", &CircuitSimulator<>::getNumberOfQubits)
             .def("get_name", &CircuitSimulator<>::getName)
-            .def("simulate", &HybridSchrodingerFeynmanSimulator<>::Simulate, "shots"_a)
+            .def("simulate", &HybridSchrodingerFeynmanSimulator<>::Simulate, "shots"_a, py::call_guard<py::gil_scoped_release>())
+            .def("simulate_amplitudes", &HybridSchrodingerFeynmanSimulator<>::SimulateAmplitudes, "indices"_a, "projected_layers"_a = 1, py::call_guard<py::gil_scoped_release>(),
+                 R"pbdoc(Amplitudes of the given basis states summed over all slices without building the final state)pbdoc")
+            .def("cancel", &HybridSchrodingerFeynmanSimulator<>::cancel)
+            .def("get_progress", &HybridSchrodingerFeynmanSimulator<>::getProgress)
             .def("statistics", &CircuitSimulator<>::AdditionalStatistics)
-            .def("get_vector", &CircuitSimulator<>::getVectorComplex)
+            .def("get_vector", &getNumpyVector<HybridSchrodingerFeynmanSimulator<>>)
             .def("get_mode", &HybridSchrodingerFeynmanSimulator<>::getMode)
-            .def("get_final_amplitudes", &HybridSchrodingerFeynmanSimulator<>::getFinalAmplitudes);
+            .def("set_split_qubit", &HybridSchrodingerFeynmanSimulator<>::setSplitQubit, "qubit"_a)
+            .def("get_split_qubit", &HybridSchrodingerFeynmanSimulator<>::getSplitQubit)
+            .def("set_amplitude_file", &HybridSchrodingerFeynmanSimulator<>::setAmplitudeFile, "file"_a,
+                 R"pbdoc(Maps the final amplitudes of the amplitude modes to file, which can be opened with np.memmap(file, dtype=np.complex128) after simulating)pbdoc")
+            .def("get_amplitude_file", &HybridSchrodingerFeynmanSimulator<>::getAmplitudeFile)
+            .def("get_final_amplitudes", &getNumpyFinalAmplitudes);
 
     // TODO: Add new strategies here
     py::enum_<PathSimulator<>::Configuration::Mode>(m, "PathSimulatorMode")
             .value("sequential", PathSimulator<>::Configuration::Mode::Sequential)
             .value("pairwise_recursive", PathSimulator<>::Configuration::Mode::PairwiseRecursiveGrouping)
             .value("cotengra", PathSimulator<>::Configuration::Mode::Cotengra)
+            .value("auto", PathSimulator<>::Configuration::Mode::Auto)
             .value("bracket", PathSimulator<>::Configuration::Mode::BracketGrouping)
             .value("alternating", PathSimulator<>::Configuration::Mode::Alternating)
             .export_values()
@@ -172,6 +299,10 @@ PYBIND11_MODULE(pyddsim, m) {
                            R"pbdoc(Start of the alternating strategy)pbdoc")
             .def_readwrite("seed", &PathSimulator<>::Configuration::seed,
                            R"pbdoc(Seed for the simulator)pbdoc")
+            .def_readwrite("auto_time_limit", &PathSimulator<>::Configuration::autoTimeLimit,
+                           R"pbdoc(Time limit (in seconds) for the automatic simulation path planner)pbdoc")
+            .def_readwrite("nthreads", &PathSimulator<>::Configuration::nthreads,
+                           R"pbdoc(Number of threads used for executing independent parts of the simulation path concurrently)pbdoc")
             .def("json", &PathSimulator<>::Configuration::json)
             .def("__repr__", &PathSimulator<>::Configuration::toString);
 
@@ -183,13 +314,16 @@ PYBIND11_MODULE(pyddsim, m) {
             .def("set_simulation_path", py::overload_cast<const PathSimulator<>::SimulationPath::Components&, bool>(&PathSimulator<>::setSimulationPath))
             .def("get_number_of_qubits", &CircuitSimulator<>::getNumberOfQubits)
             .def("get_name", &CircuitSimulator<>::getName)
-            .def("simulate", &PathSimulator<>::Simulate, "shots"_a)
+            .def("simulate", &PathSimulator<>::Simulate, "shots"_a, py::call_guard<py::gil_scoped_release>())
+            .def("cancel", &PathSimulator<>::cancel)
+            .def("get_progress", &PathSimulator<>::getProgress)
             .def("statistics", &CircuitSimulator<>::AdditionalStatistics)
-            .def("get_vector", &CircuitSimulator<>::getVectorComplex);
+            .def("get_vector", &getNumpyVector<PathSimulator<>>);
 
     py::enum_<UnitarySimulator<>::Mode>(m, "ConstructionMode")
             .value("recursive", UnitarySimulator<>::Mode::Recursive)
             .value("sequential", UnitarySimulator<>::Mode::Sequential)
+            .value("parallel_recursive", UnitarySimulator<>::Mode::ParallelRecursive)
             .export_values();
 
     py::class_<UnitarySimulator<>>(m, "UnitarySimulator")
@@ -199,11 +333,14 @@ PYBIND11_MODULE(pyddsim, m) {
                  "circ"_a, "mode"_a = UnitarySimulator<>::Mode::Recursive)
             .def("get_number_of_qubits", &CircuitSimulator<>::getNumberOfQubits)
             .def("get_name", &CircuitSimulator<>::getName)
-            .def("construct", &UnitarySimulator<>::Construct)
+            .def("construct", &UnitarySimulator<>::Construct, py::call_guard<py::gil_scoped_release>())
             .def("get_mode", &UnitarySimulator<>::getMode)
             .def("get_construction_time", &UnitarySimulator<>::getConstructionTime)
             .def("get_final_node_count", &UnitarySimulator<>::getFinalNodeCount)
-            .def("get_max_node_count", &UnitarySimulator<>::getMaxNodeCount);
+            .def("get_max_node_count", &UnitarySimulator<>::getMaxNodeCount)
+            .def("set_threads", &UnitarySimulator<>::setThreads, "threads"_a)
+            .def("get_level_construction_times", &UnitarySimulator<>::getLevelConstructionTimes)
+            .def("get_level_max_node_counts", &UnitarySimulator<>::getLevelMaxNodeCounts);
 
     m.def("get_matrix", &getNumpyMatrix<>, "sim"_a, "mat"_a);
 
@@ -15,7 +15,7 @@ from qiskit.result import Result
 from qiskit.compiler import assemble
 from qiskit.utils.multiprocessing import local_hardware_info
 
-from .job import DDSIMJob
+from .job import DDSIMJob, running
 from .error import DDSIMError
 from mqt import ddsim
 
@@ -34,7 +34,8 @@ class HybridQasmSimulator(BackendV1):
             parameter_binds=None,
             simulator_seed=None,
             mode="amplitude",
-            nthreads=local_hardware_info()['cpus']
+            nthreads=local_hardware_info()['cpus'],
+            split_qubit=None
         )
 
     def __init__(self, configuration=None, provider=None):
@@ -120,19 +121,28 @@ class HybridQasmSimulator(BackendV1):
                 raise DDSIMError('Not enough memory available to simulate the circuit even on a single thread')
             qubit_diff = max_qubits - algorithm_qubits
             nthreads = int(min(2 ** qubit_diff, nthreads))
+        elif mode == 'shared_amplitude':
+            hybrid_mode = ddsim.HybridMode.shared_amplitude
+            max_qubits = int(log2(local_hardware_info()['memory'] * (1024 ** 3) / 16))
+            if qobj_experiment.header.n_qubits > max_qubits:
+                raise DDSIMError('Not enough memory available to simulate the circuit')
         elif mode == 'dd':
             hybrid_mode = ddsim.HybridMode.DD
         else:
-            raise DDSIMError('Simulation mode', mode, 'not supported by MQT hybrid simulator. Available modes are \'amplitude\' and \'dd\'')
+            raise DDSIMError('Simulation mode', mode, 'not supported by MQT hybrid simulator. Available modes are \'amplitude\', \'shared_amplitude\' and \'dd\'')
 
         sim = ddsim.HybridCircuitSimulator(qobj_experiment, seed, hybrid_mode, nthreads)
+        split_qubit = options.get('split_qubit', None)
+        if split_qubit is not None:
+            sim.set_split_qubit(int(split_qubit))
 
         shots = options.get('shots', 1024)
         if self.SHOW_STATE_VECTOR and shots > 0:
             logger.info('Statevector can only be shown if shots == 0 when using the amplitude hybrid simulation mode. Setting shots=0.')
             shots = 0
 
-        counts = sim.simulate(shots)
+        with running(options, sim):
+            counts = sim.simulate(shots)
         end_time = time.time()
         counts_hex = {hex(int(result, 2)): count for result, count in counts.items()}
 
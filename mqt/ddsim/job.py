@@ -1,10 +1,15 @@
 from concurrent import futures
+import contextlib
 import logging
 import functools
+import os
+import threading
 
 from qiskit.providers import JobV1
 from qiskit.providers import JobStatus, JobError
 
+from mqt.ddsim.pyddsim import SimulationCancelled
+
 logger = logging.getLogger(__name__)
 
 
@@ -25,13 +30,59 @@ def requires_submit(func):
     return _wrapper
 
 
+class JobControl:
+    """Connects a job to the simulator it is currently running, so the job can be cancelled and its progress queried
+    from other threads while the simulator runs without the GIL.
+    """
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self._simulator = None
+        self._cancelled = False
+
+    @property
+    def cancelled(self):
+        return self._cancelled
+
+    def cancel(self):
+        with self._lock:
+            self._cancelled = True
+            if self._simulator is not None:
+                self._simulator.cancel()
+
+    def progress(self):
+        """The SimulationProgress of the running simulator or None between simulations."""
+        with self._lock:
+            return None if self._simulator is None else self._simulator.get_progress()
+
+    @contextlib.contextmanager
+    def running(self, simulator):
+        with self._lock:
+            if self._cancelled:
+                raise SimulationCancelled('The simulation was cancelled.')
+            self._simulator = simulator
+        try:
+            yield simulator
+        finally:
+            with self._lock:
+                self._simulator = None
+
+
+def running(options, simulator):
+    """Context manager attaching simulator to the JobControl passed in options (if any) while it simulates."""
+    control = options.get('job_control', None)
+    return control.running(simulator) if control is not None else contextlib.nullcontext(simulator)
+
+
 class DDSIMJob(JobV1):
     """AerJob class.
     Attributes:
         _executor (futures.Executor): executor to handle asynchronous jobs
     """
 
-    _executor = futures.ThreadPoolExecutor(max_workers=1)
+    # The simulators release the GIL while simulating and separate instances share no mutable state,
+    # so jobs can run concurrently. DDSIM_MAX_PARALLEL_JOBS limits the number of concurrent jobs.
+    _executor = futures.ThreadPoolExecutor(max_workers=int(os.environ.get("DDSIM_MAX_PARALLEL_JOBS", os.cpu_count() or 1)))
 
     def __init__(self, backend, job_id, fn, qobj_experiment, **args):
         super().__init__(backend, job_id)
@@ -39,6 +90,7 @@ class DDSIMJob(JobV1):
         self.qobj_experiment = qobj_experiment
         self._args = args
         self._future = None
+        self._control = JobControl()
 
     def submit(self):
         """Submit the job to the backend for execution.
@@ -53,6 +105,7 @@ class DDSIMJob(JobV1):
         self._future = self._executor.submit(self._fn,
                                              self._job_id,
                                              self.qobj_experiment,
+                                             job_control=self._control,
                                              **self._args)
 
     @requires_submit
@@ -69,11 +122,27 @@ class DDSIMJob(JobV1):
             concurrent.futures.TimeoutError: if timeout occurred.
             concurrent.futures.CancelledError: if job cancelled before completed.
         """
-        return self._future.result(timeout=timeout)
+        try:
+            return self._future.result(timeout=timeout)
+        except SimulationCancelled as e:
+            raise futures.CancelledError() from e
 
     @requires_submit
     def cancel(self):
-        return self._future.cancel()
+        """Cancel the job. A pending job is never started, a running one stops at the next unit of work of its
+        simulator. Returns False if the job has already finished.
+        """
+        if self._future.cancel():
+            return True
+        if self._future.done():
+            return False
+        self._control.cancel()
+        return True
+
+    @requires_submit
+    def progress(self):
+        """The SimulationProgress of the experiment that is currently simulated or None if there is none."""
+        return self._control.progress()
 
     @requires_submit
     def status(self) -> JobStatus:
@@ -90,7 +159,13 @@ class DDSIMJob(JobV1):
         elif self._future.cancelled():
             _status = JobStatus.CANCELLED
         elif self._future.done():
-            _status = JobStatus.DONE if self._future.exception() is None else JobStatus.ERROR
+            exception = self._future.exception()
+            if exception is None:
+                _status = JobStatus.DONE
+            elif isinstance(exception, SimulationCancelled):
+                _status = JobStatus.CANCELLED
+            else:
+                _status = JobStatus.ERROR
         else:
             # Note: There is an undocumented Future state: PENDING, that seems to show up when
             # the job is enqueued, waiting for someone to pick it up. We need to deal with this
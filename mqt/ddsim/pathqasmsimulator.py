@@ -15,7 +15,7 @@ from qiskit.qobj import QasmQobjExperiment, Qobj, QasmQobj, PulseQobj
 from qiskit.result import Result
 from qiskit.compiler import assemble
 
-from .job import DDSIMJob
+from .job import DDSIMJob, running
 from mqt import ddsim
 
 logger = logging.getLogger(__name__)
@@ -123,6 +123,8 @@ class PathQasmSimulator(BackendV1):
             bracket_size=None,
             alternating_start=None,
             seed=None,
+            nthreads=None,
+            auto_time_limit=None,
             cotengra_max_time=60,
             cotengra_max_repeats=1024,
             cotengra_plot_ring=False,
@@ -221,6 +223,14 @@ class PathQasmSimulator(BackendV1):
         if seed is not None:
             pathsim_configuration.seed = seed
 
+        auto_time_limit = options.get('auto_time_limit')
+        if auto_time_limit is not None:
+            pathsim_configuration.auto_time_limit = auto_time_limit
+
+        nthreads = options.get('nthreads')
+        if nthreads is not None:
+            pathsim_configuration.nthreads = nthreads
+
         sim = ddsim.PathCircuitSimulator(qobj_experiment, config=pathsim_configuration)
 
         # determine the contraction path using cotengra in case this is requested
@@ -235,7 +245,8 @@ class PathQasmSimulator(BackendV1):
 
         shots = options.get('shots', 1024)
         setup_time = time.time()
-        counts = sim.simulate(shots)
+        with running(options, sim):
+            counts = sim.simulate(shots)
         end_time = time.time()
         counts_hex = {hex(int(result, 2)): count for result, count in counts.items()}
 
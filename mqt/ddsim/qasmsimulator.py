@@ -13,7 +13,7 @@ from qiskit.qobj import QasmQobjExperiment, Qobj, QasmQobj, PulseQobj
 from qiskit.result import Result
 from qiskit.compiler import assemble
 
-from .job import DDSIMJob
+from .job import DDSIMJob, running
 from mqt import ddsim
 
 logger = logging.getLogger(__name__)
@@ -87,7 +87,9 @@ class QasmSimulator(BackendV1):
         self._validate(qobj_instance)
 
         start = time.time()
-        result_list = [self.run_experiment(qobj_exp, **options) for qobj_exp in qobj_instance.experiments]
+        result_list = self._run_parameter_sweep(qobj_instance.experiments, **options)
+        if result_list is None:
+            result_list = [self.run_experiment(qobj_exp, **options) for qobj_exp in qobj_instance.experiments]
         end = time.time()
 
         result = {'backend_name': self.configuration().backend_name,
@@ -102,10 +104,42 @@ class QasmSimulator(BackendV1):
                   }
         return Result.from_dict(result)
 
+    def _run_parameter_sweep(self, qobj_experiments: List[QasmQobjExperiment], **options):
+        """Simulates experiments that only differ in their rotation angles (e.g., the result of parameter_binds) as one
+        parameter sweep, which reuses a warm simulator per worker thread. Returns None if the experiments cannot be swept.
+        """
+        if len(qobj_experiments) < 2 or self.SHOW_STATE_VECTOR or options.get('trace_file', None) is not None:
+            return None
+        start_time = time.time()
+        try:
+            sweep = ddsim.ParameterSweep(qobj_experiments[0], options.get('seed', -1))
+            parameters = [sweep.parameters_of(qobj_exp) for qobj_exp in qobj_experiments]
+        except ValueError:
+            return None
+        shots = options.get('shots', 1024)
+        all_counts = sweep.simulate(parameters, shots)
+        time_taken = (time.time() - start_time) / len(qobj_experiments)
+
+        return [{'header': qobj_exp.header.to_dict(),
+                 'name': qobj_exp.header.name,
+                 'status': 'DONE',
+                 'time_taken': time_taken,
+                 'seed': options.get('seed', -1),
+                 'shots': shots,
+                 'data': {'counts': {hex(int(result, 2)): count for result, count in counts.items()}},
+                 'success': True,
+                 } for qobj_exp, counts in zip(qobj_experiments, all_counts)]
+
     def run_experiment(self, qobj_experiment: QasmQobjExperiment, **options):
         start_time = time.time()
         sim = ddsim.CircuitSimulator(qobj_experiment, options.get('seed', -1))
-        counts = sim.simulate(options.get('shots', 1024))
+        trace_file = options.get('trace_file', None)
+        if trace_file is not None:
+            sim.enable_tracing()
+        with running(options, sim):
+            counts = sim.simulate(options.get('shots', 1024))
+        if trace_file is not None:
+            sim.write_trace(trace_file)
         end_time = time.time()
         counts_hex = {hex(int(result, 2)): count for result, count in counts.items()}
 
@@ -122,6 +156,31 @@ class QasmSimulator(BackendV1):
             result['data']['statevector'] = sim.get_vector()
         return result
 
+    def expectation_values(self, quantum_circuits: Union[QuantumCircuit, List[QuantumCircuit]], observables, **options) -> List[float]:
+        """Exact expectation values <psi|O|psi> of the final states of the circuits, computed without sampling.
+
+        Each observable is either a qiskit.quantum_info.SparsePauliOp or a list of (Pauli label, coefficient) pairs
+        in Qiskit's qubit order. A single observable is used for all circuits. Final measurements are ignored.
+        """
+        if not isinstance(quantum_circuits, list):
+            quantum_circuits = [quantum_circuits]
+        if not isinstance(observables, list) or (observables and isinstance(observables[0], tuple)):
+            observables = [observables] * len(quantum_circuits)
+        if len(observables) != len(quantum_circuits):
+            raise QiskitError('The number of observables does not match the number of circuits.')
+
+        parameter_binds = options.get('parameter_binds', None)
+        values = []
+        for i, (circuit, observable) in enumerate(zip(quantum_circuits, observables)):
+            if parameter_binds is not None:
+                circuit = circuit.bind_parameters(parameter_binds[i])
+            terms = observable.to_list() if hasattr(observable, 'to_list') else observable
+            terms = [(label, float(complex(coefficient).real)) for label, coefficient in terms]
+            sim = ddsim.CircuitSimulator(circuit, options.get('seed', -1))
+            sim.simulate(0)
+            values.append(sim.expectation_value(terms))
+        return values
+
     def _validate(self, quantum_circuit):
         return
 
@@ -111,10 +111,14 @@ class UnitarySimulator(BackendV1):
             construction_mode = ddsim.ConstructionMode.sequential
         elif mode == 'recursive':
             construction_mode = ddsim.ConstructionMode.recursive
+        elif mode == 'parallel_recursive':
+            construction_mode = ddsim.ConstructionMode.parallel_recursive
         else:
-            raise DDSIMError('Construction mode', mode, 'not supported by DDSIM unitary simulator. Available modes are \'recursive\' and \'sequential\'')
+            raise DDSIMError('Construction mode', mode, 'not supported by DDSIM unitary simulator. Available modes are \'recursive\', \'parallel_recursive\' and \'sequential\'')
 
         sim = ddsim.UnitarySimulator(qobj_experiment, seed, construction_mode)
+        if 'threads' in options:
+            sim.set_threads(options['threads'])
         sim.construct()
         # Add extract resulting matrix from final DD and write data
         unitary = np.zeros((2 ** qobj_experiment.header.n_qubits, 2 ** qobj_experiment.header.n_qubits), dtype=complex)
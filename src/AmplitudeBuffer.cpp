@@ -0,0 +1,165 @@
+#include "AmplitudeBuffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+AmplitudeBuffer::AmplitudeBuffer(std::size_t size, std::string file, unsigned int nThreads):
+    length(size), file(std::move(file)), nThreads(std::max(nThreads, 1U)) {
+    if (length == 0) {
+        return;
+    }
+    const auto bytes = length * sizeof(std::complex<dd::fp>);
+#ifdef _WIN32
+    if (isFileBacked()) {
+        throw std::runtime_error("Memory-mapped amplitude files are not supported on this platform.");
+    }
+    mappedBytes = (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    amplitudes  = static_cast<std::complex<dd::fp>*>(::operator new(mappedBytes, std::align_val_t{ALIGNMENT}));
+#else
+    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    mappedBytes         = (bytes + pageSize - 1) / pageSize * pageSize;
+
+    // reserve enough address space to place the buffer at a huge page boundary and give back the rest
+    const auto reserved = mappedBytes + ALIGNMENT;
+    auto*      base     = static_cast<char*>(mmap(nullptr, reserved, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+    if (base == MAP_FAILED) {
+        throw std::runtime_error("Cannot reserve " + std::to_string(reserved) + " bytes of address space for the amplitudes.");
+    }
+    auto*      aligned = reinterpret_cast<char*>((reinterpret_cast<std::uintptr_t>(base) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+    const auto head    = static_cast<std::size_t>(aligned - base);
+    if (head > 0) {
+        munmap(base, head);
+    }
+    if (reserved - head > mappedBytes) {
+        munmap(aligned + mappedBytes, reserved - head - mappedBytes);
+    }
+
+    int fd    = -1;
+    int flags = MAP_FIXED;
+    if (isFileBacked()) {
+        fd = open(this->file.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            if (fd >= 0) {
+                close(fd);
+            }
+            munmap(aligned, mappedBytes);
+            throw std::runtime_error("Cannot create the amplitude file '" + this->file + "' of " + std::to_string(bytes) + " bytes.");
+        }
+        flags |= MAP_SHARED;
+    } else {
+        flags |= MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+    }
+    void* mapped = mmap(aligned, mappedBytes, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (fd >= 0) {
+        // the mapping keeps the file open
+        close(fd);
+    }
+    if (mapped == MAP_FAILED) {
+        munmap(aligned, mappedBytes);
+        throw std::runtime_error("Cannot map " + std::to_string(bytes) + " bytes for the amplitudes.");
+    }
+#ifdef MADV_HUGEPAGE
+    if (!isFileBacked()) {
+        madvise(mapped, mappedBytes, MADV_HUGEPAGE);
+    }
+#endif
+    amplitudes = static_cast<std::complex<dd::fp>*>(mapped);
+#endif
+
+    // first touch, which places every chunk on the NUMA node of the thread that zeroes it
+    forEachChunk([this](std::size_t first, std::size_t last) {
+        std::fill(amplitudes + first, amplitudes + last, std::complex<dd::fp>{});
+    });
+}
+
+AmplitudeBuffer::~AmplitudeBuffer() {
+    release();
+}
+
+AmplitudeBuffer::AmplitudeBuffer(AmplitudeBuffer&& other) noexcept:
+    amplitudes(std::exchange(other.amplitudes, nullptr)),
+    length(std::exchange(other.length, 0U)),
+    mappedBytes(std::exchange(other.mappedBytes, 0U)),
+    file(std::move(other.file)),
+    nThreads(other.nThreads) {
+    other.file.clear();
+}
+
+AmplitudeBuffer& AmplitudeBuffer::operator=(AmplitudeBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        amplitudes  = std::exchange(other.amplitudes, nullptr);
+        length      = std::exchange(other.length, 0U);
+        mappedBytes = std::exchange(other.mappedBytes, 0U);
+        file        = std::move(other.file);
+        nThreads    = other.nThreads;
+        other.file.clear();
+    }
+    return *this;
+}
+
+void AmplitudeBuffer::release() {
+    if (amplitudes == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    ::operator delete(amplitudes, std::align_val_t{ALIGNMENT});
+#else
+    munmap(amplitudes, mappedBytes);
+#endif
+    amplitudes  = nullptr;
+    length      = 0;
+    mappedBytes = 0;
+}
+
+void AmplitudeBuffer::flush() {
+#ifndef _WIN32
+    if (isFileBacked() && amplitudes != nullptr && msync(amplitudes, mappedBytes, MS_SYNC) != 0) {
+        throw std::runtime_error("Cannot write the amplitudes to '" + file + "'.");
+    }
+#endif
+}
+
+void AmplitudeBuffer::forEachChunk(const std::function<void(std::size_t, std::size_t)>& f) const {
+    // chunks never share a huge page, which could only reside on one of their nodes
+    constexpr auto perPage = ALIGNMENT / sizeof(std::complex<dd::fp>);
+    const auto     chunk   = ((length + nThreads - 1) / nThreads + perPage - 1) / perPage * perPage;
+    if (chunk >= length) {
+        if (length > 0) {
+            f(0, length);
+        }
+        return;
+    }
+
+    const auto                      nchunks = (length + chunk - 1) / chunk;
+    std::vector<std::exception_ptr> errors(nchunks);
+    std::vector<std::thread>        threads;
+    for (std::size_t c = 0; c < nchunks; ++c) {
+        threads.emplace_back([&, c]() {
+            try {
+                f(c * chunk, std::min(length, (c + 1) * chunk));
+            } catch (...) {
+                errors[c] = std::current_exception();
+            }
+        });
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+    for (const auto& error: errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
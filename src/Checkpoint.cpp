@@ -0,0 +1,144 @@
+#include "Checkpoint.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    template<class T>
+    void writeValue(std::ostream& os, const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<class T>
+    T readValue(std::istream& is) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value{};
+        if (!is.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            throw std::runtime_error("Checkpoint is truncated.");
+        }
+        return value;
+    }
+
+    void writeString(std::ostream& os, const std::string& s) {
+        writeValue<std::uint64_t>(os, s.size());
+        os.write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+
+    std::string readString(std::istream& is) {
+        std::string s(readValue<std::uint64_t>(is), '\0');
+        if (!is.read(s.data(), static_cast<std::streamsize>(s.size()))) {
+            throw std::runtime_error("Checkpoint is truncated.");
+        }
+        return s;
+    }
+
+    // makes sure the contents of file have reached the disk before it is renamed
+    void syncFile([[maybe_unused]] const std::string& file) {
+#ifndef _WIN32
+        const int fd = ::open(file.c_str(), O_WRONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open checkpoint file '" + file + "' for syncing.");
+        }
+        const bool synced = ::fsync(fd) == 0;
+        ::close(fd);
+        if (!synced) {
+            throw std::runtime_error("Failed to sync checkpoint file '" + file + "'.");
+        }
+#endif
+    }
+} // namespace
+
+void Checkpoint::write(const std::string& file) const {
+    std::ofstream ofs(file, std::ios::binary | std::ios::trunc);
+    if (!ofs.good()) {
+        throw std::runtime_error("Cannot open checkpoint file '" + file + "' for writing.");
+    }
+    ofs.write(magic(), static_cast<std::streamsize>(std::strlen(magic())));
+    writeValue(ofs, VERSION);
+    writeValue(ofs, nQubits);
+    writeValue(ofs, nOps);
+    writeValue(ofs, circuitHash);
+    writeValue(ofs, opIndex);
+    writeValue<std::uint64_t>(ofs, classicValues.size());
+    for (const auto& [bit, value]: classicValues) {
+        writeValue<std::uint64_t>(ofs, bit);
+        writeValue<std::uint8_t>(ofs, value ? 1U : 0U);
+    }
+    writeValue(ofs, approximationRuns);
+    writeValue(ofs, fidelity);
+    writeValue<std::uint64_t>(ofs, extra.size());
+    for (const auto value: extra) {
+        writeValue(ofs, value);
+    }
+    writeString(ofs, rngState);
+    writeString(ofs, state);
+    if (!ofs.good()) {
+        throw std::runtime_error("Failed to write checkpoint file '" + file + "'.");
+    }
+}
+
+Checkpoint Checkpoint::read(const std::string& file) {
+    std::ifstream ifs(file, std::ios::binary);
+    if (!ifs.good()) {
+        throw std::runtime_error("Cannot open checkpoint file '" + file + "'.");
+    }
+    std::string header(std::strlen(magic()), '\0');
+    ifs.read(header.data(), static_cast<std::streamsize>(header.size()));
+    if (!ifs || header != magic()) {
+        throw std::runtime_error("'" + file + "' is not a checkpoint.");
+    }
+    if (readValue<std::uint32_t>(ifs) != VERSION) {
+        throw std::runtime_error("Checkpoint '" + file + "' was written by an incompatible version.");
+    }
+
+    Checkpoint checkpoint{};
+    checkpoint.nQubits        = readValue<std::uint32_t>(ifs);
+    checkpoint.nOps           = readValue<std::uint64_t>(ifs);
+    checkpoint.circuitHash    = readValue<std::uint64_t>(ifs);
+    checkpoint.opIndex        = readValue<std::uint64_t>(ifs);
+    const auto nClassicValues = readValue<std::uint64_t>(ifs);
+    for (std::uint64_t i = 0; i < nClassicValues; ++i) {
+        const auto bit                = readValue<std::uint64_t>(ifs);
+        checkpoint.classicValues[bit] = readValue<std::uint8_t>(ifs) != 0U;
+    }
+    checkpoint.approximationRuns = readValue<std::uint64_t>(ifs);
+    checkpoint.fidelity          = readValue<double>(ifs);
+    checkpoint.extra.resize(readValue<std::uint64_t>(ifs));
+    for (auto& value: checkpoint.extra) {
+        value = readValue<std::uint64_t>(ifs);
+    }
+    checkpoint.rngState = readString(ifs);
+    checkpoint.state    = readString(ifs);
+    return checkpoint;
+}
+
+bool Checkpoint::exists(const std::string& file) {
+    return std::filesystem::exists(file);
+}
+
+void CheckpointWriter::write(Checkpoint checkpoint, const std::string& file) {
+    wait();
+    ++written;
+    pending = std::async(std::launch::async, [checkpoint = std::move(checkpoint), file]() {
+        const auto tmp = file + ".tmp";
+        checkpoint.write(tmp);
+        syncFile(tmp);
+        std::filesystem::rename(tmp, file);
+    });
+}
+
+void CheckpointWriter::wait() {
+    if (pending.valid()) {
+        pending.get();
+    }
+}
@@ -2,8 +2,24 @@
 
 #include "dd/Export.hpp"
 
+#include <algorithm>
+#include <complex>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <utility>
+
 template<class DDPackage>
 std::map<std::string, std::size_t> CircuitSimulator<DDPackage>::Simulate(const unsigned int shots) {
+    // the memory limit only refers to the current simulation
+    Simulator<DDPackage>::memory_limit_exceeded = false;
+
+    // the state of a running session is replaced below
+    if (session_started) {
+        Simulator<DDPackage>::dd->decRef(Simulator<DDPackage>::rootEdge);
+        session_started = false;
+    }
+
     bool has_nonmeasurement_nonunitary = false;
     bool has_measurements              = false;
     bool measurements_last             = true;
@@ -39,13 +55,15 @@ std::map<std::string, std::size_t> CircuitSimulator<DDPackage>::Simulate(const u
 
     // easiest case: all gates are unitary --> simulate once and sample away on all qubits
     if (!has_nonmeasurement_nonunitary && !has_measurements) {
-        single_shot(false);
+        Simulator<DDPackage>::beginProgress(qc->getNops());
+        single_shot(false, true);
         return Simulator<DDPackage>::MeasureAllNonCollapsing(shots);
     }
 
     // single shot is enough, but the sampling should only return actually measured qubits
     if (!has_nonmeasurement_nonunitary && measurements_last) {
-        single_shot(true);
+        Simulator<DDPackage>::beginProgress(qc->getNops());
+        single_shot(true, true);
         std::map<std::string, std::size_t> m_counter;
         const auto                         n_qubits = qc->getNqubits();
         const auto                         n_cbits  = qc->getNcbits();
@@ -66,8 +84,26 @@ std::map<std::string, std::size_t> CircuitSimulator<DDPackage>::Simulate(const u
     }
 
     // there are nonunitaries (or intermediate measurement_map) and we have to actually do multiple single_shots :(
+    if (Simulator<DDPackage>::resume_checkpoint.has_value()) {
+        throw std::invalid_argument("Checkpoints can only be resumed for circuits that are simulated in a single pass.");
+    }
     std::map<std::string, std::size_t> m_counter;
 
+    // branching splits the state at each measurement, which cannot be combined with the per-shot approximation schedule
+    const bool approximating = approx_info.step_number > 0 && approx_info.step_fidelity < 1.0;
+    if (shot_branching && !approximating) {
+        // the number of branches is only known at the end
+        Simulator<DDPackage>::beginProgress(0U);
+        Simulator<DDPackage>::rootEdge = Simulator<DDPackage>::dd->makeZeroState(qc->getNqubits());
+        Simulator<DDPackage>::dd->incRef(Simulator<DDPackage>::rootEdge);
+        branch_state = qc::VectorDD::zero;
+        branch_shots(0, 0, {}, shots, m_counter);
+        // the state of the last branch is kept alive like after any other simulation
+        Simulator<DDPackage>::rootEdge = branch_state;
+        return m_counter;
+    }
+
+    Simulator<DDPackage>::beginProgress(qc->getNops() * shots);
     for (unsigned int i = 0; i < shots; i++) {
         const auto result  = single_shot(false);
         const auto n_cbits = qc->getNcbits();
@@ -85,27 +121,141 @@ std::map<std::string, std::size_t> CircuitSimulator<DDPackage>::Simulate(const u
 }
 
 template<class DDPackage>
-std::map<std::size_t, bool> CircuitSimulator<DDPackage>::single_shot(const bool ignore_nonunitaries) {
+std::map<std::size_t, bool> CircuitSimulator<DDPackage>::single_shot(const bool ignore_nonunitaries, const bool checkpointing) {
     single_shots++;
     const dd::QubitCount n_qubits = qc->getNqubits();
 
-    Simulator<DDPackage>::rootEdge = Simulator<DDPackage>::dd->makeZeroState(n_qubits);
-    Simulator<DDPackage>::dd->incRef(Simulator<DDPackage>::rootEdge);
-
-    std::size_t                 op_num = 0;
+    std::size_t                 op_num   = 0;
+    std::size_t                 first_op = 0;
     std::map<std::size_t, bool> classic_values;
 
+    if (const auto checkpoint = checkpointing ? Simulator<DDPackage>::restoreCheckpoint() : std::nullopt) {
+        first_op           = checkpoint->opIndex;
+        classic_values     = checkpoint->classicValues;
+        approximation_runs = checkpoint->approximationRuns;
+        final_fidelity     = checkpoint->fidelity;
+        op_num             = checkpoint->extra.empty() ? first_op : checkpoint->extra.front();
+    } else {
+        Simulator<DDPackage>::rootEdge = Simulator<DDPackage>::dd->makeZeroState(n_qubits);
+        Simulator<DDPackage>::dd->incRef(Simulator<DDPackage>::rootEdge);
+    }
+
     const int approx_mod = std::ceil(static_cast<double>(qc->getNops()) / (approx_info.step_number + 1));
 
-    for (auto& op: *qc) {
+    // Consecutive gates are multiplied into a single matrix DD as long as they act on at most fusion_max_width qubits.
+    // Fusion is skipped while approximating, since the approximation schedule refers to individual operations.
+    const bool          approximating = approx_info.step_number > 0 && approx_info.step_fidelity < 1.0;
+    const bool          fuse          = fusion_max_width > 1 && !approximating;
+    qc::MatrixDD        fused{};
+    std::set<dd::Qubit> fused_qubits{};
+    std::size_t         fused_count = 0;
+
+    // once the memory limit cannot be kept anymore, this shot stops with the state reached so far
+    bool       memory_exceeded     = false;
+    const auto within_memory_limit = [this, &memory_exceeded]() {
+        if (Simulator<DDPackage>::memory_limit == 0 || memory_exceeded) {
+            return !memory_exceeded;
+        }
+        double fidelity = 1.;
+        memory_exceeded = !Simulator<DDPackage>::EnforceMemoryLimit(Simulator<DDPackage>::dd, Simulator<DDPackage>::rootEdge, Simulator<DDPackage>::memory_limit, fidelity);
+        memory_limit_fidelity *= fidelity;
+        final_fidelity *= fidelity;
+        if (memory_exceeded) {
+            Simulator<DDPackage>::memory_limit_exceeded = true;
+            memory_limit_aborts++;
+        }
+        return !memory_exceeded;
+    };
+
+    const auto flush_fused = [this, &fused, &fused_qubits, &fused_count, &within_memory_limit, &op_num]() {
+        if (fused_count == 0) {
+            return;
+        }
+        const auto span = Simulator<DDPackage>::traceBegin(Simulator<DDPackage>::dd, Simulator<DDPackage>::rootEdge);
+        auto       tmp  = Simulator<DDPackage>::dd->multiply(fused, Simulator<DDPackage>::rootEdge);
+        Simulator<DDPackage>::dd->incRef(tmp);
+        Simulator<DDPackage>::dd->decRef(Simulator<DDPackage>::rootEdge);
+        Simulator<DDPackage>::dd->decRef(fused);
+        Simulator<DDPackage>::rootEdge = tmp;
+        Simulator<DDPackage>::collectGarbage();
+        within_memory_limit();
+        Simulator<DDPackage>::traceEnd(span, Simulator<DDPackage>::dd, Simulator<DDPackage>::rootEdge, op_num - fused_count, "fused_block");
+
+        if (fused_count > 1) {
+            fused_blocks++;
+            fused_ops += fused_count;
+        }
+        fused_count = 0;
+        fused_qubits.clear();
+    };
+
+    // returns false if the operation cannot be fused and has to be applied on its own
+    const auto fuse_operation = [this, &fused, &fused_qubits, &fused_count, &flush_fused](qc::Operation* op) {
+        std::set<dd::Qubit> op_qubits(op->getTargets().begin(), op->getTargets().end());
+        for (const auto& control: op->getControls()) {
+            op_qubits.insert(control.qubit);
+        }
+        if (op_qubits.size() > fusion_max_width) {
+            flush_fused();
+            return false;
+        }
+
+        auto qubits = fused_qubits;
+        qubits.insert(op_qubits.begin(), op_qubits.end());
+        if (qubits.size() > fusion_max_width) {
+            flush_fused();
+            qubits = op_qubits;
+        }
+
+        auto dd_op = op_cache.get(op, Simulator<DDPackage>::dd);
+        if (fused_count > 0) {
+            auto candidate = Simulator<DDPackage>::dd->multiply(dd_op, fused);
+            // cost heuristic: the fused matrix must not be larger than applying both parts one after another
+            if (Simulator<DDPackage>::dd->size(candidate) > Simulator<DDPackage>::dd->size(fused) + Simulator<DDPackage>::dd->size(dd_op)) {
+                Simulator<DDPackage>::dd->incRef(dd_op); // protect the gate from the garbage collection while flushing
+                flush_fused();
+                qubits = op_qubits;
+            } else {
+                Simulator<DDPackage>::dd->incRef(candidate);
+                Simulator<DDPackage>::dd->decRef(fused);
+                dd_op = candidate;
+            }
+        } else {
+            Simulator<DDPackage>::dd->incRef(dd_op);
+        }
+        fused        = dd_op;
+        fused_qubits = qubits;
+        fused_count++;
+        return true;
+    };
+
+    for (std::size_t op_idx = first_op; op_idx < qc->getNops(); ++op_idx) {
+        const auto& op = qc->at(op_idx);
+        if (memory_exceeded) {
+            break;
+        }
+        // checkpoints are taken in between operations, so fused and skipped operations count as well; a pending fused
+        // block is applied first, so rootEdge reflects all operations before op_idx
+        if (checkpointing && op_idx > first_op && Simulator<DDPackage>::checkpointDue()) {
+            flush_fused();
+            if (memory_exceeded) {
+                break;
+            }
+            Simulator<DDPackage>::writeCheckpoint(op_idx, classic_values, approximation_runs, static_cast<double>(final_fidelity), {op_num});
+        }
+        // an operation counts as done as soon as it is started, which keeps the count right despite the many exits below
+        Simulator<DDPackage>::checkCancellation();
+        Simulator<DDPackage>::advanceProgress(Simulator<DDPackage>::dd);
         if (op->isNonUnitaryOperation()) {
             if (ignore_nonunitaries) {
                 continue;
             }
+            flush_fused();
             if (auto* nu_op = dynamic_cast<qc::NonUnitaryOperation*>(op.get())) {
                 if (op->getType() == qc::Measure) {
-                    auto quantum = nu_op->getTargets();
-                    auto classic = nu_op->getClassics();
+                    const auto span    = Simulator<DDPackage>::traceBegin(Simulator<DDPackage>::dd, Simulator<DDPackage>::rootEdge);
+                    auto       quantum = nu_op->getTargets();
+                    auto       classic = nu_op->getClassics();
 
                     assert(quantum.size() == classic.size()); // this should not happen do to check in Simulate
 
@@ -114,6 +264,7 @@ std::map<std::size_t, bool> CircuitSimulator<DDPackage>::single_shot(const bool
                         assert(result == '0' || result == '1');
                         classic_values[classic.at(i)] = (result == '1');
                     }
+                    Simulator<DDPackage>::traceEnd(span, Simulator<DDPackage>::dd, Simulator<DDPackage>::rootEdge, op_idx, *op);
                 } else if (op->getType() == qc::Barrier) {
                     continue;
                 } else {
@@ -122,8 +273,14 @@ std::map<std::size_t, bool> CircuitSimulator<DDPackage>::single_shot(const bool
             } else {
                 throw std::runtime_error("Dynamic cast to NonUnitaryOperation failed.");
             }
-            Simulator<DDPackage>::dd->garbageCollect();
+            Simulator<DDPackage>::collectGarbage();
         } else {
+            if (fuse && !op->isClassicControlledOperation() && fuse_operation(op.get())) {
+                op_num++;
+                continue;
+            }
+            flush_fused();
+
             if (op->isClassicControlledOperation()) {
                 if (auto* cc_op = dynamic_cast<qc::ClassicControlledOperation*>(op.get())) {
                     const auto         start_index    = static_cast<unsigned short>(cc_op->getParameter().at(0));
@@ -147,13 +304,14 @@ std::map<std::size_t, bool> CircuitSimulator<DDPackage>::single_shot(const bool
                       << " #controls=" << op->getControls().size()
                       << " statesize=" << dd->size(rootEdge) << "\n";//*/
 
-            auto dd_op = dd::getDD(op.get(), Simulator<DDPackage>::dd);
-            auto tmp   = Simulator<DDPackage>::dd->multiply(dd_op, Simulator<DDPackage>::rootEdge);
+            const auto span  = Simulator<DDPackage>::traceBegin(Simulator<DDPackage>::dd, Simulator<DDPackage>::rootEdge);
+            auto       dd_op = op_cache.get(op.get(), Simulator<DDPackage>::dd);
+            auto       tmp   = Simulator<DDPackage>::dd->multiply(dd_op, Simulator<DDPackage>::rootEdge);
             Simulator<DDPackage>::dd->incRef(tmp);
             Simulator<DDPackage>::dd->decRef(Simulator<DDPackage>::rootEdge);
             Simulator<DDPackage>::rootEdge = tmp;
 
-            if (approx_info.step_number > 0 && approx_info.step_fidelity < 1.0) {
+            if (approximating) {
                 if (approx_info.approx_when == ApproximationInfo::FidelityDriven && (op_num + 1) % approx_mod == 0 &&
                     approximation_runs < approx_info.step_number) {
                     //const unsigned int size_before = dd->size(rootEdge);
@@ -182,11 +340,502 @@ std::map<std::size_t, bool> CircuitSimulator<DDPackage>::single_shot(const bool
                     }
                 }
             }
-            Simulator<DDPackage>::dd->garbageCollect();
+            Simulator<DDPackage>::collectGarbage();
+            within_memory_limit();
+            Simulator<DDPackage>::traceEnd(span, Simulator<DDPackage>::dd, Simulator<DDPackage>::rootEdge, op_idx, *op);
         }
         op_num++;
     }
+    flush_fused();
+    if (checkpointing) {
+        Simulator<DDPackage>::checkpoint_writer.wait();
+    }
     return classic_values;
 }
 
+template<class DDPackage>
+void CircuitSimulator<DDPackage>::branch_shots(std::size_t op_idx, std::size_t measurement_idx, std::map<std::size_t, bool> classic_values, const std::size_t shots, std::map<std::string, std::size_t>& m_counter) {
+    // the caller hands over one reference on rootEdge which is released as soon as this branch is finished (or, at the end
+    // of the circuit, kept in branch_state)
+    for (; op_idx < qc->getNops(); ++op_idx) {
+        const auto& op = qc->at(op_idx);
+        if (op->isNonUnitaryOperation()) {
+            if (auto* nu_op = dynamic_cast<qc::NonUnitaryOperation*>(op.get())) {
+                if (op->getType() == qc::Measure) {
+                    const auto& quantum = nu_op->getTargets();
+                    const auto& classic = nu_op->getClassics();
+
+                    assert(quantum.size() == classic.size()); // this should not happen do to check in Simulate
+
+                    if (measurement_idx == quantum.size()) {
+                        // all qubits of this measurement have been split already
+                        measurement_idx = 0;
+                        continue;
+                    }
+
+                    const auto        qubit  = quantum.at(measurement_idx);
+                    const auto        state  = Simulator<DDPackage>::rootEdge;
+                    const auto [p0, p1]      = Simulator<DDPackage>::dd->determineMeasurementProbabilities(state, qubit, true);
+                    const dd::fp      norm   = p0 + p1;
+                    const std::size_t shots0 = std::binomial_distribution<std::size_t>(shots, p0 / norm)(Simulator<DDPackage>::mt);
+
+                    const std::array<std::size_t, 2> outcome_shots{shots0, shots - shots0};
+                    const std::array<dd::fp, 2>      outcome_probs{p0, p1};
+
+                    for (std::size_t outcome = 0; outcome < 2; ++outcome) {
+                        if (outcome_shots.at(outcome) == 0) {
+                            continue;
+                        }
+                        // project onto the outcome and renormalize in one go
+                        const dd::ComplexValue scale{1.0 / std::sqrt(outcome_probs.at(outcome)), 0.0};
+                        dd::GateMatrix         projector{dd::complex_zero, dd::complex_zero, dd::complex_zero, dd::complex_zero};
+                        projector.at(outcome == 0 ? 0 : 3) = scale;
+
+                        auto projected = Simulator<DDPackage>::dd->multiply(Simulator<DDPackage>::dd->makeGateDD(projector, qc->getNqubits(), qubit), state);
+                        Simulator<DDPackage>::dd->incRef(projected);
+                        Simulator<DDPackage>::rootEdge = projected;
+
+                        classic_values[classic.at(measurement_idx)] = (outcome == 1);
+                        branch_shots(op_idx, measurement_idx + 1, classic_values, outcome_shots.at(outcome), m_counter);
+                    }
+                    Simulator<DDPackage>::dd->decRef(state);
+                    Simulator<DDPackage>::collectGarbage();
+                    return;
+                } else if (op->getType() == qc::Barrier) {
+                    continue;
+                } else {
+                    throw std::runtime_error("Unsupported non-unitary functionality.");
+                }
+            } else {
+                throw std::runtime_error("Dynamic cast to NonUnitaryOperation failed.");
+            }
+        }
+
+        if (op->isClassicControlledOperation()) {
+            if (auto* cc_op = dynamic_cast<qc::ClassicControlledOperation*>(op.get())) {
+                const auto         start_index    = static_cast<unsigned short>(cc_op->getParameter().at(0));
+                const auto         length         = static_cast<unsigned short>(cc_op->getParameter().at(1));
+                const unsigned int expected_value = cc_op->getExpectedValue();
+                unsigned int       actual_value   = 0;
+                for (unsigned int i = 0; i < length; i++) {
+                    actual_value |= (classic_values[start_index + i] ? 1u : 0u) << i;
+                }
+                if (actual_value != expected_value) {
+                    continue;
+                }
+            } else {
+                throw std::runtime_error("Dynamic cast to ClassicControlledOperation failed.");
+            }
+        }
+
+        Simulator<DDPackage>::checkCancellation();
+        Simulator<DDPackage>::advanceProgress(Simulator<DDPackage>::dd);
+        auto dd_op = op_cache.get(op.get(), Simulator<DDPackage>::dd);
+        auto tmp   = Simulator<DDPackage>::dd->multiply(dd_op, Simulator<DDPackage>::rootEdge);
+        Simulator<DDPackage>::dd->incRef(tmp);
+        Simulator<DDPackage>::dd->decRef(Simulator<DDPackage>::rootEdge);
+        Simulator<DDPackage>::rootEdge = tmp;
+        Simulator<DDPackage>::collectGarbage();
+    }
+
+    // reached the end of the circuit: all shots of this branch share the same classical outcome
+    branches++;
+    const auto  n_cbits = qc->getNcbits();
+    std::string result_string(n_cbits, '0');
+    for (const auto& [cbit, value]: classic_values) {
+        result_string[n_cbits - cbit - 1] = value ? '1' : '0';
+    }
+    m_counter[result_string] += shots;
+    // the reference handed over by the caller is kept for this state, before the unwinding branches collect any garbage,
+    // while the state kept by the previous branch is released
+    Simulator<DDPackage>::dd->decRef(branch_state);
+    branch_state = Simulator<DDPackage>::rootEdge;
+}
+
+template<class DDPackage>
+AmplitudeMap CircuitSimulator<DDPackage>::SimulateAmplitudes(const std::vector<std::size_t>& indices, std::size_t projectedLayers) {
+    const auto nqubits = qc->getNqubits();
+    Simulator<DDPackage>::checkAmplitudeIndices(indices, nqubits);
+
+    std::vector<const qc::Operation*> ops;
+    for (const auto& op: *qc) {
+        const auto type = op->getType();
+        if (type == qc::Measure || type == qc::Barrier || type == qc::Snapshot || type == qc::ShowProbabilities) {
+            continue;
+        }
+        if (!op->isUnitary()) {
+            throw std::invalid_argument("Amplitude queries are not supported for circuits with " + op->getName() + " operations.");
+        }
+        ops.emplace_back(op.get());
+    }
+
+    // the layer of an operation counted from the end of the circuit; every operation in the last projectedLayers layers
+    // commutes with all remaining operations after it, so the circuit splits into a prefix and a projected suffix
+    std::vector<std::size_t> depth(nqubits, 0);
+    std::vector<bool>        projected(ops.size(), false);
+    for (auto i = ops.size(); i-- > 0;) {
+        std::size_t layer = 0;
+        for (const auto& target: ops[i]->getTargets()) {
+            layer = std::max(layer, depth.at(static_cast<std::size_t>(target)));
+        }
+        for (const auto& control: ops[i]->getControls()) {
+            layer = std::max(layer, depth.at(static_cast<std::size_t>(control.qubit)));
+        }
+        projected[i] = layer < projectedLayers;
+        for (const auto& target: ops[i]->getTargets()) {
+            depth.at(static_cast<std::size_t>(target)) = layer + 1;
+        }
+        for (const auto& control: ops[i]->getControls()) {
+            depth.at(static_cast<std::size_t>(control.qubit)) = layer + 1;
+        }
+    }
+
+    auto& dd = Simulator<DDPackage>::dd;
+    if (Simulator<DDPackage>::rootEdge.p != nullptr) {
+        dd->decRef(Simulator<DDPackage>::rootEdge);
+    }
+    session_started                = false;
+    Simulator<DDPackage>::rootEdge = dd->makeZeroState(nqubits);
+    dd->incRef(Simulator<DDPackage>::rootEdge);
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        if (projected[i]) {
+            continue;
+        }
+        auto tmp = dd->multiply(op_cache.get(ops[i], dd), Simulator<DDPackage>::rootEdge);
+        dd->incRef(tmp);
+        dd->decRef(Simulator<DDPackage>::rootEdge);
+        Simulator<DDPackage>::rootEdge = tmp;
+        Simulator<DDPackage>::collectGarbage();
+    }
+
+    // <x|U|psi> = <U^dagger x|psi> for the projected suffix U
+    AmplitudeMap amplitudes;
+    for (const auto index: indices) {
+        if (amplitudes.count(index) != 0U) {
+            continue;
+        }
+        std::vector<bool> bits(nqubits);
+        for (std::size_t q = 0; q < nqubits; ++q) {
+            bits[q] = ((index >> q) & 1U) != 0U;
+        }
+        auto bra = dd->makeBasisState(nqubits, bits);
+        dd->incRef(bra);
+        for (auto i = ops.size(); i-- > 0;) {
+            if (!projected[i]) {
+                continue;
+            }
+            auto tmp = dd->multiply(op_cache.get(ops[i], dd, true), bra);
+            dd->incRef(tmp);
+            dd->decRef(bra);
+            bra = tmp;
+        }
+        const auto value = dd->innerProduct(bra, Simulator<DDPackage>::rootEdge);
+        amplitudes.emplace(index, std::complex<dd::fp>{value.r, value.i});
+        dd->decRef(bra);
+        Simulator<DDPackage>::collectGarbage();
+    }
+    return amplitudes;
+}
+
+template<class DDPackage>
+void CircuitSimulator<DDPackage>::startSession() {
+    auto& dd = Simulator<DDPackage>::dd;
+    if (session_started && Simulator<DDPackage>::rootEdge.p != nullptr) {
+        dd->decRef(Simulator<DDPackage>::rootEdge);
+    }
+    Simulator<DDPackage>::rootEdge = dd->makeZeroState(qc->getNqubits());
+    dd->incRef(Simulator<DDPackage>::rootEdge);
+    session_started = true;
+    session_ops     = 0;
+    session_classic_values.clear();
+}
+
+template<class DDPackage>
+void CircuitSimulator<DDPackage>::apply_operation(const qc::Operation& op, std::size_t index, std::map<std::size_t, bool>& classic_values) {
+    auto& dd = Simulator<DDPackage>::dd;
+    if (op.isNonUnitaryOperation() && (op.getType() == qc::Barrier || op.getType() == qc::Snapshot || op.getType() == qc::ShowProbabilities)) {
+        return;
+    }
+    Simulator<DDPackage>::checkCancellation();
+    Simulator<DDPackage>::advanceProgress(dd);
+    const auto span = Simulator<DDPackage>::traceBegin(dd, Simulator<DDPackage>::rootEdge);
+    if (op.isNonUnitaryOperation()) {
+        const auto* nu_op = dynamic_cast<const qc::NonUnitaryOperation*>(&op);
+        if (nu_op == nullptr || op.getType() != qc::Measure) {
+            throw std::runtime_error("Unsupported non-unitary functionality.");
+        }
+        const auto& quantum = nu_op->getTargets();
+        const auto& classic = nu_op->getClassics();
+        for (std::size_t i = 0; i < quantum.size(); ++i) {
+            classic_values[classic.at(i)] = Simulator<DDPackage>::MeasureOneCollapsing(quantum.at(i)) == '1';
+        }
+    } else {
+        if (op.isClassicControlledOperation()) {
+            const auto* cc_op = dynamic_cast<const qc::ClassicControlledOperation*>(&op);
+            if (cc_op == nullptr) {
+                throw std::runtime_error("Dynamic cast to ClassicControlledOperation failed.");
+            }
+            const auto   start_index  = static_cast<unsigned short>(cc_op->getParameter().at(0));
+            const auto   length       = static_cast<unsigned short>(cc_op->getParameter().at(1));
+            unsigned int actual_value = 0;
+            for (unsigned int i = 0; i < length; i++) {
+                actual_value |= (classic_values[start_index + i] ? 1u : 0u) << i;
+            }
+            if (actual_value != cc_op->getExpectedValue()) {
+                return;
+            }
+        }
+        auto tmp = dd->multiply(op_cache.get(&op, dd), Simulator<DDPackage>::rootEdge);
+        dd->incRef(tmp);
+        dd->decRef(Simulator<DDPackage>::rootEdge);
+        Simulator<DDPackage>::rootEdge = tmp;
+    }
+    Simulator<DDPackage>::collectGarbage();
+    Simulator<DDPackage>::traceEnd(span, dd, Simulator<DDPackage>::rootEdge, index, op);
+}
+
+template<class DDPackage>
+std::size_t CircuitSimulator<DDPackage>::advance() {
+    if (!session_started) {
+        startSession();
+    }
+    const auto first = session_ops;
+    for (; session_ops < qc->getNops(); ++session_ops) {
+        apply_operation(*qc->at(session_ops), session_ops, session_classic_values);
+    }
+    return session_ops - first;
+}
+
+template<class DDPackage>
+std::map<std::string, std::size_t> CircuitSimulator<DDPackage>::SimulateStream(const OperationSource& source, const unsigned int shots, std::size_t queueCapacity) {
+    auto& dd = Simulator<DDPackage>::dd;
+    if (session_started) {
+        dd->decRef(Simulator<DDPackage>::rootEdge);
+        session_started = false;
+    }
+    Simulator<DDPackage>::rootEdge = dd->makeZeroState(qc->getNqubits());
+    dd->incRef(Simulator<DDPackage>::rootEdge);
+    streamed_ops = 0;
+    // the length of the stream is unknown
+    Simulator<DDPackage>::beginProgress(0U);
+
+    OperationQueue queue(queueCapacity);
+    std::thread    producer([&queue, &source]() {
+        try {
+            for (auto op = source(); op != nullptr; op = source()) {
+                if (!queue.push(std::move(op))) {
+                    return;
+                }
+            }
+            queue.close();
+        } catch (...) {
+            queue.fail(std::current_exception());
+        }
+    });
+
+    // measurements wait here (with their position in the stream) until it is known whether they are final
+    std::vector<std::pair<std::size_t, std::unique_ptr<qc::Operation>>> pending_measurements;
+    std::map<std::size_t, bool>                                         classic_values;
+    try {
+        for (auto op = queue.pop(); op != nullptr; op = queue.pop()) {
+            const auto index = streamed_ops++;
+            if (op->getType() == qc::Measure) {
+                const auto* nu_op = dynamic_cast<const qc::NonUnitaryOperation*>(op.get());
+                if (nu_op == nullptr || nu_op->getTargets().size() != nu_op->getClassics().size()) {
+                    throw std::runtime_error("Measurement: Sizes of quantum and classic register mismatch.");
+                }
+                pending_measurements.emplace_back(index, std::move(op));
+                continue;
+            }
+            if (op->getType() == qc::Barrier) {
+                continue;
+            }
+            if (!pending_measurements.empty()) {
+                if (shots > 1) {
+                    throw std::invalid_argument("Streamed circuits with intermediate measurements can only be simulated for a single shot.");
+                }
+                for (const auto& [measurement_index, measurement]: pending_measurements) {
+                    apply_operation(*measurement, measurement_index, classic_values);
+                }
+                pending_measurements.clear();
+            }
+            apply_operation(*op, index, classic_values);
+        }
+    } catch (...) {
+        queue.cancel();
+        producer.join();
+        throw;
+    }
+    producer.join();
+
+    if (pending_measurements.empty() && classic_values.empty()) {
+        return Simulator<DDPackage>::MeasureAllNonCollapsing(shots);
+    }
+
+    // the final measurements are sampled, bits measured before keep the value of the single pass
+    std::map<dd::Qubit, std::size_t> measurement_map;
+    for (const auto& [measurement_index, measurement]: pending_measurements) {
+        const auto* nu_op = dynamic_cast<const qc::NonUnitaryOperation*>(measurement.get());
+        for (std::size_t i = 0; i < nu_op->getTargets().size(); ++i) {
+            measurement_map[nu_op->getTargets().at(i)] = nu_op->getClassics().at(i);
+        }
+    }
+    const auto                         n_qubits = qc->getNqubits();
+    const auto                         n_cbits  = qc->getNcbits();
+    std::map<std::string, std::size_t> m_counter;
+    for (const auto& item: Simulator<DDPackage>::MeasureAllNonCollapsing(shots)) {
+        std::string result_string(n_cbits, '0');
+        for (const auto& [bit, value]: classic_values) {
+            result_string[n_cbits - bit - 1] = value ? '1' : '0';
+        }
+        for (const auto& [qubit, bit]: measurement_map) {
+            result_string[n_cbits - bit - 1] = item.first[n_qubits - qubit - 1];
+        }
+        m_counter[result_string] += item.second;
+    }
+    return m_counter;
+}
+
+template<class DDPackage>
+std::size_t CircuitSimulator<DDPackage>::snapshot() {
+    if (!session_started) {
+        startSession();
+    }
+    Simulator<DDPackage>::dd->incRef(Simulator<DDPackage>::rootEdge);
+    snapshots.emplace(next_snapshot, SessionSnapshot{Simulator<DDPackage>::rootEdge, session_ops, session_classic_values});
+    return next_snapshot++;
+}
+
+template<class DDPackage>
+void CircuitSimulator<DDPackage>::restore(std::size_t snapshotId) {
+    const auto it = snapshots.find(snapshotId);
+    if (it == snapshots.end()) {
+        throw std::invalid_argument("Unknown snapshot " + std::to_string(snapshotId) + ".");
+    }
+    const auto& snap = it->second;
+    if (snap.ops > qc->getNops()) {
+        throw std::invalid_argument("The circuit was shortened below the operations of snapshot " + std::to_string(snapshotId) + ".");
+    }
+
+    auto& dd = Simulator<DDPackage>::dd;
+    // the session and the snapshot hold separate references on the shared state
+    dd->incRef(snap.edge);
+    if (session_started && Simulator<DDPackage>::rootEdge.p != nullptr) {
+        dd->decRef(Simulator<DDPackage>::rootEdge);
+    }
+    Simulator<DDPackage>::rootEdge = snap.edge;
+    session_started                = true;
+    session_ops                    = snap.ops;
+    session_classic_values         = snap.classicValues;
+    qc->erase(qc->begin() + static_cast<std::ptrdiff_t>(snap.ops), qc->end());
+}
+
+template<class DDPackage>
+void CircuitSimulator<DDPackage>::releaseSnapshot(std::size_t snapshotId) {
+    const auto it = snapshots.find(snapshotId);
+    if (it == snapshots.end()) {
+        throw std::invalid_argument("Unknown snapshot " + std::to_string(snapshotId) + ".");
+    }
+    Simulator<DDPackage>::dd->decRef(it->second.edge);
+    snapshots.erase(it);
+    Simulator<DDPackage>::collectGarbage();
+}
+
+namespace {
+    // positions in the parameter array of an operation in Qiskit's argument order
+    std::vector<std::size_t> parameterSlots(qc::OpType type) {
+        switch (type) {
+            case qc::RX:
+            case qc::RY:
+            case qc::RZ:
+            case qc::Phase:
+                return {0};
+            case qc::U2:
+                return {1, 0};
+            case qc::U3:
+                return {2, 1, 0};
+            default:
+                return {};
+        }
+    }
+} // namespace
+
+template<class DDPackage>
+std::uint64_t CircuitSimulator<DDPackage>::circuitHash() const {
+    // FNV-1a over the bytes of all values describing the operations
+    std::uint64_t hash = 14695981039346656037ULL;
+    const auto    mix  = [&hash](std::uint64_t value) {
+        for (std::size_t byte = 0; byte < sizeof(value); ++byte) {
+            hash ^= (value >> (8U * byte)) & 0xFFU;
+            hash *= 1099511628211ULL;
+        }
+    };
+    for (const auto& op: *qc) {
+        mix(static_cast<std::uint64_t>(op->getType()));
+        mix(op->getTargets().size());
+        for (const auto target: op->getTargets()) {
+            mix(static_cast<std::uint64_t>(target));
+        }
+        mix(op->getControls().size());
+        for (const auto& control: op->getControls()) {
+            mix(static_cast<std::uint64_t>(control.qubit));
+            mix(static_cast<std::uint64_t>(control.type));
+        }
+        const auto& parameter = op->getParameter();
+        for (std::size_t i = 0; i < 3; ++i) {
+            std::uint64_t bits = 0;
+            std::memcpy(&bits, &parameter[i], sizeof(bits));
+            mix(bits);
+        }
+    }
+    return hash;
+}
+
+template<class DDPackage>
+std::vector<dd::fp> CircuitSimulator<DDPackage>::parametersOf(const qc::QuantumComputation& circuit) {
+    std::vector<dd::fp> values;
+    for (const auto& op: circuit) {
+        if (!op->isStandardOperation()) {
+            continue;
+        }
+        for (const auto slot: parameterSlots(op->getType())) {
+            values.push_back(op->getParameter().at(slot));
+        }
+    }
+    return values;
+}
+
+template<class DDPackage>
+void CircuitSimulator<DDPackage>::setParameters(const std::vector<dd::fp>& values) {
+    const auto expected = parametersOf(*qc).size();
+    if (values.size() != expected) {
+        throw std::invalid_argument("Expected " + std::to_string(expected) + " parameters but got " + std::to_string(values.size()) + ".");
+    }
+
+    std::size_t next = 0;
+    for (auto& op: *qc) {
+        if (!op->isStandardOperation()) {
+            continue;
+        }
+        const auto slots = parameterSlots(op->getType());
+        if (slots.empty()) {
+            continue;
+        }
+        auto parameter = op->getParameter();
+        for (const auto slot: slots) {
+            parameter.at(slot) = values[next++];
+        }
+        // the DD of the replaced operation would otherwise stay pinned and occupy the cache for the rest of a sweep
+        op_cache.erase(op.get(), Simulator<DDPackage>::dd);
+        op = std::make_unique<qc::StandardOperation>(op->getNqubits(), op->getControls(), op->getTargets(), op->getType(), parameter[0], parameter[1], parameter[2], op->getStartingQubit());
+    }
+
+    if (Simulator<DDPackage>::rootEdge.p != nullptr) {
+        Simulator<DDPackage>::dd->decRef(Simulator<DDPackage>::rootEdge);
+        Simulator<DDPackage>::rootEdge = {};
+    }
+    session_started = false;
+}
+
 template class CircuitSimulator<dd::Package<>>;
+template class CircuitSimulator<DeepCircuitPackage>;
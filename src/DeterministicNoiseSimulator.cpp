@@ -1,12 +1,39 @@
 #include "DeterministicNoiseSimulator.hpp"
 
+#include "OperationCache.hpp"
 #include "dd/Export.hpp"
 
+#include <algorithm>
+#include <complex>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+
 using CN = dd::ComplexNumbers;
 
 template<class DDPackage>
 std::map<std::string, double> DeterministicNoiseSimulator<DDPackage>::DeterministicSimulate() {
-    std::map<unsigned int, bool> classicValues;
+    std::map<std::string, double> result;
+    for (const auto& [index, probability]: DeterministicSimulateSparse()) {
+        result.emplace(toBitString(index), probability);
+    }
+    return result;
+}
+
+template<class DDPackage>
+typename DeterministicNoiseSimulator<DDPackage>::SparseProbabilities DeterministicNoiseSimulator<DDPackage>::DeterministicSimulateSparse() {
+    if (qc->getNqubits() > 64U) {
+        throw std::invalid_argument("Sparse probabilities are limited to 64 qubits.");
+    }
+    simulateDensityMatrix();
+    return extractProbabilities();
+}
+
+template<class DDPackage>
+void DeterministicNoiseSimulator<DDPackage>::simulateDensityMatrix() {
+    // the memory limit only refers to the current simulation
+    Simulator<DDPackage>::memory_limit_exceeded = false;
 
     rootEdge = Simulator<DDPackage>::dd->makeZeroDensityOperator(qc->getNqubits());
     Simulator<DDPackage>::dd->incRef(rootEdge);
@@ -22,8 +49,12 @@ std::map<std::string, double> DeterministicNoiseSimulator<DDPackage>::Determinis
             useDensityMatrixType,
             sequentiallyApplyNoise);
 
+    OperationCache<DDPackage> opCache{};
+
+    std::size_t opIndex = 0;
     for (auto const& op: *qc) {
-        Simulator<DDPackage>::dd->garbageCollect();
+        ++opIndex;
+        Simulator<DDPackage>::collectGarbage();
         if (!op->isUnitary() && !(op->isClassicControlledOperation())) {
             if (auto* nuOp = dynamic_cast<qc::NonUnitaryOperation*>(op.get())) {
                 //Skipping barrier
@@ -38,43 +69,156 @@ std::map<std::string, double> DeterministicNoiseSimulator<DDPackage>::Determinis
             if (op->isClassicControlledOperation()) {
                 throw std::runtime_error("Classical controlled operations are not supported.");
             }
-            auto operation = dd::getDD(op.get(), Simulator<DDPackage>::dd);
+            const auto span      = Simulator<DDPackage>::traceBegin(Simulator<DDPackage>::dd, rootEdge);
+            auto       operation = opCache.get(op.get(), Simulator<DDPackage>::dd);
 
             // Applying the operation to the density matrix
             Simulator<DDPackage>::dd->applyOperationToDensity(rootEdge, operation, useDensityMatrixType);
 
             deterministicNoiseFunctionality.applyNoiseEffects(rootEdge, op);
+            Simulator<DDPackage>::traceEnd(span, Simulator<DDPackage>::dd, rootEdge, opIndex - 1, *op);
+
+            // density matrices cannot be approximated, so all that is left is a forced collection before stopping early
+            const auto limit = Simulator<DDPackage>::memory_limit;
+            if (limit > 0 && Simulator<DDPackage>::tableMemory(Simulator<DDPackage>::dd) > limit) {
+                Simulator<DDPackage>::dd->garbageCollect(true);
+                if (Simulator<DDPackage>::tableMemory(Simulator<DDPackage>::dd) > limit) {
+                    Simulator<DDPackage>::memory_limit_exceeded = true;
+                    break;
+                }
+            }
         }
     }
-    return Simulator<DDPackage>::dd->getProbVectorFromDensityMatrix(rootEdge, measurementThreshold);
+    opCache.clear(Simulator<DDPackage>::dd);
 }
 
 template<class DDPackage>
-std::map<std::string, std::size_t> DeterministicNoiseSimulator<DDPackage>::sampleFromProbabilityMap(const std::map<std::string, dd::fp>& resultProbabilityMap, unsigned int shots) {
-    // Create probability distribution from measure probabilities
-    std::vector<dd::fp> weights;
-    weights.reserve(resultProbabilityMap.size());
+typename DeterministicNoiseSimulator<DDPackage>::SparseProbabilities DeterministicNoiseSimulator<DDPackage>::extractProbabilities() {
+    // the optimized density matrix representation keeps flags in the node pointers, so all edges are aligned before use
+    const auto aligned = [](qc::DensityMatrixDD e) {
+        qc::DensityMatrixDD::alignDensityEdge(e);
+        return e;
+    };
+    const auto value = [](const dd::Complex& c) { return std::complex<dd::fp>{dd::CTEntry::val(c.r), dd::CTEntry::val(c.i)}; };
 
-    for (const auto& [state, prob]: resultProbabilityMap) {
-        weights.emplace_back(prob);
+    // largest magnitude of a diagonal path below a node; the flags of the representation only conjugate weights, so
+    // magnitudes are exact and bound every diagonal entry of the subtree
+    std::unordered_map<const dd::dNode*, dd::fp> maxDiagonal;
+    std::function<dd::fp(const dd::dNode*)>      maxDiagonalOf = [&](const dd::dNode* node) -> dd::fp {
+        if (const auto it = maxDiagonal.find(node); it != maxDiagonal.end()) {
+            return it->second;
+        }
+        dd::fp bound = 0.;
+        for (const auto child: {0U, 3U}) {
+            const auto e = aligned(node->e.at(child));
+            if (!e.w.approximatelyZero()) {
+                bound = std::max(bound, std::abs(value(e.w)) * (e.isTerminal() ? 1. : maxDiagonalOf(e.p)));
+            }
+        }
+        return maxDiagonal[node] = bound;
+    };
+
+    using Collect = std::function<void(const qc::DensityMatrixDD&, std::complex<dd::fp>, std::uint64_t)>;
+    SparseProbabilities probabilities;
+    Collect             collect = [&](const qc::DensityMatrixDD& edge, std::complex<dd::fp> amplitude, std::uint64_t index) {
+        const auto e = aligned(edge);
+        amplitude *= value(e.w);
+        if (e.isTerminal()) {
+            // diagonal entries of a density matrix are real, the imaginary part is numerical noise
+            if (amplitude.real() > measurementThreshold) {
+                probabilities.emplace_back(index, amplitude.real());
+            }
+            return;
+        }
+        if (std::abs(amplitude) * maxDiagonalOf(e.p) <= measurementThreshold) {
+            return;
+        }
+        // visiting |0><0| before |1><1| on every level yields the indices in ascending order
+        for (const auto child: {0U, 3U}) {
+            if (!e.p->e.at(child).w.approximatelyZero()) {
+                collect(e.p->e.at(child), amplitude, child == 0U ? index : index | (std::uint64_t{1} << static_cast<std::uint64_t>(e.p->v)));
+            }
+        }
+    };
+    if (!rootEdge.w.approximatelyZero()) {
+        collect(rootEdge, {1., 0.}, 0U);
     }
-    std::discrete_distribution<> d(weights.begin(), weights.end());
+    return probabilities;
+}
 
-    //Sample n shots elements from the prob distribution
-    std::map<std::size_t, std::size_t>     results;
-    std::uniform_real_distribution<dd::fp> dist(0.0L, 1.0L);
-    for (size_t n = 0; n < shots; ++n) {
-        ++results[d(this->mt)];
+template<class DDPackage>
+std::map<std::string, std::size_t> DeterministicNoiseSimulator<DDPackage>::sampleFromProbabilityMap(const std::map<std::string, dd::fp>& resultProbabilityMap, unsigned int shots) {
+    // the position in the map serves as index, so each sampled state is found without walking the map
+    std::vector<const std::string*> states;
+    SparseProbabilities             probabilities;
+    states.reserve(resultProbabilityMap.size());
+    probabilities.reserve(resultProbabilityMap.size());
+    for (const auto& [state, prob]: resultProbabilityMap) {
+        probabilities.emplace_back(states.size(), prob);
+        states.emplace_back(&state);
     }
 
-    // Create the final map containing the measurement results and the corresponding shots
     std::map<std::string, std::size_t> resultShotsMap;
+    for (const auto& [position, count]: sampleIndices(probabilities, shots)) {
+        resultShotsMap.emplace(*states.at(position), count);
+    }
+    return resultShotsMap;
+}
 
-    for (const auto& [state, prob]: results) {
-        resultShotsMap.emplace(std::next(resultProbabilityMap.begin(), static_cast<long>(state))->first, prob);
+template<class DDPackage>
+typename DeterministicNoiseSimulator<DDPackage>::SparseCounts DeterministicNoiseSimulator<DDPackage>::sampleIndices(const SparseProbabilities& probabilities, unsigned int shots) {
+    const std::size_t k = probabilities.size();
+    if (k == 0U || shots == 0U) {
+        return {};
     }
 
-    return resultShotsMap;
+    // Vose's alias method: every column holds the scaled probability of its own state and the alias that fills it up to one
+    dd::fp total = 0.;
+    for (const auto& [index, prob]: probabilities) {
+        total += prob;
+    }
+    std::vector<dd::fp>      threshold(k);
+    std::vector<std::size_t> alias(k);
+    std::vector<std::size_t> small;
+    std::vector<std::size_t> large;
+    for (std::size_t i = 0; i < k; ++i) {
+        threshold[i] = probabilities[i].second * static_cast<dd::fp>(k) / total;
+        (threshold[i] < 1. ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        const auto s = small.back();
+        const auto l = large.back();
+        small.pop_back();
+        alias[s] = l;
+        threshold[l] -= 1. - threshold[s];
+        if (threshold[l] < 1.) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // the remaining columns are full up to rounding errors
+    for (const auto i: small) {
+        threshold[i] = 1.;
+    }
+    for (const auto i: large) {
+        threshold[i] = 1.;
+    }
+
+    std::vector<std::size_t>                   counts(k, 0U);
+    std::uniform_int_distribution<std::size_t> column(0U, k - 1U);
+    std::uniform_real_distribution<dd::fp>     dist(0.0L, 1.0L);
+    for (unsigned int n = 0; n < shots; ++n) {
+        const auto i = column(this->mt);
+        ++counts[dist(this->mt) < threshold[i] ? i : alias[i]];
+    }
+
+    SparseCounts result;
+    for (std::size_t i = 0; i < k; ++i) {
+        if (counts[i] > 0U) {
+            result.emplace_back(probabilities[i].first, counts[i]);
+        }
+    }
+    return result;
 }
 
 template class DeterministicNoiseSimulator<DensityMatrixPackage>;
@@ -61,33 +61,87 @@ std::map<std::string, std::size_t> GroverSimulator::Simulate(unsigned int shots)
     rootEdge = dd->multiply(setup_op, rootEdge);
     dd->incRef(rootEdge);
 
-    unsigned int j_pre = 0;
+    if (strategy == IterationStrategy::Unrolled) {
+        applyUnrolled(full_iteration, iterations);
+    } else {
+        applyRepeatedSquaring(full_iteration, iterations, strategy == IterationStrategy::Adaptive);
+    }
+    dd->decRef(full_iteration);
+
+    return MeasureAllNonCollapsing(shots);
+}
+
+void GroverSimulator::applyUnrolled(const qc::MatrixDD& op, std::size_t repetitions) {
+    std::size_t j_pre = 0;
 
-    while ((iterations - j_pre) % 8 != 0) {
-        //std::clog << "[INFO]  Pre-Iteration " << j_pre+1 << " of " << iterations%8 << " -- size:" << dd->size(rootEdge)  << "\n";
-        auto tmp = dd->multiply(full_iteration, rootEdge);
+    while ((repetitions - j_pre) % 8 != 0) {
+        //std::clog << "[INFO]  Pre-Iteration " << j_pre+1 << " of " << repetitions%8 << " -- size:" << dd->size(rootEdge)  << "\n";
+        const auto span = traceBegin(dd, rootEdge);
+        auto       tmp  = dd->multiply(op, rootEdge);
         dd->incRef(tmp);
         dd->decRef(rootEdge);
         rootEdge = tmp;
         dd->garbageCollect();
+        traceEnd(span, dd, rootEdge, j_pre, "grover_iteration");
         j_pre++;
     }
 
-    for (unsigned long long j = j_pre; j < iterations; j += 8) {
-        //std::clog << "[INFO]  Iteration " << j+1 << " of " << iterations << " -- size:" << dd->size(rootEdge)  << "\n";
-        auto tmp = dd->multiply(full_iteration, rootEdge);
-        tmp      = dd->multiply(full_iteration, tmp);
-        tmp      = dd->multiply(full_iteration, tmp);
-        tmp      = dd->multiply(full_iteration, tmp);
-        tmp      = dd->multiply(full_iteration, tmp);
-        tmp      = dd->multiply(full_iteration, tmp);
-        tmp      = dd->multiply(full_iteration, tmp);
-        tmp      = dd->multiply(full_iteration, tmp);
+    for (std::size_t j = j_pre; j < repetitions; j += 8) {
+        //std::clog << "[INFO]  Iteration " << j+1 << " of " << repetitions << " -- size:" << dd->size(rootEdge)  << "\n";
+        const auto span = traceBegin(dd, rootEdge);
+        auto       tmp  = dd->multiply(op, rootEdge);
+        tmp             = dd->multiply(op, tmp);
+        tmp             = dd->multiply(op, tmp);
+        tmp             = dd->multiply(op, tmp);
+        tmp             = dd->multiply(op, tmp);
+        tmp             = dd->multiply(op, tmp);
+        tmp             = dd->multiply(op, tmp);
+        tmp             = dd->multiply(op, tmp);
         dd->incRef(tmp);
         dd->decRef(rootEdge);
         rootEdge = tmp;
         dd->garbageCollect();
+        traceEnd(span, dd, rootEdge, j, "grover_iterations_x8");
     }
+    state_multiplications += repetitions;
+}
 
-    return MeasureAllNonCollapsing(shots);
+void GroverSimulator::applyRepeatedSquaring(const qc::MatrixDD& op, std::size_t repetitions, bool adaptive) {
+    // All powers of the iteration commute, so they can be applied to the state in any order. Going through the bits of
+    // repetitions from the least significant one, power is always op^(2^bit).
+    const auto max_size = ADAPTIVE_MAX_GROWTH * dd->size(op);
+    auto       power    = op;
+    dd->incRef(power);
+
+    while (repetitions > 0) {
+        if ((repetitions & 1U) != 0) {
+            const auto span = traceBegin(dd, rootEdge);
+            auto       tmp  = dd->multiply(power, rootEdge);
+            dd->incRef(tmp);
+            dd->decRef(rootEdge);
+            rootEdge = tmp;
+            traceEnd(span, dd, rootEdge, state_multiplications, "grover_power");
+            state_multiplications++;
+        }
+        repetitions >>= 1U;
+        if (repetitions == 0) {
+            break;
+        }
+
+        const auto span   = traceBegin(dd, power);
+        auto       square = dd->multiply(power, power);
+        traceEnd(span, dd, square, matrix_squarings, "grover_squaring");
+        if (adaptive && dd->size(square) > max_size) {
+            // the remaining repetitions are 2 * repetitions applications of the current power
+            applyUnrolled(power, 2 * repetitions);
+            break;
+        }
+        dd->incRef(square);
+        dd->decRef(power);
+        power = square;
+        matrix_squarings++;
+        dd->garbageCollect();
+    }
+    dd->decRef(power);
+    dd->garbageCollect();
 }
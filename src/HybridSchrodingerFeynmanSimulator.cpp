@@ -1,59 +1,223 @@
 #include "HybridSchrodingerFeynmanSimulator.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
 #include <taskflow/taskflow.hpp>
+#include <utility>
+#include <vector>
+
+namespace {
+    // every task simulates an aligned block of slices whose size has to be a power of two
+    std::int64_t largestPowerOfTwoUpTo(std::int64_t value) {
+        std::int64_t result = 1;
+        while (result * 2 <= value) {
+            result *= 2;
+        }
+        return result;
+    }
+
+    // adds the amplitudes of e (scaled by amp) that fall into [begin, begin + rangeLength) to buffer,
+    // where e represents the sub-vector starting at offset with the given length
+    void addAmplitudesInRange(const qc::VectorDD& e, const std::complex<dd::fp>& amp, std::size_t offset, std::size_t length, std::size_t begin, std::size_t rangeLength, std::complex<dd::fp>* buffer) {
+        if (e.w.approximatelyZero() || offset >= begin + rangeLength || offset + length <= begin) {
+            return;
+        }
+
+        const auto c = amp * std::complex<dd::fp>{dd::CTEntry::val(e.w.r), dd::CTEntry::val(e.w.i)};
+        if (e.isTerminal()) {
+            buffer[offset] += c;
+            return;
+        }
+
+        const auto half = length / 2;
+        addAmplitudesInRange(e.p->e.at(0), c, offset, half, begin, rangeLength, buffer);
+        addAmplitudesInRange(e.p->e.at(1), c, offset + half, half, begin, rangeLength, buffer);
+    }
+} // namespace
+
+template<class DDPackage, class SliceDDPackage>
+bool HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::isSplitOperation(const qc::Operation& op, dd::Qubit split_qubit) {
+    if (op.isStandardOperation()) {
+        bool target_in_lower_slice = false, target_in_upper_slice = false;
+        bool control_in_lower_slice = false, control_in_upper_slice = false;
+        for (const auto& target: op.getTargets()) {
+            target_in_lower_slice = target_in_lower_slice || target < split_qubit;
+            target_in_upper_slice = target_in_upper_slice || target >= split_qubit;
+        }
+        for (const auto& control: op.getControls()) {
+            control_in_lower_slice = control_in_lower_slice || control.qubit < split_qubit;
+            control_in_upper_slice = control_in_upper_slice || control.qubit >= split_qubit;
+        }
+        return (target_in_lower_slice && control_in_upper_slice) ||
+               (target_in_upper_slice && control_in_lower_slice);
+    }
+    if (op.getType() == qc::Barrier || op.getType() == qc::Snapshot || op.getType() == qc::ShowProbabilities) {
+        return false;
+    }
+    throw std::invalid_argument("Only StandardOperations are supported for now.");
+}
+
+template<class DDPackage, class SliceDDPackage>
+bool HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::isSliceableOperation(const qc::Operation& op, dd::Qubit split_qubit) {
+    if (!op.isStandardOperation()) {
+        // either ignored by the slices or rejected for every cut
+        return true;
+    }
+    bool        target_in_lower_slice = false, target_in_upper_slice = false;
+    std::size_t controls_in_lower_slice = 0, controls_in_upper_slice = 0;
+    for (const auto& target: op.getTargets()) {
+        target_in_lower_slice = target_in_lower_slice || target < split_qubit;
+        target_in_upper_slice = target_in_upper_slice || target >= split_qubit;
+    }
+    for (const auto& control: op.getControls()) {
+        controls_in_lower_slice += control.qubit < split_qubit ? 1U : 0U;
+        controls_in_upper_slice += control.qubit >= split_qubit ? 1U : 0U;
+    }
+    if (target_in_lower_slice && target_in_upper_slice) {
+        return false;
+    }
+    // the control slice of a split operation may only hold a single control
+    return !(target_in_upper_slice && controls_in_lower_slice > 1) && !(target_in_lower_slice && controls_in_upper_slice > 1);
+}
 
-template<class DDPackage>
-std::size_t HybridSchrodingerFeynmanSimulator<DDPackage>::getNDecisions(dd::Qubit split_qubit) {
+template<class DDPackage, class SliceDDPackage>
+std::size_t HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::getNDecisions(dd::Qubit split_qubit) {
     std::size_t ndecisions = 0;
     // calculate number of decisions
     for (const auto& op: *CircuitSimulator<DDPackage>::qc) {
-        if (op->isStandardOperation()) {
-            bool target_in_lower_slice = false, target_in_upper_slice = false;
-            bool control_in_lower_slice = false, control_in_upper_slice = false;
-            for (const auto& target: op->getTargets()) {
-                target_in_lower_slice = target_in_lower_slice || target < split_qubit;
-                target_in_upper_slice = target_in_upper_slice || target >= split_qubit;
-            }
-            for (const auto& control: op->getControls()) {
-                control_in_lower_slice = control_in_lower_slice || control.qubit < split_qubit;
-                control_in_upper_slice = control_in_upper_slice || control.qubit >= split_qubit;
-            }
-            if ((target_in_lower_slice && control_in_upper_slice) ||
-                (target_in_upper_slice && control_in_lower_slice)) {
-                ndecisions++;
-            }
-        } else if (op->getType() == qc::Barrier || op->getType() == qc::Snapshot || op->getType() == qc::ShowProbabilities) {
-            continue;
-        } else {
-            throw std::invalid_argument("Only StandardOperations are supported for now.");
+        if (isSplitOperation(*op, split_qubit)) {
+            ndecisions++;
         }
     }
     return ndecisions;
 }
 
-template<class DDPackage>
-qc::VectorDD HybridSchrodingerFeynmanSimulator<DDPackage>::SimulateSlicing(std::unique_ptr<dd::Package<>>& slice_dd, dd::Qubit split_qubit, std::size_t controls) {
+template<class DDPackage, class SliceDDPackage>
+dd::Qubit HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::findBestSplitQubit() {
+    const auto nqubits = static_cast<dd::Qubit>(CircuitSimulator<DDPackage>::getNumberOfQubits());
+    if (nqubits < 2) {
+        return static_cast<dd::Qubit>(nqubits / 2);
+    }
+
+    // compare the costs in log2 scale: 2^decisions slices, each one represented by DDs of at most 2^k + 2^(n-k) nodes
+    const auto log2Cost = [nqubits](std::size_t ndecisions, dd::Qubit cut) {
+        const auto larger  = static_cast<double>(std::max<int>(cut, nqubits - cut));
+        const auto smaller = static_cast<double>(std::min<int>(cut, nqubits - cut));
+        return static_cast<double>(ndecisions) + larger + std::log2(1. + std::exp2(smaller - larger));
+    };
+
+    const auto& ops       = *CircuitSimulator<DDPackage>::qc;
+    const auto  sliceable = [&ops](dd::Qubit cut) {
+        return std::all_of(ops.begin(), ops.end(), [cut](const auto& op) { return isSliceableOperation(*op, cut); });
+    };
+
+    std::optional<dd::Qubit> best{};
+    double                   bestCost = 0.;
+    for (dd::Qubit cut = 1; cut < nqubits; ++cut) {
+        if (!sliceable(cut)) {
+            continue;
+        }
+        const auto cost = log2Cost(getNDecisions(cut), cut);
+        // on ties, prefer the cut closer to the middle, which keeps both slices small
+        if (!best.has_value() || cost < bestCost || (cost == bestCost && std::abs(2 * cut - nqubits) < std::abs(2 * *best - nqubits))) {
+            best     = cut;
+            bestCost = cost;
+        }
+    }
+    // without a feasible cut, the slices report the unsupported operation
+    return best.value_or(static_cast<dd::Qubit>(nqubits / 2));
+}
+
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::SimulateSlices(std::unique_ptr<SliceDDPackage>& slice_dd, dd::Qubit split_qubit, std::size_t firstControl, std::size_t nslices, const std::function<void(qc::VectorDD)>& consume) {
+    SimulateSlicePairs(slice_dd, split_qubit, firstControl, nslices, [&slice_dd, &consume](const qc::VectorDD& upper, const qc::VectorDD& lower) {
+        auto result = slice_dd->kronecker(upper, lower, false);
+        slice_dd->incRef(result);
+        consume(result);
+    });
+}
+
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::SimulateSlicePairs(std::unique_ptr<SliceDDPackage>& slice_dd, dd::Qubit split_qubit, std::size_t firstControl, std::size_t nslices, const std::function<void(const qc::VectorDD&, const qc::VectorDD&)>& consume) {
+    auto&             ops        = *CircuitSimulator<DDPackage>::qc;
+    std::vector<bool> splitOps(ops.getNops());
+    std::size_t       ndecisions = 0;
+    for (std::size_t i = 0; i < splitOps.size(); ++i) {
+        splitOps[i] = isSplitOperation(*ops.at(i), split_qubit);
+        ndecisions += splitOps[i] ? 1U : 0U;
+    }
+
+    // The first decisions correspond to the most significant bits of the control value, so a range of consecutive
+    // control values shares its first decisions (and hence the longest possible prefix). Of the remaining (free)
+    // decisions both outcomes are explored.
+    const auto  freeDecisions = static_cast<std::size_t>(std::log2(nslices));
+    std::size_t controls      = 0;
+    for (std::size_t decision = 0; decision + freeDecisions < ndecisions; ++decision) {
+        controls |= ((firstControl >> (ndecisions - 1 - decision)) & 1U) << decision;
+    }
+
     Slice lower(slice_dd, 0, static_cast<dd::Qubit>(split_qubit - 1), controls);
     Slice upper(slice_dd, split_qubit, static_cast<dd::Qubit>(CircuitSimulator<DDPackage>::getNumberOfQubits() - 1), controls);
+    typename Simulator<DDPackage>::GarbageCollectionState gcState{};
+    SimulateSlicesRec(slice_dd, splitOps, 0, lower, upper, ndecisions - freeDecisions, gcState, consume);
+}
 
-    for (const auto& op: *CircuitSimulator<DDPackage>::qc) {
-        if (op->isUnitary()) {
-            [[maybe_unused]] auto l = lower.apply(slice_dd, op);
-            [[maybe_unused]] auto u = upper.apply(slice_dd, op);
-            assert(l == u);
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::SimulateSlicesRec(std::unique_ptr<SliceDDPackage>& slice_dd, const std::vector<bool>& splitOps, std::size_t opIdx, Slice lower, Slice upper, std::size_t firstFreeDecision, typename Simulator<DDPackage>::GarbageCollectionState& gcState, const std::function<void(const qc::VectorDD&, const qc::VectorDD&)>& consume) {
+    auto& ops = *CircuitSimulator<DDPackage>::qc;
+    for (; opIdx < ops.getNops(); ++opIdx) {
+        // tasks cannot throw, so a cancelled simulation merely stops exploring the slices and throws once all tasks are done
+        if (Simulator<DDPackage>::cancellationRequested()) {
+            break;
+        }
+        const auto& op = ops.at(opIdx);
+        if (!op->isUnitary()) {
+            continue;
+        }
+        if (splitOps[opIdx] && lower.nDecisionsExecuted >= firstFreeDecision) {
+            // both branches continue from the current state of the slices, which they keep alive by their own references
+            for (const bool decision: {false, true}) {
+                Slice lowerBranch = lower;
+                Slice upperBranch = upper;
+                lowerBranch.setDecision(lower.nDecisionsExecuted, decision);
+                upperBranch.setDecision(upper.nDecisionsExecuted, decision);
+                slice_dd->incRef(lowerBranch.edge);
+                slice_dd->incRef(upperBranch.edge);
+
+                [[maybe_unused]] auto l = lowerBranch.apply(slice_dd, op);
+                [[maybe_unused]] auto u = upperBranch.apply(slice_dd, op);
+                assert(l && u);
+                Simulator<DDPackage>::collectGarbage(slice_dd, gcState);
+                SimulateSlicesRec(slice_dd, splitOps, opIdx + 1, lowerBranch, upperBranch, firstFreeDecision, gcState, consume);
+            }
+            slice_dd->decRef(lower.edge);
+            slice_dd->decRef(upper.edge);
+            return;
         }
-        slice_dd->garbageCollect();
-    }
 
-    auto result = slice_dd->kronecker(upper.edge, lower.edge, false);
-    slice_dd->incRef(result);
+        [[maybe_unused]] auto l = lower.apply(slice_dd, op);
+        [[maybe_unused]] auto u = upper.apply(slice_dd, op);
+        assert(l == u);
+        Simulator<DDPackage>::collectGarbage(slice_dd, gcState);
+    }
 
-    return result;
+    if (!Simulator<DDPackage>::cancellationRequested()) {
+        consume(upper.edge, lower.edge);
+        Simulator<DDPackage>::advanceProgress(slice_dd);
+    }
+    slice_dd->decRef(lower.edge);
+    slice_dd->decRef(upper.edge);
 }
 
-template<class DDPackage>
-bool HybridSchrodingerFeynmanSimulator<DDPackage>::Slice::apply(std::unique_ptr<dd::Package<>>& slice_dd, const std::unique_ptr<qc::Operation>& op) {
+template<class DDPackage, class SliceDDPackage>
+bool HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::Slice::apply(std::unique_ptr<SliceDDPackage>& slice_dd, const std::unique_ptr<qc::Operation>& op) {
     bool is_split_op = false;
     if (reinterpret_cast<qc::StandardOperation*>(op.get())) { // TODO change control and target if wrong direction
         qc::Targets  op_targets{};
@@ -119,15 +283,36 @@ bool HybridSchrodingerFeynmanSimulator<DDPackage>::Slice::apply(std::unique_ptr<
     return is_split_op;
 }
 
-template<class DDPackage>
-std::map<std::string, std::size_t> HybridSchrodingerFeynmanSimulator<DDPackage>::Simulate(unsigned int shots) {
-    auto nqubits    = CircuitSimulator<DDPackage>::getNumberOfQubits();
-    auto splitQubit = static_cast<dd::Qubit>(nqubits / 2);
+template<class DDPackage, class SliceDDPackage>
+dd::Qubit HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::selectSplitQubit() {
+    const auto nqubits = CircuitSimulator<DDPackage>::getNumberOfQubits();
+    if (splitQubit.has_value() && (*splitQubit < 1 || static_cast<dd::QubitCount>(*splitQubit) >= nqubits)) {
+        throw std::invalid_argument("Split qubit " + std::to_string(*splitQubit) + " has to be in the range [1, " + std::to_string(nqubits - 1) + "].");
+    }
+    usedSplitQubit = splitQubit.has_value() ? *splitQubit : findBestSplitQubit();
+    usedDecisions  = getNDecisions(usedSplitQubit);
+    return usedSplitQubit;
+}
+
+template<class DDPackage, class SliceDDPackage>
+std::map<std::string, std::size_t> HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::Simulate(unsigned int shots) {
+    if (mode == Mode::DD && isDistributed()) {
+        throw std::invalid_argument("The DD mode of the hybrid Schrodinger-Feynman simulator cannot be distributed.");
+    }
+    const auto split = selectSplitQubit();
+    Simulator<DDPackage>::beginProgress(std::size_t{1} << usedDecisions);
     if (mode == Mode::DD) {
-        SimulateHybridTaskflow(splitQubit);
+        SimulateHybridTaskflow(split);
+        Simulator<DDPackage>::checkCancellation();
         return Simulator<DDPackage>::MeasureAllNonCollapsing(shots);
     } else {
-        SimulateHybridAmplitudes(splitQubit);
+        // a file-backed result is accumulated in place, as per-thread buffers in anonymous memory would not fit anyway
+        if (mode == Mode::SharedAmplitude || !amplitudeFile.empty()) {
+            SimulateHybridSharedAmplitudes(split);
+        } else {
+            SimulateHybridAmplitudes(split);
+        }
+        Simulator<DDPackage>::checkCancellation();
 
         if (shots > 0) {
             return Simulator<DDPackage>::SampleFromAmplitudeVectorInPlace(finalAmplitudes, shots);
@@ -138,114 +323,332 @@ std::map<std::string, std::size_t> HybridSchrodingerFeynmanSimulator<DDPackage>:
     }
 }
 
-template<class DDPackage>
-void HybridSchrodingerFeynmanSimulator<DDPackage>::SimulateHybridTaskflow(const dd::Qubit split_qubit) {
-    const auto         ndecisions          = getNDecisions(split_qubit);
-    const std::int64_t max_control         = 1LL << ndecisions;
+template<class DDPackage, class SliceDDPackage>
+AmplitudeMap HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::SimulateAmplitudes(const std::vector<std::size_t>& indices, [[maybe_unused]] std::size_t projectedLayers) {
+    Simulator<DDPackage>::checkAmplitudeIndices(indices, CircuitSimulator<DDPackage>::getNumberOfQubits());
+    const auto         split               = selectSplitQubit();
+    const std::int64_t max_control         = 1LL << usedDecisions;
+    Simulator<DDPackage>::beginProgress(static_cast<std::size_t>(max_control));
     const int          actuallyUsedThreads = static_cast<std::size_t>(max_control) < nthreads ? static_cast<int>(max_control) : static_cast<int>(nthreads);
-    const std::int64_t nslices_at_once     = std::min<std::int64_t>(16, max_control / static_cast<std::int64_t>(actuallyUsedThreads));
-
-    Simulator<DDPackage>::rootEdge = qc::VectorDD::zero;
+    const std::int64_t nslices_on_one_cpu  = largestPowerOfTwoUpTo(std::min<std::int64_t>(64, max_control / actuallyUsedThreads));
+
+    // the amplitudes of the (equal) lower and upper parts of the indices are only read once per slice
+    const std::size_t        lowerMask = (std::size_t{1} << split) - 1U;
+    std::vector<std::size_t> lowerParts;
+    std::vector<std::size_t> upperParts;
+    for (const auto index: indices) {
+        lowerParts.emplace_back(index & lowerMask);
+        upperParts.emplace_back(index & ~lowerMask);
+    }
+    for (auto* parts: {&lowerParts, &upperParts}) {
+        std::sort(parts->begin(), parts->end());
+        parts->erase(std::unique(parts->begin(), parts->end()), parts->end());
+    }
+    const auto position = [](const std::vector<std::size_t>& parts, std::size_t part) {
+        return static_cast<std::size_t>(std::lower_bound(parts.begin(), parts.end(), part) - parts.begin());
+    };
+    std::vector<std::pair<std::size_t, std::size_t>> positions; // of the lower and upper part of each index
+    for (const auto index: indices) {
+        positions.emplace_back(position(lowerParts, index & lowerMask), position(upperParts, index & ~lowerMask));
+    }
 
-    std::vector<std::vector<bool>> computed(ndecisions, std::vector<bool>(max_control, false));
+    std::vector<std::vector<std::complex<dd::fp>>> sums(static_cast<std::size_t>(actuallyUsedThreads), std::vector<std::complex<dd::fp>>(indices.size()));
 
-    tf::Executor executor(nthreads);
+    tf::Executor executor(static_cast<std::size_t>(actuallyUsedThreads));
+    runSliceBlocks(executor, nslices_on_one_cpu, [&](std::int64_t control) {
+        auto& thread_sums = sums.at(static_cast<std::size_t>(executor.this_worker_id()));
 
-    std::function<void(std::pair<std::int64_t, std::int64_t>)> compute_pair = [this, &compute_pair, &computed, &executor, ndecisions, nslices_at_once, split_qubit](std::pair<std::int64_t, std::int64_t> current) {
-        if (current.first == 0) { // slice
-            std::unique_ptr<dd::Package<>> old_dd;
-            qc::VectorDD                   edge{};
-            for (std::int64_t i = 0; i < nslices_at_once; i++) {
-                auto slice_dd = std::make_unique<dd::Package<>>(CircuitSimulator<DDPackage>::getNumberOfQubits());
-                auto result   = SimulateSlicing(slice_dd, split_qubit, current.second + i);
-                if (i > 0) {
-                    edge = slice_dd->add(slice_dd->transfer(edge), result);
-                } else {
-                    edge = result;
-                }
-                old_dd = std::move(slice_dd);
+        auto                              slice_dd = std::make_unique<SliceDDPackage>(CircuitSimulator<DDPackage>::getNumberOfQubits());
+        std::vector<std::complex<dd::fp>> lowerAmplitudes(lowerParts.size());
+        std::vector<std::complex<dd::fp>> upperAmplitudes(upperParts.size());
+        SimulateSlicePairs(slice_dd, split, static_cast<std::size_t>(control), static_cast<std::size_t>(nslices_on_one_cpu), [&](const qc::VectorDD& upper, const qc::VectorDD& lower) {
+            for (std::size_t i = 0; i < lowerParts.size(); ++i) {
+                lowerAmplitudes[i] = Simulator<DDPackage>::amplitudeOf(lower, lowerParts[i]);
+            }
+            for (std::size_t i = 0; i < upperParts.size(); ++i) {
+                upperAmplitudes[i] = Simulator<DDPackage>::amplitudeOf(upper, upperParts[i]);
             }
+            for (std::size_t k = 0; k < indices.size(); ++k) {
+                thread_sums[k] += upperAmplitudes[positions[k].second] * lowerAmplitudes[positions[k].first];
+            }
+            slice_dd->garbageCollect();
+        });
+    });
+    for (std::size_t buffer = 1; buffer < sums.size(); ++buffer) {
+        std::transform(sums[0].begin(), sums[0].end(), sums[buffer].begin(), sums[0].begin(), std::plus<>());
+    }
+    reduceAmplitudes(sums[0].data(), sums[0].size());
+    Simulator<DDPackage>::checkCancellation();
 
-            current.first = static_cast<std::int64_t>(std::log2(nslices_at_once));
-            current.second /= nslices_at_once;
-            dd::serialize(edge, "slice_" + std::to_string(current.first) + "_" + std::to_string(current.second) + ".dd", true);
-        } else { // adding
-            auto        slice_dd       = std::make_unique<dd::Package<>>(CircuitSimulator<DDPackage>::getNumberOfQubits());
-            std::string filename       = "slice_" + std::to_string(current.first - 1) + "_";
-            std::string filename_left  = filename + std::to_string(current.second * 2) + ".dd";
-            std::string filename_right = filename + std::to_string(current.second * 2 + 1) + ".dd";
+    AmplitudeMap amplitudes;
+    for (std::size_t k = 0; k < indices.size(); ++k) {
+        amplitudes.emplace(indices[k], sums[0][k]);
+    }
+    return amplitudes;
+}
 
-            auto result  = slice_dd->template deserialize<dd::vNode>(filename_left, true);
-            auto result2 = slice_dd->template deserialize<dd::vNode>(filename_right, true);
-            result       = slice_dd->add(result, result2);
-            dd::serialize(result, "slice_" + std::to_string(current.first) + "_" + std::to_string(current.second) + ".dd", true);
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::SimulateHybridTaskflow(const dd::Qubit split_qubit) {
+    const auto         ndecisions          = getNDecisions(split_qubit);
+    const std::int64_t max_control         = 1LL << ndecisions;
+    const int          actuallyUsedThreads = static_cast<std::size_t>(max_control) < nthreads ? static_cast<int>(max_control) : static_cast<int>(nthreads);
 
-            remove(filename_left.c_str());
-            remove(filename_right.c_str());
-        }
+    // the number of slices summed up by a single task has to be a power of two for the reduction tree to be complete
+    const std::int64_t nslices_at_once = largestPowerOfTwoUpTo(std::min<std::int64_t>(16, max_control / static_cast<std::int64_t>(actuallyUsedThreads)));
+    const auto leaf_level = static_cast<std::size_t>(std::log2(nslices_at_once));
 
-        if (current.first < static_cast<std::int64_t>(ndecisions)) {
-            computed.at(current.first).at(current.second) = true;
+    Simulator<DDPackage>::rootEdge = qc::VectorDD::zero;
+    spilledPartialSums             = 0;
+
+    // partial sums waiting for their sibling in the reduction tree, indexed by (level, index)
+    std::mutex                                                 partialSumsMutex;
+    std::map<std::pair<std::size_t, std::int64_t>, PartialSum> partialSums;
+    std::size_t                                                storedBytes = 0;
+    PartialSum                                                 finalSum{};
+
+    // spill files are named uniquely, so concurrent runs using the same scratch directory do not interfere
+    std::ostringstream spillPrefix;
+    spillPrefix << "ddsim_hsf_" << std::hex << std::random_device{}() << reinterpret_cast<std::uintptr_t>(this) << "_";
+
+    const auto spill = [this, &spillPrefix](PartialSum& partial, std::size_t level, std::int64_t idx) {
+        partial.file = (std::filesystem::path(scratchDirectory) / (spillPrefix.str() + std::to_string(level) + "_" + std::to_string(idx) + ".dd")).string();
+        dd::serialize(partial.edge, partial.file, true);
+        partial.edge  = qc::VectorDD::zero;
+        partial.bytes = 0;
+        partial.dd.reset();
+        ++spilledPartialSums;
+    };
 
-            const auto comp_second = current.second + (current.second % 2 ? (-1) : 1);
+    const auto load = [this](PartialSum& partial) {
+        if (partial.file.empty()) {
+            return;
+        }
+        partial.dd   = std::make_unique<SliceDDPackage>(CircuitSimulator<DDPackage>::getNumberOfQubits());
+        partial.edge = partial.dd->template deserialize<dd::vNode>(partial.file, true);
+        partial.dd->incRef(partial.edge);
+        std::filesystem::remove(partial.file);
+        partial.file.clear();
+    };
 
-            if (computed.at(current.first).at(comp_second)) {
-                executor.silent_async([&compute_pair, current]() { compute_pair(std::make_pair(current.first + 1, current.second / 2)); });
+    // walks up the reduction tree for as long as the sibling of the current partial sum is already available
+    const auto reduce = [&](PartialSum partial, std::size_t level, std::int64_t idx) {
+        while (level < ndecisions) {
+            PartialSum sibling{};
+            {
+                std::lock_guard<std::mutex> lock(partialSumsMutex);
+                auto                        it = partialSums.find({level, idx ^ 1});
+                if (it == partialSums.end()) {
+                    partial.bytes = partial.dd->size(partial.edge) * BYTES_PER_NODE;
+                    if (memoryBudget > 0 && storedBytes + partial.bytes > memoryBudget) {
+                        spill(partial, level, idx);
+                    }
+                    storedBytes += partial.bytes;
+                    partialSums.emplace(std::make_pair(level, idx), std::move(partial));
+                    return;
+                }
+                sibling = std::move(it->second);
+                storedBytes -= sibling.bytes;
+                partialSums.erase(it);
             }
+            load(partial);
+            load(sibling);
+
+            // the sibling's package is exclusively owned by this task now, so its DD can be transferred safely
+            auto other = partial.dd->transfer(sibling.edge);
+            auto sum   = partial.dd->add(partial.edge, other);
+            partial.dd->incRef(sum);
+            partial.dd->decRef(partial.edge);
+            partial.edge = sum;
+            sibling.dd.reset();
+            partial.dd->garbageCollect();
+
+            ++level;
+            idx /= 2;
         }
+        finalSum = std::move(partial);
     };
 
-    for (auto i = max_control - 1; i >= 0; i -= nslices_at_once) {
-        executor.silent_async([&compute_pair, i]() { compute_pair(std::make_pair(0, i)); });
+    tf::Executor executor(nthreads);
+    for (auto i = max_control - nslices_at_once; i >= 0; i -= nslices_at_once) {
+        executor.silent_async([this, &reduce, i, nslices_at_once, leaf_level, split_qubit]() {
+            auto         slice_dd = std::make_unique<SliceDDPackage>(CircuitSimulator<DDPackage>::getNumberOfQubits());
+            qc::VectorDD edge     = qc::VectorDD::zero;
+            SimulateSlices(slice_dd, split_qubit, static_cast<std::size_t>(i), static_cast<std::size_t>(nslices_at_once), [&slice_dd, &edge](qc::VectorDD result) {
+                auto sum = slice_dd->add(edge, result);
+                slice_dd->incRef(sum);
+                slice_dd->decRef(edge);
+                slice_dd->decRef(result);
+                edge = sum;
+                slice_dd->garbageCollect();
+            });
+
+            PartialSum partial{};
+            partial.dd   = std::move(slice_dd);
+            partial.edge = edge;
+            reduce(std::move(partial), leaf_level, i / nslices_at_once);
+        });
     }
     executor.wait_for_all();
 
-    Simulator<DDPackage>::rootEdge = Simulator<DDPackage>::dd->template deserialize<dd::vNode>("slice_" + std::to_string(ndecisions) + "_0.dd", true);
+    load(finalSum);
+    Simulator<DDPackage>::rootEdge = Simulator<DDPackage>::dd->transfer(finalSum.edge);
     Simulator<DDPackage>::dd->incRef(Simulator<DDPackage>::rootEdge);
 }
 
-template<class DDPackage>
-void HybridSchrodingerFeynmanSimulator<DDPackage>::SimulateHybridAmplitudes(dd::Qubit split_qubit) {
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::SimulateHybridAmplitudes(dd::Qubit split_qubit) {
     const auto         ndecisions  = getNDecisions(split_qubit);
     const std::int64_t max_control = 1LL << ndecisions;
 
     const int actuallyUsedThreads  = static_cast<std::size_t>(max_control) < nthreads ? static_cast<int>(max_control) : static_cast<int>(nthreads);
     Simulator<DDPackage>::rootEdge = qc::VectorDD::zero;
 
-    const std::int64_t   nslices_on_one_cpu = std::min<std::int64_t>(64, max_control / actuallyUsedThreads);
+    const std::int64_t   nslices_on_one_cpu = largestPowerOfTwoUpTo(std::min<std::int64_t>(64, max_control / actuallyUsedThreads));
     const dd::QubitCount nqubits            = CircuitSimulator<DDPackage>::getNumberOfQubits();
+    const std::size_t    dim                = 1ULL << nqubits;
+
+    // the previous result is released first, as it may be as large as the available memory
+    finalAmplitudes = AmplitudeBuffer{};
+    // all buffers share the same chunks, so every chunk of the sum below is processed on the node it was zeroed on
+    std::vector<AmplitudeBuffer> amplitudes;
+    for (int t = 0; t < actuallyUsedThreads; ++t) {
+        amplitudes.emplace_back(dim, std::string{}, static_cast<unsigned int>(nthreads));
+    }
 
-    std::vector<std::vector<std::complex<dd::fp>>> amplitudes(actuallyUsedThreads, std::vector<std::complex<dd::fp>>(1u << nqubits));
+    // every worker accumulates into its own buffer, no matter how many tasks it processes
+    tf::Executor executor(static_cast<std::size_t>(actuallyUsedThreads));
+    runSliceBlocks(executor, nslices_on_one_cpu, [this, &executor, &amplitudes, nslices_on_one_cpu, split_qubit, dim](std::int64_t control) {
+        auto& thread_amplitudes = amplitudes.at(static_cast<std::size_t>(executor.this_worker_id()));
 
-    tf::Executor executor;
-    for (std::int64_t control = 0, i = 0; control < max_control; control += nslices_on_one_cpu, i++) {
-        executor.silent_async([this, i, &amplitudes, nslices_on_one_cpu, control, nqubits, split_qubit]() {
-            const auto                         current_thread    = i;
-            std::vector<std::complex<dd::fp>>& thread_amplitudes = amplitudes.at(current_thread);
+        auto slice_dd = std::make_unique<SliceDDPackage>(CircuitSimulator<DDPackage>::getNumberOfQubits());
+        SimulateSlices(slice_dd, split_qubit, static_cast<std::size_t>(control), static_cast<std::size_t>(nslices_on_one_cpu), [&slice_dd, &thread_amplitudes, dim](qc::VectorDD result) {
+            addAmplitudesInRange(result, {1., 0.}, 0, dim, 0, dim, thread_amplitudes.data());
+            slice_dd->decRef(result);
+            slice_dd->garbageCollect();
+        });
+    });
 
-            for (std::int64_t local_control = 0; local_control < nslices_on_one_cpu; local_control++) {
-                const std::int64_t             total_control = control + local_control;
-                std::unique_ptr<dd::Package<>> slice_dd      = std::make_unique<dd::Package<>>(CircuitSimulator<DDPackage>::getNumberOfQubits());
-                auto                           result        = SimulateSlicing(slice_dd, split_qubit, total_control);
-                slice_dd->addAmplitudes(result, thread_amplitudes, nqubits);
+    // sum up the buffers in parallel, each thread being responsible for the chunk it touched first
+    amplitudes[0].forEachChunk([&amplitudes](std::size_t first, std::size_t last) {
+        for (std::size_t buffer = 1; buffer < amplitudes.size(); ++buffer) {
+            std::transform(amplitudes[0].data() + first, amplitudes[0].data() + last, amplitudes[buffer].data() + first, amplitudes[0].data() + first, std::plus<>());
+        }
+    });
+    reduceAmplitudes(amplitudes[0].data(), amplitudes[0].size());
+    finalAmplitudes = std::move(amplitudes[0]);
+}
+
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::SimulateHybridSharedAmplitudes(dd::Qubit split_qubit) {
+    const auto         ndecisions  = getNDecisions(split_qubit);
+    const std::int64_t max_control = 1LL << ndecisions;
+
+    const int actuallyUsedThreads  = static_cast<std::size_t>(max_control) < nthreads ? static_cast<int>(max_control) : static_cast<int>(nthreads);
+    Simulator<DDPackage>::rootEdge = qc::VectorDD::zero;
+
+    const std::int64_t   nslices_on_one_cpu = largestPowerOfTwoUpTo(std::min<std::int64_t>(64, max_control / actuallyUsedThreads));
+    const dd::QubitCount nqubits            = CircuitSimulator<DDPackage>::getNumberOfQubits();
+    const std::size_t    dim                = 1ULL << nqubits;
+
+    // the previous result is released before the new one is allocated
+    finalAmplitudes = AmplitudeBuffer{};
+    finalAmplitudes = AmplitudeBuffer(dim, amplitudeFile, static_cast<unsigned int>(nthreads));
+
+    // the single output vector is partitioned into ranges guarded by their own mutex (a few per thread to keep contention low)
+    std::size_t nranges = 1;
+    while (nranges < 4U * static_cast<std::size_t>(actuallyUsedThreads) && nranges < dim) {
+        nranges *= 2;
+    }
+    const std::size_t       rangeLength = dim / nranges;
+    std::vector<std::mutex> rangeMutexes(nranges);
+
+    tf::Executor executor(static_cast<std::size_t>(actuallyUsedThreads));
+    runSliceBlocks(executor, nslices_on_one_cpu, [this, &rangeMutexes, nslices_on_one_cpu, split_qubit, dim, nranges, rangeLength](std::int64_t control) {
+        auto        slice_dd = std::make_unique<SliceDDPackage>(CircuitSimulator<DDPackage>::getNumberOfQubits());
+        std::size_t slice    = static_cast<std::size_t>(control);
+        SimulateSlices(slice_dd, split_qubit, static_cast<std::size_t>(control), static_cast<std::size_t>(nslices_on_one_cpu), [&](qc::VectorDD result) {
+            // visit the ranges starting at a slice-dependent offset and skip ranges that are currently being written to
+            std::vector<std::size_t> pending(nranges);
+            for (std::size_t r = 0; r < nranges; ++r) {
+                pending[r] = (r + slice) % nranges;
+            }
+            while (!pending.empty()) {
+                std::vector<std::size_t> busy;
+                for (const auto range: pending) {
+                    std::unique_lock<std::mutex> lock(rangeMutexes[range], std::try_to_lock);
+                    if (!lock.owns_lock()) {
+                        busy.push_back(range);
+                        continue;
+                    }
+                    addAmplitudesInRange(result, {1., 0.}, 0, dim, range * rangeLength, rangeLength, finalAmplitudes.data());
+                }
+                if (busy.size() == pending.size()) {
+                    // no progress was made, so wait for the first range instead of spinning
+                    std::lock_guard<std::mutex> lock(rangeMutexes[busy.front()]);
+                    addAmplitudesInRange(result, {1., 0.}, 0, dim, busy.front() * rangeLength, rangeLength, finalAmplitudes.data());
+                    busy.erase(busy.begin());
+                }
+                pending = std::move(busy);
             }
+            slice_dd->decRef(result);
+            slice_dd->garbageCollect();
+            ++slice;
         });
-    }
-    executor.wait_for_all();
+    });
+    reduceAmplitudes(finalAmplitudes.data(), finalAmplitudes.size());
+}
+
+template<class DDPackage, class SliceDDPackage>
+bool HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::isDistributed() const {
+#ifdef DDSIM_MPI
+    return communicator != MPI_COMM_NULL;
+#else
+    return false;
+#endif
+}
+
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::runSliceBlocks(tf::Executor& executor, std::int64_t blockSize, const std::function<void(std::int64_t)>& simulateBlock) {
+    const std::int64_t nslices = 1LL << usedDecisions;
+    localSlices                = 0;
+    // every slice belongs to exactly one block only if the blocks tile the slices
+    assert(blockSize > 0 && (blockSize & (blockSize - 1)) == 0 && blockSize <= nslices);
+
+    const auto simulateRange = [&](std::int64_t first, std::int64_t last) {
+        for (auto control = first; control < last; control += blockSize) {
+            executor.silent_async([&simulateBlock, control]() { simulateBlock(control); });
+        }
+        executor.wait_for_all();
+        localSlices += static_cast<std::size_t>(last - first);
+    };
 
-    std::size_t old_increment = 1;
-    for (unsigned short level = 0; level < static_cast<unsigned short>(std::log2(actuallyUsedThreads)); ++level) {
-        const int increment = 2 << level;
-        for (int idx = 0; idx < actuallyUsedThreads; idx += increment) {
-            // in-place addition of amplitudes
-            std::transform(amplitudes[idx].begin(), amplitudes[idx].end(),
-                           amplitudes[idx + old_increment].begin(),
-                           amplitudes[idx].begin(),
-                           std::plus<>());
+#ifdef DDSIM_MPI
+    if (isDistributed()) {
+        // every batch keeps all workers of this rank busy; the next one is fetched once they are done
+        SliceDistribution distribution(communicator, nslices, blockSize, static_cast<std::int64_t>(executor.num_workers()));
+        for (auto range = distribution.next(); range.first < range.second; range = distribution.next()) {
+            simulateRange(range.first, range.second);
         }
-        old_increment = increment;
+        return;
     }
-    finalAmplitudes = std::move(amplitudes[0]);
+#endif
+    simulateRange(0, nslices);
+}
+
+template<class DDPackage, class SliceDDPackage>
+void HybridSchrodingerFeynmanSimulator<DDPackage, SliceDDPackage>::reduceAmplitudes([[maybe_unused]] std::complex<dd::fp>* amplitudes, [[maybe_unused]] std::size_t size) {
+#ifdef DDSIM_MPI
+    if (!isDistributed()) {
+        return;
+    }
+    // a rank that was cancelled skipped some of its slices, so the others must not report the incomplete sum either
+    if (SliceDistribution::any(communicator, Simulator<DDPackage>::cancellationRequested())) {
+        Simulator<DDPackage>::cancel();
+        return;
+    }
+    SliceDistribution::allreduce(communicator, amplitudes, size);
+#endif
 }
 
-template class HybridSchrodingerFeynmanSimulator<dd::Package<>>;
+template class HybridSchrodingerFeynmanSimulator<dd::Package<>, HybridSlicePackage>;
+template class HybridSchrodingerFeynmanSimulator<dd::Package<>, dd::Package<>>;
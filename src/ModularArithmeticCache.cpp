@@ -0,0 +1,94 @@
+#include "ModularArithmeticCache.hpp"
+
+#include "dd/Export.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+ModularArithmeticCache& ModularArithmeticCache::instance() {
+    static ModularArithmeticCache cache;
+    return cache;
+}
+
+dd::mEdge ModularArithmeticCache::get(std::unique_ptr<dd::Package<>>& dd, Kind kind, unsigned long long modulus, unsigned long long constant, const std::function<dd::mEdge()>& build) {
+    if (!enabled) {
+        return build();
+    }
+
+    const Key key{kind, modulus, constant};
+    {
+        const std::lock_guard lock(mutex);
+        if (const auto it = entries.find(key); it != entries.end()) {
+            ++hits;
+            std::istringstream is(it->second);
+            return dd->deserialize<dd::mNode>(is, true);
+        }
+        ++misses;
+    }
+
+    // building may take long, so other simulators are not blocked meanwhile
+    const auto         edge = build();
+    std::ostringstream os;
+    dd::serialize(edge, os, true);
+    const std::lock_guard lock(mutex);
+    entries.emplace(key, os.str());
+    return edge;
+}
+
+void ModularArithmeticCache::clear() {
+    const std::lock_guard lock(mutex);
+    entries.clear();
+    hits   = 0;
+    misses = 0;
+}
+
+std::size_t ModularArithmeticCache::size() const {
+    const std::lock_guard lock(mutex);
+    return entries.size();
+}
+
+void ModularArithmeticCache::save(const std::string& directory) const {
+    std::filesystem::create_directories(directory);
+    const std::lock_guard lock(mutex);
+    for (const auto& [key, data]: entries) {
+        const auto& [kind, modulus, constant] = key;
+        const auto    file                    = std::filesystem::path(directory) / (std::to_string(static_cast<unsigned>(kind)) + "_" + std::to_string(modulus) + "_" + std::to_string(constant) + ".dd");
+        std::ofstream ofs(file, std::ios::binary);
+        if (!ofs.good()) {
+            throw std::runtime_error("Cannot open '" + file.string() + "' for writing.");
+        }
+        ofs.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+}
+
+std::size_t ModularArithmeticCache::load(const std::string& directory) {
+    if (!std::filesystem::is_directory(directory)) {
+        return 0;
+    }
+    std::size_t loaded = 0;
+    for (const auto& file: std::filesystem::directory_iterator(directory)) {
+        if (!file.is_regular_file() || file.path().extension() != ".dd") {
+            continue;
+        }
+        // files not following the naming scheme are skipped
+        unsigned           kind     = 0;
+        unsigned long long modulus  = 0;
+        unsigned long long constant = 0;
+        char               sep1     = 0;
+        char               sep2     = 0;
+        std::istringstream name(file.path().stem().string());
+        if (!(name >> kind >> sep1 >> modulus >> sep2 >> constant) || sep1 != '_' || sep2 != '_' || kind > static_cast<unsigned>(Kind::Multiplier)) {
+            continue;
+        }
+
+        std::ifstream      ifs(file.path(), std::ios::binary);
+        std::ostringstream data;
+        data << ifs.rdbuf();
+        const std::lock_guard lock(mutex);
+        entries[Key{static_cast<Kind>(kind), modulus, constant}] = data.str();
+        ++loaded;
+    }
+    return loaded;
+}
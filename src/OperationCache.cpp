@@ -0,0 +1,60 @@
+#include "OperationCache.hpp"
+
+template<class DDPackage>
+typename OperationCache<DDPackage>::Signature OperationCache<DDPackage>::signatureOf(const qc::Operation* op, bool inverse) {
+    std::vector<std::pair<dd::Qubit, dd::Control::Type>> controls;
+    controls.reserve(op->getControls().size());
+    for (const auto& control: op->getControls()) {
+        controls.emplace_back(control.qubit, control.type);
+    }
+    const auto& param = op->getParameter();
+    return {op->getType(), op->getNqubits(), op->getStartingQubit(), op->getTargets(), std::move(controls), {param[0], param[1], param[2]}, inverse};
+}
+
+template<class DDPackage>
+qc::MatrixDD OperationCache<DDPackage>::get(const qc::Operation* op, std::unique_ptr<DDPackage>& dd, bool inverse) {
+    // only standard operations are fully described by their signature
+    if (capacity == 0 || !op->isStandardOperation()) {
+        return dd::getDD(op, dd, inverse);
+    }
+
+    auto signature = signatureOf(op, inverse);
+    if (const auto it = entries.find(signature); it != entries.end()) {
+        ++hits;
+        return it->second;
+    }
+
+    ++misses;
+    auto opDD = dd::getDD(op, dd, inverse);
+    if (entries.size() < capacity) {
+        dd->incRef(opDD);
+        entries.emplace(std::move(signature), opDD);
+    }
+    return opDD;
+}
+
+template<class DDPackage>
+void OperationCache<DDPackage>::clear(std::unique_ptr<DDPackage>& dd) {
+    for (auto& [signature, opDD]: entries) {
+        dd->decRef(opDD);
+    }
+    entries.clear();
+}
+
+template<class DDPackage>
+void OperationCache<DDPackage>::erase(const qc::Operation* op, std::unique_ptr<DDPackage>& dd) {
+    if (!op->isStandardOperation()) {
+        return;
+    }
+    for (const bool inverse: {false, true}) {
+        if (const auto it = entries.find(signatureOf(op, inverse)); it != entries.end()) {
+            dd->decRef(it->second);
+            entries.erase(it);
+        }
+    }
+}
+
+template class OperationCache<dd::Package<>>;
+template class OperationCache<StochasticNoisePackage>;
+template class OperationCache<DensityMatrixPackage>;
+template class OperationCache<DeepCircuitPackage>;
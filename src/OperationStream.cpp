@@ -0,0 +1,174 @@
+#include "OperationStream.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+bool OperationQueue::push(std::unique_ptr<qc::Operation> op) {
+    std::unique_lock lock(mutex);
+    notFull.wait(lock, [this]() { return cancelled || ops.size() < capacity; });
+    if (cancelled) {
+        return false;
+    }
+    ops.emplace_back(std::move(op));
+    notEmpty.notify_one();
+    return true;
+}
+
+std::unique_ptr<qc::Operation> OperationQueue::pop() {
+    std::unique_lock lock(mutex);
+    notEmpty.wait(lock, [this]() { return closed || !ops.empty(); });
+    if (ops.empty()) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return nullptr;
+    }
+    auto op = std::move(ops.front());
+    ops.pop_front();
+    notFull.notify_one();
+    return op;
+}
+
+void OperationQueue::close() {
+    const std::lock_guard lock(mutex);
+    closed = true;
+    notEmpty.notify_all();
+}
+
+void OperationQueue::fail(std::exception_ptr exception) {
+    const std::lock_guard lock(mutex);
+    error  = std::move(exception);
+    closed = true;
+    notEmpty.notify_all();
+}
+
+void OperationQueue::cancel() {
+    const std::lock_guard lock(mutex);
+    cancelled = true;
+    ops.clear();
+    notFull.notify_all();
+}
+
+namespace {
+    std::string trim(const std::string& s) {
+        const auto first = std::find_if_not(s.begin(), s.end(), [](unsigned char c) { return std::isspace(c); });
+        const auto last  = std::find_if_not(s.rbegin(), s.rend(), [](unsigned char c) { return std::isspace(c); }).base();
+        return first < last ? std::string(first, last) : std::string{};
+    }
+
+    std::string keyword(const std::string& statement) {
+        const auto end = std::find_if(statement.begin(), statement.end(), [](unsigned char c) { return std::isspace(c) || c == '(' || c == ';' || c == '{'; });
+        return {statement.begin(), end};
+    }
+} // namespace
+
+QasmOperationReader::QasmOperationReader(std::istream& is, std::size_t chunkSize):
+    is(is), chunkSize(std::max<std::size_t>(chunkSize, 1U)) {
+    for (auto statement = readStatement(); !statement.empty(); statement = readStatement()) {
+        if (!isDeclaration(statement)) {
+            pendingStatement = statement;
+            break;
+        }
+        header += statement + "\n";
+    }
+}
+
+std::unique_ptr<qc::QuantumComputation> QasmOperationReader::circuit() const {
+    auto               qc = std::make_unique<qc::QuantumComputation>();
+    std::istringstream ss(header);
+    qc->import(ss, qc::OpenQASM);
+    return qc;
+}
+
+std::unique_ptr<qc::Operation> QasmOperationReader::next() {
+    while (ops.empty()) {
+        if (!readChunk()) {
+            return nullptr;
+        }
+    }
+    auto op = std::move(ops.front());
+    ops.pop_front();
+    return op;
+}
+
+std::string QasmOperationReader::readStatement() {
+    std::string statement;
+    std::size_t depth = 0;
+    char        c     = 0;
+    while (is.get(c)) {
+        if (c == '/' && is.peek() == '/') {
+            // comments may contain semicolons, so they are skipped entirely
+            is.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            statement += '\n';
+            continue;
+        }
+        statement += c;
+        if (c == '{') {
+            ++depth;
+        } else if (c == '}' && depth > 0 && --depth == 0) {
+            // end of the body of a gate definition
+            return trim(statement);
+        } else if (c == ';' && depth == 0) {
+            auto trimmed = trim(statement);
+            if (trimmed != ";") {
+                return trimmed;
+            }
+            statement.clear();
+        }
+    }
+    if (!trim(statement).empty()) {
+        throw std::invalid_argument("Incomplete statement at the end of the streamed circuit: " + trim(statement));
+    }
+    return {};
+}
+
+bool QasmOperationReader::readChunk() {
+    std::string body;
+    std::size_t statements = 0;
+    if (!pendingStatement.empty()) {
+        body += pendingStatement + "\n";
+        pendingStatement.clear();
+        ++statements;
+    }
+    while (statements < chunkSize) {
+        const auto statement = readStatement();
+        if (statement.empty()) {
+            break;
+        }
+        if (isDeclaration(statement)) {
+            if (isRegisterDeclaration(statement)) {
+                throw std::invalid_argument("Registers of a streamed circuit have to be declared before its first operation.");
+            }
+            // gate definitions precede their uses, so they can be prepended to this and all later chunks
+            header += statement + "\n";
+            continue;
+        }
+        body += statement + "\n";
+        ++statements;
+    }
+    if (statements == 0) {
+        return false;
+    }
+    statementsRead += statements;
+
+    qc::QuantumComputation chunk;
+    std::istringstream     ss(header + body);
+    chunk.import(ss, qc::OpenQASM);
+    for (auto& op: chunk) {
+        ops.emplace_back(std::move(op));
+    }
+    return true;
+}
+
+bool QasmOperationReader::isDeclaration(const std::string& statement) {
+    const auto word = keyword(statement);
+    return word == "OPENQASM" || word == "include" || word == "gate" || word == "opaque" || isRegisterDeclaration(statement);
+}
+
+bool QasmOperationReader::isRegisterDeclaration(const std::string& statement) {
+    const auto word = keyword(statement);
+    return word == "qreg" || word == "creg";
+}
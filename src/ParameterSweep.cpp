@@ -0,0 +1,118 @@
+#include "ParameterSweep.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+template<class DDPackage>
+std::vector<dd::fp> ParameterSweep<DDPackage>::parametersOf(const qc::QuantumComputation& other) const {
+    if (other.getNqubits() != circuit->getNqubits() || other.getNops() != circuit->getNops()) {
+        throw std::invalid_argument("The circuit does not match the template of the parameter sweep.");
+    }
+    const auto& templateCircuit = *circuit;
+    auto        op              = other.begin();
+    std::size_t i               = 0;
+    for (const auto& templateOp: templateCircuit) {
+        const auto& candidate = *op++;
+        if (templateOp->getType() != candidate->getType() || templateOp->getTargets() != candidate->getTargets() || templateOp->getControls() != candidate->getControls()) {
+            throw std::invalid_argument("Operation " + std::to_string(i) + " does not match the template of the parameter sweep.");
+        }
+        if (templateOp->getType() == qc::Measure) {
+            const auto* templateMeasure  = dynamic_cast<const qc::NonUnitaryOperation*>(templateOp.get());
+            const auto* candidateMeasure = dynamic_cast<const qc::NonUnitaryOperation*>(candidate.get());
+            if (templateMeasure == nullptr || candidateMeasure == nullptr || templateMeasure->getClassics() != candidateMeasure->getClassics()) {
+                throw std::invalid_argument("Measurement " + std::to_string(i) + " does not match the template of the parameter sweep.");
+            }
+        }
+        ++i;
+    }
+    // the types agree, so both circuits have the same number of parameters
+    return CircuitSimulator<DDPackage>::parametersOf(other);
+}
+
+template<class DDPackage>
+template<class Task>
+void ParameterSweep<DDPackage>::forEachParameterSet(const std::vector<std::vector<dd::fp>>& parameters, const Task& task) {
+    const auto nworkers = std::min(nthreads, std::max<std::size_t>(parameters.size(), 1U));
+    while (workers.size() < nworkers) {
+        auto copy = std::make_unique<qc::QuantumComputation>(circuit->clone());
+        if (seed.has_value()) {
+            workers.emplace_back(std::make_unique<CircuitSimulator<DDPackage>>(std::move(copy), seed.value() + workers.size()));
+        } else {
+            workers.emplace_back(std::make_unique<CircuitSimulator<DDPackage>>(std::move(copy)));
+        }
+    }
+
+    const auto work = [&](std::size_t w) {
+        for (std::size_t i = w; i < parameters.size(); i += nworkers) {
+            workers[w]->setParameters(parameters[i]);
+            task(*workers[w], i);
+        }
+    };
+    if (nworkers == 1U) {
+        work(0);
+    } else {
+        // the first exception of a worker is rethrown once all workers are done
+        std::vector<std::exception_ptr> errors(nworkers);
+        std::vector<std::thread>        threads;
+        for (std::size_t w = 0; w < nworkers; ++w) {
+            threads.emplace_back([&, w]() {
+                try {
+                    work(w);
+                } catch (...) {
+                    errors[w] = std::current_exception();
+                }
+            });
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+        for (const auto& error: errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+    parameterSets += parameters.size();
+}
+
+template<class DDPackage>
+std::vector<std::map<std::string, std::size_t>> ParameterSweep<DDPackage>::Simulate(const std::vector<std::vector<dd::fp>>& parameters, unsigned int shots) {
+    std::vector<std::map<std::string, std::size_t>> results(parameters.size());
+    forEachParameterSet(parameters, [&results, shots](CircuitSimulator<DDPackage>& sim, std::size_t i) {
+        results[i] = sim.Simulate(shots);
+    });
+    return results;
+}
+
+template<class DDPackage>
+std::vector<double> ParameterSweep<DDPackage>::ExpectationValues(const std::vector<std::vector<dd::fp>>& parameters, const PauliSum& observable) {
+    std::vector<double> results(parameters.size());
+    forEachParameterSet(parameters, [&results, &observable](CircuitSimulator<DDPackage>& sim, std::size_t i) {
+        sim.Simulate(0);
+        // the workers already run in parallel
+        results[i] = sim.expectationValue(observable, 1U);
+    });
+    return results;
+}
+
+template<class DDPackage>
+std::map<std::string, std::string> ParameterSweep<DDPackage>::AdditionalStatistics() const {
+    std::size_t hits   = 0;
+    std::size_t misses = 0;
+    for (const auto& worker: workers) {
+        auto stats = worker->AdditionalStatistics();
+        hits += std::stoull(stats["op_cache_hits"]);
+        misses += std::stoull(stats["op_cache_misses"]);
+    }
+    return {
+            {"workers", std::to_string(workers.size())},
+            {"parameter_sets", std::to_string(parameterSets)},
+            {"parameters", std::to_string(getNumberOfParameters())},
+            {"op_cache_hits", std::to_string(hits)},
+            {"op_cache_misses", std::to_string(misses)},
+    };
+}
+
+template class ParameterSweep<dd::Package<>>;
@@ -1,6 +1,13 @@
 #include "PathSimulator.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
 #include <iterator>
+#include <limits>
+#include <numeric>
+#include <mutex>
 #include <utility>
 
 template<class DDPackage>
@@ -98,7 +105,15 @@ PathSimulator<DDPackage>::SimulationPath::SimulationPath(std::size_t nleaves, Pa
 
 template<class DDPackage>
 std::map<std::string, std::size_t> PathSimulator<DDPackage>::Simulate(unsigned int shots) {
+    if (parallel) {
+        workerPackages.clear();
+        workerPackages.resize(executor.num_workers());
+        releaseQueues = std::vector<ReleaseQueue>(workerPackages.size() + 1U);
+    }
+    gcStates.assign(workerPackages.size() + 1U, {});
+
     // build task graph from simulation path
+    Simulator<DDPackage>::beginProgress(simulationPath.components.size());
     constructTaskGraph();
     //std::cout<< *qc << std::endl;
     /// Enable the following statements to generate a .dot file of the resulting taskflow
@@ -108,10 +123,74 @@ std::map<std::string, std::size_t> PathSimulator<DDPackage>::Simulate(unsigned i
     // perform simulation
     executor.run(taskflow).wait();
 
+    if (parallel) {
+        // the final state has been transferred to the package of the simulator, so the worker packages can be discarded as a whole
+        releaseQueuedEdges(mainPackage());
+        results.clear();
+        resultOwners.clear();
+        releaseQueues.clear();
+        workerPackages.clear();
+        Simulator<DDPackage>::dd->garbageCollect();
+    }
+    Simulator<DDPackage>::checkCancellation();
+
     // measure resulting DD
     return Simulator<DDPackage>::MeasureAllNonCollapsing(shots);
 }
 
+template<class DDPackage>
+std::unique_ptr<DDPackage>& PathSimulator<DDPackage>::getPackage(std::size_t owner) {
+    if (owner == mainPackage()) {
+        return Simulator<DDPackage>::dd;
+    }
+    auto& package = workerPackages.at(owner);
+    if (!package) {
+        package = std::make_unique<DDPackage>(CircuitSimulator<DDPackage>::getNumberOfQubits());
+    }
+    return package;
+}
+
+template<class DDPackage>
+typename PathSimulator<DDPackage>::Result PathSimulator<DDPackage>::acquireResult(std::size_t id, std::size_t owner) {
+    const auto& result = results.at(id);
+    const auto  source = resultOwners.at(id);
+    if (source == owner) {
+        return result;
+    }
+
+    // the result lives in the package of another thread: copy it to the local package and let the owner release the original
+    auto&      localDD     = getPackage(owner);
+    const auto copyToLocal = [&localDD](auto edge) -> Result {
+        auto copy = localDD->transfer(edge);
+        localDD->incRef(copy);
+        return copy;
+    };
+    auto transferred = std::visit(copyToLocal, result);
+    enqueueRelease(source, result);
+    return transferred;
+}
+
+template<class DDPackage>
+void PathSimulator<DDPackage>::enqueueRelease(std::size_t owner, const Result& result) {
+    auto&                       queue = releaseQueues.at(owner);
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.edges.emplace_back(result);
+}
+
+template<class DDPackage>
+void PathSimulator<DDPackage>::releaseQueuedEdges(std::size_t owner) {
+    auto&               queue = releaseQueues.at(owner);
+    std::vector<Result> edges{};
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        std::swap(edges, queue.edges);
+    }
+    auto& package = getPackage(owner);
+    for (const auto& edge: edges) {
+        std::visit([&package](const auto& e) { package->decRef(e); }, edge);
+    }
+}
+
 template<class DDPackage>
 void PathSimulator<DDPackage>::generateSequentialSimulationPath() {
     typename SimulationPath::Components components{};
@@ -287,6 +366,169 @@ void PathSimulator<DDPackage>::generateAlternatingSimulationPath(std::size_t sta
     setSimulationPath(components, true);
 }
 
+template<class DDPackage>
+void PathSimulator<DDPackage>::generateAutoSimulationPath(double timeLimit) {
+    const auto& qc      = CircuitSimulator<DDPackage>::qc;
+    const auto  nops    = qc->getNops();
+    const auto  nqubits = static_cast<std::size_t>(qc->getNqubits());
+    const auto  nleaves = nops + 1;
+
+    typename SimulationPath::Components components{};
+    if (nops == 0) {
+        setSimulationPath(components, true);
+        return;
+    }
+    components.reserve(nops);
+
+    const auto start = std::chrono::steady_clock::now();
+
+    // sizes are handled as doubles, the exponent is bounded to prevent overflows for large circuits
+    const auto pow2 = [](double exponent) { return std::exp2(std::min(exponent, 1000.)); };
+
+    std::vector<std::vector<dd::Qubit>> supports(nops);
+    for (std::size_t i = 0; i < nops; ++i) {
+        for (std::size_t q = 0; q < nqubits; ++q) {
+            if (qc->at(i)->actsOn(static_cast<dd::Qubit>(q))) {
+                supports[i].emplace_back(static_cast<dd::Qubit>(q));
+            }
+        }
+    }
+
+    // estimated size of the state after the first t operations. Qubits connected by multi-qubit operations form blocks
+    // and each block of k qubits is assumed to require a full DD with 2^k - 1 nodes.
+    std::vector<double>      vectorSize(nleaves);
+    std::vector<std::size_t> block(nqubits);
+    std::vector<std::size_t> blockSize(nqubits, 1U);
+    std::iota(block.begin(), block.end(), 0U);
+    const auto findBlock = [&block](std::size_t q) {
+        while (block[q] != q) {
+            block[q] = block[block[q]];
+            q        = block[q];
+        }
+        return q;
+    };
+    double blockNodes = static_cast<double>(nqubits);
+    vectorSize[0]     = blockNodes;
+    for (std::size_t i = 0; i < nops; ++i) {
+        for (std::size_t j = 1; j < supports[i].size(); ++j) {
+            const auto a = findBlock(static_cast<std::size_t>(supports[i][0]));
+            const auto b = findBlock(static_cast<std::size_t>(supports[i][j]));
+            if (a == b) {
+                continue;
+            }
+            blockNodes -= pow2(static_cast<double>(blockSize[a])) - 1. + pow2(static_cast<double>(blockSize[b])) - 1.;
+            block[b] = a;
+            blockSize[a] += blockSize[b];
+            blockNodes += pow2(static_cast<double>(blockSize[a])) - 1.;
+        }
+        vectorSize[i + 1] = std::min(blockNodes, pow2(static_cast<double>(nqubits)) - 1.);
+    }
+
+    std::vector<std::size_t> bestSplits{};
+    std::vector<std::size_t> bestSegments{};
+    std::size_t              bestLength = 0;
+
+    // the tables grow with nops * maxLength, which is bounded to keep the memory footprint of the planner reasonable
+    constexpr std::size_t MAX_TABLE_ENTRIES = 1ULL << 22U;
+    for (std::size_t maxLength = 1; maxLength <= nops; maxLength *= 2) {
+        const auto iterationStart = std::chrono::steady_clock::now();
+        if (maxLength > 1 && nops * maxLength > MAX_TABLE_ENTRIES) {
+            break;
+        }
+
+        // estimated size, construction cost, and best split of the matrix of the operations [a, a + len)
+        const auto               index = [maxLength](std::size_t a, std::size_t len) { return a * maxLength + len - 1; };
+        std::vector<double>      matrixSize(nops * maxLength, 0.);
+        std::vector<double>      matrixCost(nops * maxLength, 0.);
+        std::vector<std::size_t> splits(nops * maxLength, 0U);
+
+        for (std::size_t a = 0; a < nops; ++a) {
+            std::vector<bool> used(nqubits, false);
+            std::size_t       k             = 0;
+            std::size_t       multiQubitOps = 0;
+            for (std::size_t len = 1; len <= maxLength && a + len <= nops; ++len) {
+                const auto& support = supports[a + len - 1];
+                for (const auto q: support) {
+                    if (!used[static_cast<std::size_t>(q)]) {
+                        used[static_cast<std::size_t>(q)] = true;
+                        ++k;
+                    }
+                }
+                if (support.size() > 1) {
+                    ++multiQubitOps;
+                }
+                // identities on the remaining qubits contribute a single node each
+                matrixSize[index(a, len)] = pow2(2. * static_cast<double>(std::min(k, multiQubitOps + 1))) + static_cast<double>(nqubits - k);
+            }
+        }
+
+        for (std::size_t len = 2; len <= maxLength; ++len) {
+            for (std::size_t a = 0; a + len <= nops; ++a) {
+                double best = std::numeric_limits<double>::infinity();
+                for (std::size_t c = 1; c < len; ++c) {
+                    const double cost = matrixCost[index(a, c)] + matrixCost[index(a + c, len - c)] + matrixSize[index(a, c)] * matrixSize[index(a + c, len - c)];
+                    if (cost < best) {
+                        best                  = cost;
+                        splits[index(a, len)] = c;
+                    }
+                }
+                matrixCost[index(a, len)] = best;
+            }
+        }
+
+        // cheapest way to obtain the state after the first t operations, where the last segment is applied via MxV
+        std::vector<double>      stateCost(nleaves, std::numeric_limits<double>::infinity());
+        std::vector<std::size_t> segments(nleaves, 1U);
+        stateCost[0] = 0.;
+        for (std::size_t t = 1; t <= nops; ++t) {
+            for (std::size_t len = 1; len <= std::min(maxLength, t); ++len) {
+                const auto   a    = t - len;
+                const double cost = stateCost[a] + matrixCost[index(a, len)] + matrixSize[index(a, len)] * vectorSize[a];
+                if (cost < stateCost[t]) {
+                    stateCost[t] = cost;
+                    segments[t]  = len;
+                }
+            }
+        }
+
+        bestSplits   = std::move(splits);
+        bestSegments = std::move(segments);
+        bestLength   = maxLength;
+
+        // the effort grows quadratically in the maximal segment length, so stop if the next iteration is not expected to finish in time
+        const auto now       = std::chrono::steady_clock::now();
+        const auto elapsed   = std::chrono::duration<double>(now - start).count();
+        const auto iteration = std::chrono::duration<double>(now - iterationStart).count();
+        if (elapsed + 4. * iteration > timeLimit) {
+            break;
+        }
+    }
+
+    const std::function<std::size_t(std::size_t, std::size_t)> buildMatrix = [&](std::size_t a, std::size_t len) -> std::size_t {
+        if (len == 1) {
+            // operation IDs start at 1
+            return a + 1;
+        }
+        const auto c     = bestSplits[a * bestLength + len - 1];
+        const auto left  = buildMatrix(a, c);
+        const auto right = buildMatrix(a + c, len - c);
+        components.emplace_back(left, right);
+        return nleaves + components.size() - 1;
+    };
+
+    std::vector<std::pair<std::size_t, std::size_t>> segments{};
+    for (std::size_t t = nops; t > 0; t -= bestSegments[t]) {
+        segments.emplace_back(t - bestSegments[t], bestSegments[t]);
+    }
+    std::size_t state = 0;
+    for (auto it = segments.rbegin(); it != segments.rend(); ++it) {
+        const auto matrix = buildMatrix(it->first, it->second);
+        components.emplace_back(state, matrix);
+        state = nleaves + components.size() - 1;
+    }
+    setSimulationPath(components, true);
+}
+
 template<class DDPackage>
 void PathSimulator<DDPackage>::constructTaskGraph() {
     const auto& path  = simulationPath.components;
@@ -299,6 +541,9 @@ void PathSimulator<DDPackage>::constructTaskGraph() {
 
     const std::size_t nleaves = CircuitSimulator<DDPackage>::qc->getNops() + 1;
 
+    results.assign(steps.size(), Result{});
+    resultOwners.assign(steps.size(), mainPackage());
+
     for (std::size_t i = 0; i < path.size(); ++i) {
         const auto [leftID, rightID] = path.at(i);
         const auto& resultStep       = steps.at(nleaves + i);
@@ -309,12 +554,12 @@ void PathSimulator<DDPackage>::constructTaskGraph() {
                 // initial state
                 qc::VectorDD zeroState = Simulator<DDPackage>::dd->makeZeroState(CircuitSimulator<DDPackage>::qc->getNqubits());
                 Simulator<DDPackage>::dd->incRef(zeroState);
-                results.emplace(leftID, zeroState);
+                results.at(leftID) = zeroState;
             } else {
                 const auto&  op   = CircuitSimulator<DDPackage>::qc->at(leftID - 1);
-                qc::MatrixDD opDD = dd::getDD(op.get(), Simulator<DDPackage>::dd);
+                qc::MatrixDD opDD = CircuitSimulator<DDPackage>::op_cache.get(op.get(), Simulator<DDPackage>::dd);
                 Simulator<DDPackage>::dd->incRef(opDD);
-                results.emplace(leftID, opDD);
+                results.at(leftID) = opDD;
             }
         }
 
@@ -323,9 +568,9 @@ void PathSimulator<DDPackage>::constructTaskGraph() {
                 throw std::runtime_error("Initial state must not appear on right side of the simulation path member.");
             } else {
                 const auto&  op   = CircuitSimulator<DDPackage>::qc->at(rightID - 1);
-                qc::MatrixDD opDD = dd::getDD(op.get(), Simulator<DDPackage>::dd);
+                qc::MatrixDD opDD = CircuitSimulator<DDPackage>::op_cache.get(op.get(), Simulator<DDPackage>::dd);
                 Simulator<DDPackage>::dd->incRef(opDD);
-                results.emplace(rightID, opDD);
+                results.at(rightID) = opDD;
             }
         }
 
@@ -348,8 +593,18 @@ void PathSimulator<DDPackage>::constructTaskGraph() {
         // add final task for storing the result
         if (i == path.size() - 1) {
             const auto runner = [this, resultStep]() {
+                if (Simulator<DDPackage>::cancellationRequested()) {
+                    return;
+                }
                 if (auto res = std::get_if<qc::VectorDD>(&results.at(resultStep.id))) {
-                    Simulator<DDPackage>::rootEdge = *res;
+                    if (resultOwners.at(resultStep.id) == mainPackage()) {
+                        Simulator<DDPackage>::rootEdge = *res;
+                    } else {
+                        // all other tasks have finished at this point, so the package of the simulator may be modified
+                        auto edge                      = *res;
+                        Simulator<DDPackage>::rootEdge = Simulator<DDPackage>::dd->transfer(edge);
+                        Simulator<DDPackage>::dd->incRef(Simulator<DDPackage>::rootEdge);
+                    }
                 } else {
                     throw std::runtime_error("Expected vector DD as result.");
                 }
@@ -366,8 +621,18 @@ void PathSimulator<DDPackage>::addSimulationTask(std::size_t leftID, std::size_t
     const auto runner = [this, leftID, rightID, resultID]() {
         /// Enable the following statement for printing execution order
         //            std::cout << "Executing " << leftID << " " << rightID << " -> " << resultID << std::endl;
-        const auto& leftDD  = results.at(leftID);
-        const auto& rightDD = results.at(rightID);
+        // once cancelled, the remaining steps are skipped and Simulate throws after the task graph has finished
+        if (Simulator<DDPackage>::cancellationRequested()) {
+            return;
+        }
+        const std::size_t owner   = parallel ? static_cast<std::size_t>(executor.this_worker_id()) : mainPackage();
+        auto&             localDD = getPackage(owner);
+        if (parallel) {
+            releaseQueuedEdges(owner);
+        }
+
+        const auto leftDD  = acquireResult(leftID, owner);
+        const auto rightDD = acquireResult(rightID, owner);
 
         const auto leftIsVector  = std::holds_alternative<qc::VectorDD>(leftDD);
         const auto rightIsVector = std::holds_alternative<qc::VectorDD>(rightDD);
@@ -380,24 +645,26 @@ void PathSimulator<DDPackage>::addSimulationTask(std::size_t leftID, std::size_t
             // matrix-vector multiplication
             const auto& vector   = *std::get_if<qc::VectorDD>(&leftDD);
             const auto& matrix   = *std::get_if<qc::MatrixDD>(&rightDD);
-            auto        resultDD = Simulator<DDPackage>::dd->multiply(matrix, vector);
-            Simulator<DDPackage>::dd->incRef(resultDD);
-            Simulator<DDPackage>::dd->decRef(vector);
-            Simulator<DDPackage>::dd->decRef(matrix);
-            results.emplace(resultID, resultDD);
+            auto        resultDD = localDD->multiply(matrix, vector);
+            localDD->incRef(resultDD);
+            localDD->decRef(vector);
+            localDD->decRef(matrix);
+            results.at(resultID) = resultDD;
         } else {
             // matrix-matrix multiplication
             const auto& leftMatrix  = *std::get_if<qc::MatrixDD>(&leftDD);
             const auto& rightMatrix = *std::get_if<qc::MatrixDD>(&rightDD);
-            auto        resultDD    = Simulator<DDPackage>::dd->multiply(rightMatrix, leftMatrix);
-            Simulator<DDPackage>::dd->incRef(resultDD);
-            Simulator<DDPackage>::dd->decRef(leftMatrix);
-            Simulator<DDPackage>::dd->decRef(rightMatrix);
-            results.emplace(resultID, resultDD);
+            auto        resultDD    = localDD->multiply(rightMatrix, leftMatrix);
+            localDD->incRef(resultDD);
+            localDD->decRef(leftMatrix);
+            localDD->decRef(rightMatrix);
+            results.at(resultID) = resultDD;
         }
-        Simulator<DDPackage>::dd->garbageCollect();
-        results.erase(leftID);
-        results.erase(rightID);
+        resultOwners.at(resultID) = owner;
+        Simulator<DDPackage>::collectGarbage(localDD, gcStates.at(owner));
+        Simulator<DDPackage>::advanceProgress(localDD);
+        results.at(leftID)  = Result{};
+        results.at(rightID) = Result{};
     };
 
     const auto resultTask = taskflow.emplace(runner).name(std::to_string(resultID));
@@ -405,3 +672,4 @@ void PathSimulator<DDPackage>::addSimulationTask(std::size_t leftID, std::size_t
 }
 
 template class PathSimulator<dd::Package<>>;
+template class PathSimulator<DeepCircuitPackage>;
@@ -1,5 +1,7 @@
 #include "ShorFastSimulator.hpp"
 
+#include "ModularArithmeticCache.hpp"
+
 #include <chrono>
 #include <cmath>
 #include <dd/ComplexNumbers.hpp>
@@ -11,11 +13,17 @@ std::map<std::string, std::size_t> ShorFastSimulator::Simulate([[maybe_unused]]
     if (verbose) {
         std::clog << "Simulate Shor's algorithm for n=" << n;
     }
-    rootEdge = dd->makeZeroState(n_qubits);
-    dd->incRef(rootEdge);
-    //Initialize qubits
-    //TODO: other init method where the initial value can be chosen
-    ApplyGate(dd::Xmat, 0);
+    // a checkpoint holds the state after the first opIndex iterations together with their measurement results
+    const auto checkpoint = restoreCheckpoint();
+    if (checkpoint.has_value()) {
+        coprime_a = static_cast<unsigned int>(checkpoint->extra.at(0));
+    } else {
+        rootEdge = dd->makeZeroState(n_qubits);
+        dd->incRef(rootEdge);
+        //Initialize qubits
+        //TODO: other init method where the initial value can be chosen
+        ApplyGate(dd::Xmat, 0);
+    }
 
     if (verbose) {
         std::clog << " (requires " << +n_qubits << " qubits):\n";
@@ -49,7 +57,17 @@ std::map<std::string, std::size_t> ShorFastSimulator::Simulate([[maybe_unused]]
     auto        t1 = std::chrono::steady_clock::now();
     std::string measurements(2 * required_bits, '0');
 
-    for (unsigned int i = 0; i < 2 * required_bits; i++) {
+    std::size_t first_iteration = 0;
+    if (checkpoint.has_value()) {
+        first_iteration = checkpoint->opIndex;
+        for (const auto& [bit, value]: checkpoint->classicValues) {
+            measurements.at(bit) = value ? '1' : '0';
+        }
+    }
+
+    for (unsigned int i = first_iteration; i < 2 * required_bits; i++) {
+        const auto span           = traceBegin(dd, rootEdge);
+        const auto iterationStart = std::chrono::steady_clock::now();
         ApplyGate(dd::Hmat, n_qubits - 1);
 
         if (verbose) {
@@ -57,7 +75,9 @@ std::map<std::string, std::size_t> ShorFastSimulator::Simulate([[maybe_unused]]
                       << std::chrono::duration<float>(std::chrono::steady_clock::now() - t1).count() << "\n"
                       << std::flush;
         }
+        const auto emulationStart = std::chrono::steady_clock::now();
         u_a_emulate2(as[i]);
+        const auto emulationTime = std::chrono::duration<float>(std::chrono::steady_clock::now() - emulationStart).count();
 
         if (verbose) {
             std::clog << "[ " << i + 1 << "/" << 2 * required_bits << " ] QFT Pass. dd size=" << dd->size(rootEdge)
@@ -83,7 +103,22 @@ std::map<std::string, std::size_t> ShorFastSimulator::Simulate([[maybe_unused]]
         if (measurements[i] == '1') {
             ApplyGate(dd::Xmat, n_qubits - 1);
         }
+        traceEnd(span, dd, rootEdge, i, "iteration");
+        if (verbose) {
+            std::clog << "[ " << i + 1 << "/" << 2 * required_bits << " ] iteration took "
+                      << std::chrono::duration<float>(std::chrono::steady_clock::now() - iterationStart).count()
+                      << "s (u_a_emulate2: " << emulationTime << "s)\n";
+        }
+
+        if (checkpointDue()) {
+            std::map<std::size_t, bool> measured;
+            for (unsigned int j = 0; j <= i; j++) {
+                measured[j] = measurements[j] == '1';
+            }
+            writeCheckpoint(i + 1, measured, 0, 1., {coprime_a});
+        }
     }
+    checkpoint_writer.wait();
 
     delete[] as;
 
@@ -341,7 +376,6 @@ void ShorFastSimulator::ApplyGate(dd::GateMatrix matrix, dd::Qubit target) {
 
 void ShorFastSimulator::u_a_emulate2(unsigned long long int a) {
     [[maybe_unused]] const std::size_t cache_count_before = dd->cn.cacheCount();
-    dag_edges.clear();
 
     dd::vEdge                        f = dd::vEdge::one;
     std::array<dd::vEdge, dd::RADIX> edges{
@@ -357,15 +391,20 @@ void ShorFastSimulator::u_a_emulate2(unsigned long long int a) {
 
     dd->incRef(f);
 
+    // the maps keep their buckets across the iterations of Simulate
     for (auto& m: nodesOnLevel) {
-        m = std::map<dd::vNode*, dd::vEdge>();
+        m.clear();
     }
 
     u_a_emulate2_rec(rootEdge.p->e[0]);
 
     //dd->setMode(dd::Matrix);
 
-    for (const auto& entry: nodesOnLevel.at(0)) {
+    // all nodes on a level are multiplied with the same adder, which is hence built only once per level
+    auto& cache = ModularArithmeticCache::instance();
+    auto  adder = cache.get(dd, ModularArithmeticCache::Kind::AddConstMod, n, ts[0], [this]() { return addConstMod(ts[0]); });
+    dd->incRef(adder);
+    for (auto& entry: nodesOnLevel.at(0)) {
         dd::vEdge left = f;
         if (entry.first->e[0].w == dd::Complex::zero) {
             left = dd::vEdge::zero;
@@ -373,7 +412,7 @@ void ShorFastSimulator::u_a_emulate2(unsigned long long int a) {
             left.w = dd->cn.mulCached(left.w, entry.first->e[0].w);
         }
 
-        dd::vEdge right = dd->multiply(addConstMod(ts[entry.first->v]), f);
+        dd::vEdge right = dd->multiply(adder, f);
 
         if (entry.first->e[1].w == dd::Complex::zero) {
             right = dd::vEdge::zero;
@@ -392,21 +431,24 @@ void ShorFastSimulator::u_a_emulate2(unsigned long long int a) {
 
         dd->incRef(result);
 
-        nodesOnLevel[0][entry.first] = result;
+        entry.second = result;
     }
+    dd->decRef(adder);
 
     for (int i = 1; i < n_qubits - 1; i++) {
-        std::vector<dd::vEdge> saveEdges;
+        const auto t = ts.at(static_cast<std::size_t>(i));
+        adder        = cache.get(dd, ModularArithmeticCache::Kind::AddConstMod, n, t, [this, t]() { return addConstMod(t); });
+        dd->incRef(adder);
         for (auto it = nodesOnLevel.at(i).begin(); it != nodesOnLevel.at(i).end(); it++) {
             dd::vEdge left = dd::vEdge::zero;
             if (it->first->e.at(0).w != dd::Complex::zero) {
-                left   = nodesOnLevel.at(i - 1)[it->first->e.at(0).p];
+                left   = nodesOnLevel.at(i - 1).at(it->first->e.at(0).p);
                 left.w = dd->cn.mulCached(left.w, it->first->e.at(0).w);
             }
 
             dd::vEdge right = dd::vEdge::zero;
             if (it->first->e.at(1).w != dd::Complex::zero) {
-                right   = dd->multiply(addConstMod(ts.at(it->first->v)), nodesOnLevel.at(i - 1)[it->first->e.at(1).p]);
+                right   = dd->multiply(adder, nodesOnLevel.at(i - 1).at(it->first->e.at(1).p));
                 right.w = dd->cn.mulCached(right.w, it->first->e.at(1).w);
             }
 
@@ -420,14 +462,13 @@ void ShorFastSimulator::u_a_emulate2(unsigned long long int a) {
             }
 
             dd->incRef(result);
-            nodesOnLevel.at(i)[it->first] = result;
-            saveEdges.push_back(result);
+            it->second = result;
         }
+        dd->decRef(adder);
         for (auto& it: nodesOnLevel.at(i - 1)) {
             dd->decRef(it.second);
         }
         dd->garbageCollect();
-        saveEdges.push_back(rootEdge);
         nodesOnLevel.at(i - 1).clear();
     }
 
@@ -435,7 +476,7 @@ void ShorFastSimulator::u_a_emulate2(unsigned long long int a) {
         throw std::runtime_error("error occurred");
     }
 
-    dd::vEdge result = nodesOnLevel.at(n_qubits - 2)[rootEdge.p->e[0].p];
+    dd::vEdge result = nodesOnLevel.at(n_qubits - 2).at(rootEdge.p->e[0].p);
 
     dd->decRef(result);
 
@@ -459,10 +500,16 @@ void ShorFastSimulator::u_a_emulate2(unsigned long long int a) {
 }
 
 void ShorFastSimulator::u_a_emulate2_rec(dd::vEdge e) {
-    if (e.isTerminal() || nodesOnLevel.at(e.p->v).find(e.p) != nodesOnLevel.at(e.p->v).end()) {
-        return;
+    // iterative DFS, so deep states cannot overflow the stack; the stack is reused across calls
+    dfsStack.clear();
+    dfsStack.push_back(e);
+    while (!dfsStack.empty()) {
+        const auto cur = dfsStack.back();
+        dfsStack.pop_back();
+        if (cur.isTerminal() || !nodesOnLevel.at(cur.p->v).emplace(cur.p, dd::vEdge::zero).second) {
+            continue;
+        }
+        dfsStack.push_back(cur.p->e[1]);
+        dfsStack.push_back(cur.p->e[0]);
     }
-    nodesOnLevel.at(e.p->v)[e.p] = dd::vEdge::zero;
-    u_a_emulate2_rec(e.p->e[0]);
-    u_a_emulate2_rec(e.p->e[1]);
 }
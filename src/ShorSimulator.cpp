@@ -1,7 +1,9 @@
 #include "ShorSimulator.hpp"
 
+#include "ModularArithmeticCache.hpp"
 #include "dd/ComplexNumbers.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <cmath>
 #include <iostream>
@@ -13,8 +15,17 @@ std::map<std::string, std::size_t> ShorSimulator::Simulate([[maybe_unused]] unsi
         std::clog << "Simulate Shor's algorithm for n=" << n;
     }
 
-    if (emulate) {
-        n_qubits = 3 * required_bits;
+    n_qubits = emulate ? 3 * required_bits : 2 * required_bits + 3;
+
+    // a checkpoint counts the modular exponentiations and QFT passes that are already applied to its state
+    std::size_t step       = 0;
+    const auto  checkpoint = restoreCheckpoint();
+    if (checkpoint.has_value()) {
+        step               = checkpoint->opIndex;
+        coprime_a          = static_cast<unsigned int>(checkpoint->extra.at(0));
+        approximation_runs = checkpoint->approximationRuns;
+        final_fidelity     = checkpoint->fidelity;
+    } else if (emulate) {
         rootEdge = dd->makeZeroState(n_qubits);
         dd->incRef(rootEdge);
         //Initialize qubits
@@ -22,7 +33,6 @@ std::map<std::string, std::size_t> ShorSimulator::Simulate([[maybe_unused]] unsi
         ApplyGate(dd::Xmat, 0);
 
     } else {
-        n_qubits = 2 * required_bits + 3;
         rootEdge = dd->makeZeroState(n_qubits);
         dd->incRef(rootEdge);
         //Initialize qubits
@@ -60,29 +70,43 @@ std::map<std::string, std::size_t> ShorSimulator::Simulate([[maybe_unused]] unsi
         as[i] = new_a;
     }
 
-    for (unsigned int i = 0; i < 2 * required_bits; i++) {
-        ApplyGate(dd::Hmat, (n_qubits - 1) - i);
+    if (!checkpoint.has_value()) {
+        for (unsigned int i = 0; i < 2 * required_bits; i++) {
+            ApplyGate(dd::Hmat, (n_qubits - 1) - i);
+        }
     }
     const int mod = std::ceil(2 * required_bits / 6.0); // log_0.9(0.5) is about 6
     auto      t1  = std::chrono::steady_clock::now();
 
+    const auto checkpoint_step = [this](std::size_t completed) {
+        if (checkpointDue()) {
+            writeCheckpoint(completed, {}, approximation_runs, static_cast<double>(final_fidelity), {coprime_a});
+        }
+    };
+
     if (emulate) {
-        for (unsigned int i = 0; i < 2 * required_bits; i++) {
+        for (unsigned int i = step; i < 2 * required_bits; i++) {
             if (verbose) {
                 std::clog << "[ " << (i + 1) << "/" << 2 * required_bits << " ] u_a_emulate(" << as[i] << ", " << i
                           << ") " << std::chrono::duration<float>(std::chrono::steady_clock::now() - t1).count() << "\n"
                           << std::flush;
             }
+            const auto span = traceBegin(dd, rootEdge);
             u_a_emulate(as[i], i);
+            traceEnd(span, dd, rootEdge, i, "u_a_emulate");
+            checkpoint_step(i + 1);
         }
     } else {
-        for (unsigned int i = 0; i < 2 * required_bits; i++) {
+        for (unsigned int i = step; i < 2 * required_bits; i++) {
             if (verbose) {
                 std::clog << "[ " << (i + 1) << "/" << 2 * required_bits << " ] u_a(" << as[i] << ", " << n << ", " << 0
                           << ") " << std::chrono::duration<float>(std::chrono::steady_clock::now() - t1).count() << "\n"
                           << std::flush;
             }
+            const auto span = traceBegin(dd, rootEdge);
             u_a(as[i], n, 0);
+            traceEnd(span, dd, rootEdge, i, "u_a");
+            checkpoint_step(i + 1);
         }
     }
 
@@ -91,12 +115,14 @@ std::map<std::string, std::size_t> ShorSimulator::Simulate([[maybe_unused]] unsi
     }
 
     //EXACT QFT
-    for (unsigned int i = 0; i < 2 * required_bits; i++) {
+    const std::size_t first_qft_pass = std::max<std::size_t>(step, 2 * required_bits) - 2 * required_bits;
+    for (unsigned int i = first_qft_pass; i < 2 * required_bits; i++) {
         if (verbose) {
             std::clog << "[ " << i + 1 << "/" << 2 * required_bits << " ] QFT Pass. dd size=" << dd->size(rootEdge)
                       << "\n";
         }
-        double q = 2;
+        const auto span = traceBegin(dd, rootEdge);
+        double     q    = 2;
 
         for (int j = i - 1; j >= 0; j--) {
             double         q_r = QMDDcos(1, -q);
@@ -112,7 +138,10 @@ std::map<std::string, std::size_t> ShorSimulator::Simulate([[maybe_unused]] unsi
         }
 
         ApplyGate(dd::Hmat, n_qubits - 1 - i);
+        traceEnd(span, dd, rootEdge, 2 * required_bits + i, "qft_pass");
+        checkpoint_step(2 * required_bits + i + 1);
     }
+    checkpoint_writer.wait();
 
     delete[] as;
 
@@ -410,7 +439,7 @@ dd::mEdge ShorSimulator::limitStateVector(dd::vEdge e) {
     return result;
 }
 
-void ShorSimulator::u_a_emulate(unsigned long long a, int q) {
+dd::mEdge ShorSimulator::multiplier(unsigned long long a) {
     dd::mEdge limit = dd->makeIdent(0, required_bits - 1);
 
     dd::mEdge                f = dd::mEdge::one;
@@ -454,7 +483,7 @@ void ShorSimulator::u_a_emulate(unsigned long long a, int q) {
         active.w          = dd::Complex::one;
         active            = dd->multiply(f, active);
 
-        dd::mEdge tmp = addConstMod(t);
+        dd::mEdge tmp = ModularArithmeticCache::instance().get(dd, ModularArithmeticCache::Kind::AddConstMod, n, t, [this, t]() { return addConstMod(t); });
         active        = dd->multiply(tmp, active);
 
         dd->decRef(f);
@@ -467,8 +496,17 @@ void ShorSimulator::u_a_emulate(unsigned long long a, int q) {
 
     dd->decRef(limit);
     dd->decRef(f);
+    return f;
+}
+
+void ShorSimulator::u_a_emulate(unsigned long long a, int q) {
+    dd::mEdge e = ModularArithmeticCache::instance().get(dd, ModularArithmeticCache::Kind::Multiplier, n, a, [this, a]() { return multiplier(a); });
 
-    dd::mEdge e = f;
+    std::array<dd::mEdge, 4> edges{
+            dd::mEdge::zero,
+            dd::mEdge::zero,
+            dd::mEdge::zero,
+            dd::mEdge::zero};
 
     for (int i = 2 * required_bits - 1; i >= 0; --i) {
         if (i == q) {
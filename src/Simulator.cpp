@@ -1,31 +1,79 @@
 #include "Simulator.hpp"
 
+#include "dd/Export.hpp"
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <numeric>
 #include <queue>
-#include <set>
+#include <sstream>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 
 using CN = dd::ComplexNumbers;
 
+namespace {
+    // in-place prefix-sum calculation of probabilities, returns the total probability of the range
+    dd::fp prefixSumsOfProbabilities(std::complex<dd::fp>* first, std::complex<dd::fp>* last) {
+        std::inclusive_scan(
+                first, last, first,
+                [](const std::complex<dd::fp>& prefix, const std::complex<dd::fp>& value) {
+                    return std::complex<dd::fp>{std::fma(value.real(), value.real(), std::fma(value.imag(), value.imag(), prefix.real())), value.imag()};
+                },
+                std::complex<dd::fp>{0., 0.});
+        return first == last ? 0. : (last - 1)->real();
+    }
+} // namespace
+
 template<class DDPackage>
 std::map<std::string, std::size_t> Simulator<DDPackage>::SampleFromAmplitudeVectorInPlace(std::vector<std::complex<dd::fp>>& amplitudes, unsigned int shots) {
-    // in-place prefix-sum calculation of probabilities
-    std::inclusive_scan(
-            amplitudes.begin(), amplitudes.end(), amplitudes.begin(),
-            [](const std::complex<dd::fp>& prefix, const std::complex<dd::fp>& value) {
-                return std::complex<dd::fp>{std::fma(value.real(), value.real(), std::fma(value.imag(), value.imag(), prefix.real())), value.imag()};
-            },
-            std::complex<dd::fp>{0., 0.});
+    prefixSumsOfProbabilities(amplitudes.data(), amplitudes.data() + amplitudes.size());
+    return SampleFromProbabilityPrefixSums(amplitudes.data(), amplitudes.size(), shots);
+}
+
+template<class DDPackage>
+std::map<std::string, std::size_t> Simulator<DDPackage>::SampleFromAmplitudeVectorInPlace(AmplitudeBuffer& amplitudes, unsigned int shots) {
+    // every chunk is scanned on its own and then shifted by the total probability of the chunks before it
+    std::mutex                    totalsMutex;
+    std::map<std::size_t, dd::fp> offsets;
+    amplitudes.forEachChunk([&](std::size_t first, std::size_t last) {
+        const auto total = prefixSumsOfProbabilities(amplitudes.data() + first, amplitudes.data() + last);
+        const std::lock_guard lock(totalsMutex);
+        offsets[first] = total;
+    });
+    dd::fp offset = 0.;
+    for (auto& [first, total]: offsets) {
+        offset += std::exchange(total, offset);
+    }
+    amplitudes.forEachChunk([&](std::size_t first, std::size_t last) {
+        const auto chunkOffset = offsets.at(first);
+        if (chunkOffset != 0.) {
+            std::for_each(amplitudes.data() + first, amplitudes.data() + last, [chunkOffset](std::complex<dd::fp>& c) { c.real(c.real() + chunkOffset); });
+        }
+    });
+    return SampleFromProbabilityPrefixSums(amplitudes.data(), amplitudes.size(), shots);
+}
 
+template<class DDPackage>
+std::map<std::string, std::size_t> Simulator<DDPackage>::SampleFromProbabilityPrefixSums(const std::complex<dd::fp>* prefixSums, std::size_t size, unsigned int shots) {
     std::map<std::string, std::size_t>     results;
     std::uniform_real_distribution<dd::fp> dist(0.0L, 1.0L);
     for (unsigned int i = 0; i < shots; ++i) {
         auto p = dist(mt);
         // use binary search to find the first entry >= p
-        auto mit = std::upper_bound(amplitudes.begin(), amplitudes.end(), p, [](const dd::fp val, const std::complex<dd::fp>& c) { return val < c.real(); });
-        auto m   = std::distance(amplitudes.begin(), mit);
+        auto mit = std::upper_bound(prefixSums, prefixSums + size, p, [](const dd::fp val, const std::complex<dd::fp>& c) { return val < c.real(); });
+        auto m   = std::distance(prefixSums, mit);
 
         // construct basis state string
         auto basisState = toBinaryString(m, getNumberOfQubits());
@@ -34,46 +82,266 @@ std::map<std::string, std::size_t> Simulator<DDPackage>::SampleFromAmplitudeVect
     return results;
 }
 
+template<class DDPackage>
+std::map<std::string, std::size_t> Simulator<DDPackage>::MeasureAllNonCollapsing(unsigned int shots) {
+    const auto nQubits = getNumberOfQubits();
+
+    std::map<std::string, std::size_t> results;
+    if (nQubits > std::numeric_limits<std::size_t>::digits) {
+        // basis state indices do not fit into a machine word, sample shot by shot
+        for (unsigned int i = 0; i < shots; i++) {
+            const auto m = MeasureAll(false);
+            results[m]++;
+        }
+        return results;
+    }
+
+    // the strings are only constructed once per distinct outcome, using the same order as measureAll (highest qubit first)
+    for (const auto& [index, count]: SampleBasisStateIndices(shots)) {
+        std::string basisState(nQubits, '0');
+        for (std::size_t q = 0; q < nQubits; ++q) {
+            if ((index >> q) & 1U) {
+                basisState[nQubits - 1 - q] = '1';
+            }
+        }
+        results.emplace(std::move(basisState), count);
+    }
+    return results;
+}
+
+template<class DDPackage>
+std::unordered_map<std::size_t, std::size_t> Simulator<DDPackage>::SampleBasisStateIndices(std::size_t shots) {
+    assert(getNumberOfQubits() <= std::numeric_limits<std::size_t>::digits);
+
+    std::unordered_map<std::size_t, std::size_t> results;
+    if (shots == 0 || rootEdge.w.approximatelyZero()) {
+        return results;
+    }
+
+    // squared norm of the sub-vector represented by each node, computed once for all shots
+    std::unordered_map<const dd::vNode*, dd::fp> norms;
+    const auto                                   norm = [&norms](const auto& self, const dd::vEdge& e) -> dd::fp {
+        if (e.w.approximatelyZero()) {
+            return 0;
+        }
+        if (e.isTerminal()) {
+            return CN::mag2(e.w);
+        }
+        auto it = norms.find(e.p);
+        if (it == norms.end()) {
+            it = norms.emplace(e.p, self(self, e.p->e.at(0)) + self(self, e.p->e.at(1))).first;
+        }
+        return CN::mag2(e.w) * it->second;
+    };
+    norm(norm, rootEdge);
+
+    struct PendingShots {
+        dd::vEdge   edge;
+        std::size_t index;
+        std::size_t shots;
+    };
+    std::vector<PendingShots> stack{{rootEdge, 0U, shots}};
+    while (!stack.empty()) {
+        const auto [edge, index, edgeShots] = stack.back();
+        stack.pop_back();
+
+        if (edge.isTerminal()) {
+            results[index] += edgeShots;
+            continue;
+        }
+
+        const auto& successors = edge.p->e;
+        const auto  p0         = norm(norm, successors.at(0));
+        const auto  p1         = norm(norm, successors.at(1));
+
+        std::size_t shots0 = edgeShots;
+        if (p1 > 0 && p0 <= 0) {
+            shots0 = 0;
+        } else if (p1 > 0) {
+            std::binomial_distribution<std::size_t> split(edgeShots, p0 / (p0 + p1));
+            shots0 = split(mt);
+        }
+        const std::size_t shots1 = edgeShots - shots0;
+
+        if (shots0 > 0) {
+            stack.push_back({successors.at(0), index, shots0});
+        }
+        if (shots1 > 0) {
+            stack.push_back({successors.at(1), index | (std::size_t{1} << static_cast<std::size_t>(edge.p->v)), shots1});
+        }
+    }
+    return results;
+}
+
+namespace {
+    // Recursively writes the sub-vector represented by e (scaled by amp) into buffer[offset, offset + length).
+    // The dense block of a node that is reached a second time is copied from its first occurrence and rescaled.
+    class VectorExporter {
+    public:
+        VectorExporter(std::complex<dd::fp>* buffer, std::size_t bufferOffset):
+            buffer(buffer), bufferOffset(bufferOffset) {}
+
+        void exportEdge(const dd::vEdge& e, const std::complex<dd::fp>& amp, std::size_t offset, std::size_t length) {
+            auto* const block = buffer + (offset - bufferOffset);
+            if (e.w.approximatelyZero()) {
+                std::fill(block, block + length, std::complex<dd::fp>{0., 0.});
+                return;
+            }
+
+            const auto c = amp * std::complex<dd::fp>{dd::CTEntry::val(e.w.r), dd::CTEntry::val(e.w.i)};
+            if (e.isTerminal()) {
+                *block = c;
+                return;
+            }
+
+            if (length >= MIN_CACHED_LENGTH) {
+                const auto it = exported.find(e.p);
+                if (it != exported.end()) {
+                    const auto& [previousOffset, previousAmp] = it->second;
+                    const auto  factor                        = c / previousAmp;
+                    auto* const previousBlock                 = buffer + (previousOffset - bufferOffset);
+                    std::transform(previousBlock, previousBlock + length, block, [&factor](const auto& value) { return value * factor; });
+                    return;
+                }
+                exported.emplace(e.p, std::make_pair(offset, c));
+            }
+
+            const auto half = length / 2;
+            exportEdge(e.p->e.at(0), c, offset, half);
+            exportEdge(e.p->e.at(1), c, offset + half, half);
+        }
+
+    private:
+        static constexpr std::size_t MIN_CACHED_LENGTH = 64U;
+
+        std::complex<dd::fp>* buffer;
+        const std::size_t     bufferOffset;
+
+        std::unordered_map<const dd::vNode*, std::pair<std::size_t, std::complex<dd::fp>>> exported{};
+    };
+
+    struct ExportTask {
+        dd::vEdge            edge;
+        std::complex<dd::fp> amp;
+        std::size_t          offset;
+        std::size_t          length;
+    };
+} // namespace
+
+template<class DDPackage>
+void Simulator<DDPackage>::getVectorComplexInto(std::complex<dd::fp>* buffer, unsigned int nThreads) const {
+    const std::size_t dim = 1ULL << getNumberOfQubits();
+
+    // split the top levels of the DD into (at least) a few subtrees per thread
+    std::vector<ExportTask> tasks{{rootEdge, {1., 0.}, 0U, dim}};
+    const std::size_t       targetTasks = nThreads > 1 && dim >= PARALLEL_EXPORT_MIN_DIM ? 4U * nThreads : 1U;
+    while (tasks.size() < targetTasks) {
+        std::vector<ExportTask> nextTasks;
+        for (const auto& [edge, amp, offset, length]: tasks) {
+            if (edge.isTerminal() || edge.w.approximatelyZero()) {
+                nextTasks.push_back({edge, amp, offset, length});
+                continue;
+            }
+            const auto c    = amp * std::complex<dd::fp>{dd::CTEntry::val(edge.w.r), dd::CTEntry::val(edge.w.i)};
+            const auto half = length / 2;
+            nextTasks.push_back({edge.p->e.at(0), c, offset, half});
+            nextTasks.push_back({edge.p->e.at(1), c, offset + half, half});
+        }
+        if (nextTasks.size() == tasks.size()) {
+            break;
+        }
+        tasks = std::move(nextTasks);
+    }
+
+    std::atomic<std::size_t> nextTask{0U};
+    const auto               worker = [&]() {
+        VectorExporter exporter(buffer, 0U);
+        for (auto i = nextTask++; i < tasks.size(); i = nextTask++) {
+            exporter.exportEdge(tasks[i].edge, tasks[i].amp, tasks[i].offset, tasks[i].length);
+        }
+    };
+
+    if (tasks.size() == 1U) {
+        worker();
+        return;
+    }
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < std::min<std::size_t>(nThreads, tasks.size()); ++t) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread: threads) {
+        thread.join();
+    }
+}
+
+template<class DDPackage>
+void Simulator<DDPackage>::streamVectorComplex(std::size_t chunkSize, const std::function<void(std::size_t, const std::complex<dd::fp>*, std::size_t)>& callback) const {
+    const auto        nQubits = getNumberOfQubits();
+    const std::size_t dim     = 1ULL << nQubits;
+    if (chunkSize == 0U || (chunkSize & (chunkSize - 1U)) != 0U) {
+        throw std::invalid_argument("Chunk size must be a power of two.");
+    }
+    chunkSize = std::min(chunkSize, dim);
+
+    std::vector<std::complex<dd::fp>> chunk(chunkSize);
+    for (std::size_t offset = 0U; offset < dim; offset += chunkSize) {
+        // descend to the subtree holding the amplitudes of this chunk, i.e., follow the bits of the offset above the chunk
+        dd::vEdge            e   = rootEdge;
+        std::complex<dd::fp> amp = {1., 0.};
+        for (std::size_t length = dim; length > chunkSize && !e.w.approximatelyZero(); length /= 2) {
+            amp *= std::complex<dd::fp>{dd::CTEntry::val(e.w.r), dd::CTEntry::val(e.w.i)};
+            e = e.p->e.at((offset & (length / 2)) != 0U ? 1U : 0U);
+        }
+        VectorExporter exporter(chunk.data(), offset);
+        exporter.exportEdge(e, amp, offset, chunkSize);
+        callback(offset, chunk.data(), chunkSize);
+    }
+}
+
+template<class DDPackage>
+void Simulator<DDPackage>::dumpVectorComplex(const std::string& filename, std::size_t chunkSize) const {
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs.good()) {
+        throw std::runtime_error("Cannot open file '" + filename + "' for writing.");
+    }
+    streamVectorComplex(chunkSize, [&ofs](std::size_t, const std::complex<dd::fp>* data, std::size_t length) {
+        ofs.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(length * sizeof(std::complex<dd::fp>)));
+    });
+}
+
 template<class DDPackage>
 std::vector<dd::ComplexValue> Simulator<DDPackage>::getVector() const {
     assert(getNumberOfQubits() < 60); // On 64bit system the vector can hold up to (2^60)-1 elements, if memory permits
-    std::string                   path(getNumberOfQubits(), '0');
-    std::vector<dd::ComplexValue> results(1ull << getNumberOfQubits(), dd::complex_zero);
-    for (unsigned long long i = 0; i < 1ull << getNumberOfQubits(); ++i) {
-        const std::string corrected_path{path.rbegin(), path.rend()};
-        results[i] = dd->getValueByPath(rootEdge, corrected_path);
-        NextPath(path);
-    }
+    const auto                    amplitudes = getVectorComplex();
+    std::vector<dd::ComplexValue> results(amplitudes.size(), dd::complex_zero);
+    std::transform(amplitudes.begin(), amplitudes.end(), results.begin(), [](const auto& amp) { return dd::ComplexValue{amp.real(), amp.imag()}; });
     return results;
 }
 
 template<class DDPackage>
 std::vector<std::pair<dd::fp, dd::fp>> Simulator<DDPackage>::getVectorPair() const {
     assert(getNumberOfQubits() < 60); // On 64bit system the vector can hold up to (2^60)-1 elements, if memory permits
-    std::string                            path(getNumberOfQubits(), '0');
-    std::vector<std::pair<dd::fp, dd::fp>> results{1ull << getNumberOfQubits()};
-
-    for (unsigned long long i = 0; i < 1ull << getNumberOfQubits(); ++i) {
-        const std::string      corrected_path{path.rbegin(), path.rend()};
-        const dd::ComplexValue cv = dd->getValueByPath(rootEdge, corrected_path);
-        results[i]                = std::make_pair(cv.r, cv.i);
-        NextPath(path);
-    }
+    const auto                             amplitudes = getVectorComplex();
+    std::vector<std::pair<dd::fp, dd::fp>> results(amplitudes.size());
+    std::transform(amplitudes.begin(), amplitudes.end(), results.begin(), [](const auto& amp) { return std::make_pair(amp.real(), amp.imag()); });
     return results;
 }
 
 template<class DDPackage>
 std::vector<std::complex<dd::fp>> Simulator<DDPackage>::getVectorComplex() const {
     assert(getNumberOfQubits() < 60); // On 64bit system the vector can hold up to (2^60)-1 elements, if memory permits
-    std::string                       path(getNumberOfQubits(), '0');
     std::vector<std::complex<dd::fp>> results(1ull << getNumberOfQubits());
+    getVectorComplexInto(results.data());
+    return results;
+}
 
-    for (unsigned long long i = 0; i < 1ull << getNumberOfQubits(); ++i) {
-        const std::string      corrected_path{path.rbegin(), path.rend()};
-        const dd::ComplexValue cv = dd->getValueByPath(rootEdge, corrected_path);
-        results[i]                = std::complex<dd::fp>(cv.r, cv.i);
-        NextPath(path);
+template<class DDPackage>
+AmplitudeBuffer Simulator<DDPackage>::getVectorComplexMapped(const std::string& file, unsigned int nThreads) const {
+    if (getNumberOfQubits() >= 60) {
+        throw std::range_error("getVectorComplexMapped only supports up to 59 qubits.");
     }
+    AmplitudeBuffer results(1ULL << getNumberOfQubits(), file, nThreads);
+    getVectorComplexInto(results.data(), nThreads);
     return results;
 }
 
@@ -91,50 +359,130 @@ void Simulator<DDPackage>::NextPath(std::string& s) {
         s.insert(0, "1");
 }
 
-template<class DDPackage>
-double Simulator<DDPackage>::ApproximateByFidelity(std::unique_ptr<DDPackage>& localDD, dd::vEdge& edge, double targetFidelity, bool allLevels, bool removeNodes, bool verbose) {
-    std::queue<dd::vNode*>       q;
-    std::map<dd::vNode*, dd::fp> probsMone;
-
-    probsMone[edge.p] = CN::mag2(edge.w);
-
-    q.push(edge.p);
-
-    while (!q.empty()) {
-        dd::vNode* ptr = q.front();
-        q.pop();
-        const dd::fp parent_prob = probsMone[ptr];
+namespace {
+    // below this number of nodes a level is not worth splitting among threads
+    constexpr std::size_t PARALLEL_APPROXIMATION_MIN_NODES = 1U << 12U;
+
+    // The nodes of a vector DD grouped by level, together with their contribution, i.e., the summed squared magnitude of all
+    // paths from the root to the node. The terminal is omitted.
+    struct LevelledNodes {
+        std::vector<std::vector<dd::vNode*>>         levels{};
+        std::unordered_map<const dd::vNode*, dd::fp> contributions{};
+    };
+
+    // Visits the DD level by level from the root. As edges only point to lower levels, the contribution of a node is complete
+    // once the levels above it are done. Large levels are split among nThreads threads which only read the DD.
+    LevelledNodes collectLevels(const dd::vEdge& edge, unsigned int nThreads) {
+        LevelledNodes result{};
+        if (edge.isTerminal()) {
+            return result;
+        }
+        result.levels.resize(static_cast<std::size_t>(edge.p->v) + 1U);
+        result.levels.at(edge.p->v).push_back(edge.p);
+        result.contributions[edge.p] = CN::mag2(edge.w);
+
+        using Children = std::vector<std::pair<dd::vNode*, dd::fp>>;
+
+        const auto expand = [&result](const std::vector<dd::vNode*>& nodes, std::size_t begin, std::size_t end, Children& children) {
+            for (auto i = begin; i < end; ++i) {
+                const auto parentContribution = result.contributions.find(nodes[i])->second;
+                for (const auto& child: nodes[i]->e) {
+                    if (child.w != dd::Complex::zero && !child.isTerminal()) {
+                        children.emplace_back(child.p, parentContribution * CN::mag2(child.w));
+                    }
+                }
+            }
+        };
+
+        for (auto level = static_cast<std::ptrdiff_t>(edge.p->v); level > 0; --level) {
+            const auto&           nodes   = result.levels.at(static_cast<std::size_t>(level));
+            const std::size_t     nChunks = nThreads > 1U ? std::clamp<std::size_t>(nodes.size() / PARALLEL_APPROXIMATION_MIN_NODES, 1U, nThreads) : 1U;
+            std::vector<Children> children(nChunks);
+            if (nChunks == 1U) {
+                expand(nodes, 0U, nodes.size(), children.front());
+            } else {
+                std::vector<std::thread> threads;
+                for (std::size_t chunk = 0U; chunk < nChunks; ++chunk) {
+                    threads.emplace_back(expand, std::cref(nodes), chunk * nodes.size() / nChunks, (chunk + 1U) * nodes.size() / nChunks, std::ref(children[chunk]));
+                }
+                for (auto& thread: threads) {
+                    thread.join();
+                }
+            }
 
-        if (ptr->e.at(0).w != dd::Complex::zero) {
-            if (probsMone.find(ptr->e.at(0).p) == probsMone.end()) {
-                q.push(ptr->e.at(0).p);
-                probsMone[ptr->e.at(0).p] = 0;
+            // merging in chunk order keeps the result independent of the thread scheduling
+            for (const auto& chunk: children) {
+                for (const auto& [node, contribution]: chunk) {
+                    const auto [it, inserted] = result.contributions.try_emplace(node, 0.);
+                    if (inserted) {
+                        result.levels.at(static_cast<std::size_t>(node->v)).push_back(node);
+                    }
+                    it->second += contribution;
+                }
             }
-            probsMone[ptr->e.at(0).p] = probsMone.at(ptr->e.at(0).p) + parent_prob * CN::mag2(ptr->e.at(0).w);
         }
+        return result;
+    }
 
-        if (ptr->e.at(1).w != dd::Complex::zero) {
-            if (probsMone.find(ptr->e.at(1).p) == probsMone.end()) {
-                q.push(ptr->e.at(1).p);
-                probsMone[ptr->e.at(1).p] = 0;
+    // Rebuilds the DD with the nodes in replacements substituted by the given (zero) edges. Levels are processed bottom-up,
+    // and only nodes with a substituted descendant are rebuilt; all others are shared with the original DD.
+    template<class DDPackage>
+    dd::vEdge rebuildWithout(std::unique_ptr<DDPackage>& localDD, const dd::vEdge& edge, const LevelledNodes& nodes, std::unordered_map<const dd::vNode*, dd::vEdge>& replacements) {
+        const auto replace = [&localDD, &replacements](const dd::vEdge& e) -> dd::vEdge {
+            const auto it = replacements.find(e.p);
+            if (e.isTerminal() || it == replacements.end()) {
+                return e;
+            }
+            if (it->second.w.approximatelyZero()) {
+                return dd::vEdge::zero;
+            }
+            dd::Complex c = localDD->cn.getTemporary();
+            CN::mul(c, e.w, it->second.w);
+            return {it->second.p, localDD->cn.lookup(c)};
+        };
+
+        for (const auto& level: nodes.levels) {
+            for (auto* node: level) {
+                if (replacements.count(node) > 0U || (replacements.count(node->e.at(0).p) == 0U && replacements.count(node->e.at(1).p) == 0U)) {
+                    continue;
+                }
+                const std::array<dd::vEdge, dd::RADIX> edges{replace(node->e.at(0)), replace(node->e.at(1))};
+                replacements[node] = localDD->makeDDNode(node->v, edges, false);
             }
-            probsMone[ptr->e.at(1).p] = probsMone.at(ptr->e.at(1).p) + parent_prob * CN::mag2(ptr->e.at(1).w);
         }
+        return replace(edge);
+    }
+
+    // Normalizes the rebuilt edge and returns the fidelity to the original state. The paths through removed nodes are
+    // orthogonal to the remaining ones, so no further traversal is required: the fidelity is the fraction of the norm that is left.
+    template<class DDPackage>
+    dd::fp normalizeRebuilt(std::unique_ptr<DDPackage>& localDD, const dd::vEdge& edge, dd::vEdge& newEdge) {
+        const dd::fp normBefore = CN::mag2(edge.w);
+        const dd::fp normAfter  = CN::mag2(newEdge.w);
+        if (newEdge.w.approximatelyZero() || normBefore == 0.) {
+            return 0.;
+        }
+        dd::Complex c = localDD->cn.getCached(std::sqrt(normAfter), 0);
+        CN::div(c, newEdge.w, c);
+        newEdge.w = localDD->cn.lookup(c);
+        localDD->cn.returnToCache(c);
+        return normAfter / normBefore;
     }
+} // namespace
 
-    std::vector<int> nodes(getNumberOfQubits(), 0);
+template<class DDPackage>
+double Simulator<DDPackage>::ApproximateByFidelity(std::unique_ptr<DDPackage>& localDD, dd::vEdge& edge, double targetFidelity, bool allLevels, bool removeNodes, bool verbose) {
+    // the contributions are computed once and reused for the rebuild of the DD
+    const auto nodes = collectLevels(edge, std::thread::hardware_concurrency());
 
     std::vector<std::priority_queue<std::pair<double, dd::vNode*>, std::vector<std::pair<double, dd::vNode*>>>> qq(getNumberOfQubits());
 
-    for (auto& it: probsMone) {
-        if (it.first->v < 0) {
-            continue; // ignore the terminal node which has v == -1
+    for (std::size_t level = 0; level < nodes.levels.size(); ++level) {
+        for (auto* node: nodes.levels[level]) {
+            qq.at(level).emplace(1 - nodes.contributions.at(node), node);
         }
-        nodes.at(it.first->v)++;
-        qq.at(it.first->v).emplace(1 - it.second, it.first);
     }
 
-    probsMone.clear();
     std::vector<dd::vNode*> nodes_to_remove;
 
     int max_remove = 0;
@@ -164,22 +512,15 @@ double Simulator<DDPackage>::ApproximateByFidelity(std::unique_ptr<DDPackage>& l
         }
     }
 
-    std::map<dd::vNode*, dd::vEdge> dag_edges;
+    std::unordered_map<const dd::vNode*, dd::vEdge> dag_edges;
     for (auto& it: nodes_to_remove) {
         dag_edges[it] = dd::vEdge::zero;
     }
 
-    dd::vEdge newEdge = RemoveNodes(localDD, edge, dag_edges);
+    dd::vEdge newEdge = rebuildWithout(localDD, edge, nodes, dag_edges);
     assert(!std::isnan(dd::CTEntry::val(edge.w.r)));
     assert(!std::isnan(dd::CTEntry::val(edge.w.i)));
-    dd::Complex c = localDD->cn.getCached(std::sqrt(CN::mag2(newEdge.w)), 0);
-    CN::div(c, newEdge.w, c);
-    newEdge.w = localDD->cn.lookup(c);
-
-    dd::fp fidelity = 0;
-    if (edge.p->v == newEdge.p->v) {
-        fidelity = localDD->fidelity(edge, newEdge);
-    }
+    const dd::fp fidelity = normalizeRebuilt(localDD, edge, newEdge);
 
     if (verbose) {
         const unsigned size_before = localDD->size(edge);
@@ -206,11 +547,30 @@ double Simulator<DDPackage>::ApproximateByFidelity(std::unique_ptr<DDPackage>& l
     return fidelity;
 }
 
+template<class DDPackage>
+bool Simulator<DDPackage>::EnforceMemoryLimit(std::unique_ptr<DDPackage>& localDD, dd::vEdge& edge, std::size_t limit, double& fidelity) {
+    const auto threshold = static_cast<std::size_t>(MEMORY_LIMIT_THRESHOLD * static_cast<double>(limit));
+    if (tableMemory(localDD) <= threshold) {
+        return true;
+    }
+
+    localDD->garbageCollect(true);
+    for (const auto targetFidelity: MEMORY_LIMIT_FIDELITIES) {
+        if (tableMemory(localDD) <= threshold) {
+            return true;
+        }
+        fidelity *= ApproximateByFidelity(localDD, edge, targetFidelity, false, true);
+        ++memory_limit_approximations;
+        localDD->garbageCollect(true);
+    }
+    return tableMemory(localDD) <= limit;
+}
+
 template<class DDPackage>
 double Simulator<DDPackage>::ApproximateBySampling(std::unique_ptr<DDPackage>& localDD, dd::vEdge& edge, std::size_t nSamples, std::size_t threshold, bool removeNodes, bool verbose) {
     assert(nSamples > threshold);
-    std::map<dd::vNode*, unsigned int>     visited_nodes;
-    std::uniform_real_distribution<dd::fp> dist(0.0, 1.0L);
+    std::unordered_map<const dd::vNode*, std::size_t> visited_nodes;
+    std::uniform_real_distribution<dd::fp>            dist(0.0, 1.0L);
 
     for (unsigned int j = 0; j < nSamples; j++) {
         dd::Edge cur = edge;
@@ -229,46 +589,20 @@ double Simulator<DDPackage>::ApproximateBySampling(std::unique_ptr<DDPackage>& l
         }
     }
 
-    std::set<dd::vNode*> visited_nodes2;
-    visited_nodes2.insert(edge.p);
-    std::queue<dd::vNode*> q;
-    q.push(edge.p);
-
-    while (!q.empty()) {
-        dd::vNode* ptr = q.front();
-        q.pop();
-
-        if (!ptr->e.at(0).w.approximatelyZero() && visited_nodes2.find(ptr->e.at(0).p) == visited_nodes2.end()) {
-            visited_nodes2.insert(ptr->e.at(0).p);
-            q.push(ptr->e.at(0).p);
-        }
-
-        if (!ptr->e.at(1).w.approximatelyZero() && visited_nodes2.find(ptr->e.at(1).p) == visited_nodes2.end()) {
-            visited_nodes2.insert(ptr->e.at(1).p);
-            q.push(ptr->e.at(1).p);
-        }
-    }
-
-    for (auto& visited_node: visited_nodes) {
-        if (visited_node.second > threshold) {
-            visited_nodes2.erase(visited_node.first);
+    // every reachable node that was not sampled often enough is removed
+    const auto                                      nodes = collectLevels(edge, std::thread::hardware_concurrency());
+    std::unordered_map<const dd::vNode*, dd::vEdge> dag_edges;
+    for (const auto& level: nodes.levels) {
+        for (auto* node: level) {
+            const auto it = visited_nodes.find(node);
+            if (it == visited_nodes.end() || it->second <= threshold) {
+                dag_edges[node] = dd::vEdge::zero;
+            }
         }
     }
 
-    std::map<dd::vNode*, dd::vEdge> dag_edges;
-    for (auto it: visited_nodes2) {
-        dag_edges[it] = dd::vEdge::zero;
-    }
-
-    dd::vEdge   newEdge = RemoveNodes(localDD, edge, dag_edges);
-    dd::Complex c       = localDD->cn.getCached(std::sqrt(CN::mag2(newEdge.w)), 0);
-    CN::div(c, newEdge.w, c);
-    newEdge.w = localDD->cn.lookup(c);
-
-    dd::fp fidelity = 0;
-    if (edge.p->v == newEdge.p->v) {
-        fidelity = localDD->fidelity(edge, newEdge);
-    }
+    dd::vEdge    newEdge  = rebuildWithout(localDD, edge, nodes, dag_edges);
+    const dd::fp fidelity = normalizeRebuilt(localDD, edge, newEdge);
 
     if (verbose) {
         const unsigned size_after  = localDD->size(newEdge);
@@ -298,33 +632,44 @@ double Simulator<DDPackage>::ApproximateBySampling(std::unique_ptr<DDPackage>& l
 }
 
 template<class DDPackage>
-dd::vEdge Simulator<DDPackage>::RemoveNodes(std::unique_ptr<DDPackage>& localDD, dd::vEdge e, std::map<dd::vNode*, dd::vEdge>& dag_edges) {
-    if (e.isTerminal()) {
-        return e;
-    }
+dd::vEdge Simulator<DDPackage>::RemoveNodes(std::unique_ptr<DDPackage>& localDD, dd::vEdge e, std::unordered_map<const dd::vNode*, dd::vEdge>& dag_edges) {
+    return rebuildWithout(localDD, e, collectLevels(e, 1U), dag_edges);
+}
 
-    const auto it = dag_edges.find(e.p);
-    if (it != dag_edges.end()) {
-        dd::vEdge r = it->second;
-        if (r.w.approximatelyZero()) {
-            return dd::vEdge::zero;
+template<class DDPackage>
+std::complex<dd::fp> Simulator<DDPackage>::amplitudeOf(const dd::vEdge& edge, std::size_t index) {
+    std::complex<dd::fp> amplitude{1., 0.};
+    auto                 cur = edge;
+    while (!cur.w.approximatelyZero()) {
+        amplitude *= std::complex<dd::fp>{dd::CTEntry::val(cur.w.r), dd::CTEntry::val(cur.w.i)};
+        if (cur.isTerminal()) {
+            return amplitude;
         }
-        dd::Complex c = localDD->cn.getTemporary();
-        dd::ComplexNumbers::mul(c, e.w, r.w);
-        r.w = localDD->cn.lookup(c);
-        return r;
+        cur = cur.p->e.at((index >> static_cast<std::size_t>(cur.p->v)) & 1U);
     }
+    return {0., 0.};
+}
 
-    std::array<dd::vEdge, dd::RADIX> edges{
-            RemoveNodes(localDD, e.p->e.at(0), dag_edges),
-            RemoveNodes(localDD, e.p->e.at(1), dag_edges)};
+template<class DDPackage>
+void Simulator<DDPackage>::checkAmplitudeIndices(const std::vector<std::size_t>& indices, dd::QubitCount nqubits) {
+    if (nqubits >= std::numeric_limits<std::size_t>::digits) {
+        return;
+    }
+    for (const auto index: indices) {
+        if ((index >> nqubits) != 0U) {
+            throw std::invalid_argument("Index " + std::to_string(index) + " does not denote a basis state of " + std::to_string(nqubits) + " qubits.");
+        }
+    }
+}
 
-    dd::vEdge r    = localDD->makeDDNode(e.p->v, edges, false);
-    dag_edges[e.p] = r;
-    dd::Complex c  = localDD->cn.getCached();
-    CN::mul(c, e.w, r.w);
-    r.w = localDD->cn.lookup(c);
-    return r;
+template<class DDPackage>
+AmplitudeMap Simulator<DDPackage>::getAmplitudes(const std::vector<std::size_t>& indices) const {
+    checkAmplitudeIndices(indices, getNumberOfQubits());
+    AmplitudeMap amplitudes;
+    for (const auto index: indices) {
+        amplitudes.emplace(index, amplitudeOf(rootEdge, index));
+    }
+    return amplitudes;
 }
 
 template<class DDPackage>
@@ -364,5 +709,203 @@ std::pair<dd::ComplexValue, std::string> Simulator<DDPackage>::getPathOfLeastRes
             std::string{result.rbegin(), result.rend()}};
 }
 
+template<class DDPackage>
+void Simulator<DDPackage>::writeCheckpoint(std::size_t opIndex, const std::map<std::size_t, bool>& classicValues, std::size_t approximationRuns, double fidelity, std::vector<std::uint64_t> extra) {
+    Checkpoint checkpoint{};
+    checkpoint.nQubits           = getNumberOfQubits();
+    checkpoint.nOps              = getNumberOfOps();
+    checkpoint.circuitHash       = circuitHash();
+    checkpoint.opIndex           = opIndex;
+    checkpoint.classicValues     = classicValues;
+    checkpoint.approximationRuns = approximationRuns;
+    checkpoint.fidelity          = fidelity;
+    checkpoint.extra             = std::move(extra);
+
+    // the DD may change as soon as this returns, so only the file I/O is left to the writer
+    std::ostringstream state;
+    dd::serialize(rootEdge, state, true);
+    checkpoint.state = state.str();
+    std::ostringstream rng;
+    rng << mt;
+    checkpoint.rngState = rng.str();
+
+    checkpoint_writer.write(std::move(checkpoint), checkpoint_file);
+}
+
+template<class DDPackage>
+std::optional<Checkpoint> Simulator<DDPackage>::restoreCheckpoint() {
+    if (!resume_checkpoint.has_value()) {
+        return std::nullopt;
+    }
+    auto checkpoint = std::move(*resume_checkpoint);
+    resume_checkpoint.reset();
+    if (checkpoint.nQubits != getNumberOfQubits()) {
+        throw std::invalid_argument("Checkpoint was taken for " + std::to_string(checkpoint.nQubits) + " qubits, but the simulation has " + std::to_string(getNumberOfQubits()) + ".");
+    }
+    if (checkpoint.nOps != getNumberOfOps() || checkpoint.circuitHash != circuitHash()) {
+        throw std::invalid_argument("Checkpoint was taken for a different circuit.");
+    }
+
+    std::istringstream state(checkpoint.state);
+    rootEdge = dd->template deserialize<dd::vNode>(state, true);
+    dd->incRef(rootEdge);
+    std::istringstream rng(checkpoint.rngState);
+    rng >> mt;
+    return checkpoint;
+}
+
+namespace {
+    // Terms that agree on the Paulis of their lower qubits share the same prefix id for these qubits, so ids form a trie over
+    // the qubits from 0 upwards and any intermediate result of two terms with the same prefix is the same.
+    struct PauliPrefixes {
+        std::vector<std::string>              ops;      // per term, the Pauli acting on qubit q at position q
+        std::vector<std::vector<std::size_t>> prefixes; // per term, the id of the Paulis on qubits 0, ..., q at position q
+    };
+
+    PauliPrefixes buildPauliPrefixes(const PauliSum& observable, std::size_t nqubits) {
+        PauliPrefixes                                       result{};
+        std::map<std::pair<std::size_t, char>, std::size_t> trie;
+        for (const auto& term: observable) {
+            if (term.pauli.size() != nqubits) {
+                throw std::invalid_argument("Pauli string '" + term.pauli + "' does not match the " + std::to_string(nqubits) + " qubits of the state.");
+            }
+            std::string ops(term.pauli.rbegin(), term.pauli.rend());
+            if (ops.find_first_not_of("IXYZ") != std::string::npos) {
+                throw std::invalid_argument("Pauli string '" + term.pauli + "' may only contain I, X, Y, and Z.");
+            }
+            std::vector<std::size_t> prefixes(nqubits);
+            std::size_t              id = 0;
+            for (std::size_t q = 0; q < nqubits; ++q) {
+                id          = trie.try_emplace({id, ops[q]}, trie.size() + 1).first->second;
+                prefixes[q] = id;
+            }
+            result.ops.emplace_back(std::move(ops));
+            result.prefixes.emplace_back(std::move(prefixes));
+        }
+        return result;
+    }
+
+    // evaluates <x|P|y> for sub-vectors of the state, caching results by node pair and Pauli prefix
+    class PauliEvaluator {
+    public:
+        explicit PauliEvaluator(const PauliPrefixes& prefixes):
+            prefixes(prefixes) {}
+
+        std::complex<dd::fp> evaluate(const dd::vEdge& root, std::size_t term) {
+            current = term;
+            return inner(root, root);
+        }
+
+    private:
+        struct Key {
+            const dd::vNode* x;
+            const dd::vNode* y;
+            std::size_t      prefix;
+
+            bool operator==(const Key& other) const { return x == other.x && y == other.y && prefix == other.prefix; }
+        };
+
+        struct KeyHash {
+            std::size_t operator()(const Key& key) const {
+                const auto h = std::hash<const void*>{}(key.x) * 31U + std::hash<const void*>{}(key.y);
+                return h * 31U + std::hash<std::size_t>{}(key.prefix);
+            }
+        };
+
+        const PauliPrefixes&                                   prefixes;
+        std::size_t                                            current = 0;
+        std::unordered_map<Key, std::complex<dd::fp>, KeyHash> cache{};
+
+        static std::complex<dd::fp> weight(const dd::vEdge& e) {
+            return {dd::CTEntry::val(e.w.r), dd::CTEntry::val(e.w.i)};
+        }
+
+        std::complex<dd::fp> inner(const dd::vEdge& a, const dd::vEdge& b) {
+            if (a.w.approximatelyZero() || b.w.approximatelyZero()) {
+                return 0.;
+            }
+            const auto w = std::conj(weight(a)) * weight(b);
+            if (a.isTerminal() || b.isTerminal()) {
+                return w;
+            }
+            return w * node(a.p, b.p);
+        }
+
+        std::complex<dd::fp> node(const dd::vNode* x, const dd::vNode* y) {
+            const auto q   = static_cast<std::size_t>(x->v);
+            const Key  key = {x, y, prefixes.prefixes[current][q]};
+            if (const auto it = cache.find(key); it != cache.end()) {
+                return it->second;
+            }
+            std::complex<dd::fp> value{};
+            switch (prefixes.ops[current][q]) {
+                case 'I':
+                    value = inner(x->e[0], y->e[0]) + inner(x->e[1], y->e[1]);
+                    break;
+                case 'Z':
+                    value = inner(x->e[0], y->e[0]) - inner(x->e[1], y->e[1]);
+                    break;
+                case 'X':
+                    value = inner(x->e[0], y->e[1]) + inner(x->e[1], y->e[0]);
+                    break;
+                case 'Y':
+                    // Y|0> = i|1> and Y|1> = -i|0>
+                    value = std::complex<dd::fp>{0., -1.} * inner(x->e[0], y->e[1]) + std::complex<dd::fp>{0., 1.} * inner(x->e[1], y->e[0]);
+                    break;
+                default:
+                    break;
+            }
+            cache.emplace(key, value);
+            return value;
+        }
+    };
+} // namespace
+
+template<class DDPackage>
+double Simulator<DDPackage>::expectationValue(const PauliSum& observable, unsigned int nThreads) const {
+    if (rootEdge.p == nullptr || rootEdge.isTerminal()) {
+        throw std::runtime_error("Expectation values require a simulated state.");
+    }
+    const auto nqubits  = static_cast<std::size_t>(rootEdge.p->v) + 1U;
+    const auto prefixes = buildPauliPrefixes(observable, nqubits);
+
+    // neighbouring terms in this order share the longest prefixes, so every thread works on consecutive chunks of it
+    std::vector<std::size_t> order(observable.size());
+    std::iota(order.begin(), order.end(), 0U);
+    std::sort(order.begin(), order.end(), [&prefixes](std::size_t a, std::size_t b) { return prefixes.ops[a] < prefixes.ops[b]; });
+
+    std::vector<std::complex<dd::fp>> values(observable.size());
+    const std::size_t                 nChunks   = std::max<std::size_t>(1U, std::min<std::size_t>(4U * std::max(nThreads, 1U), observable.size()));
+    const std::size_t                 chunkSize = (observable.size() + nChunks - 1U) / nChunks;
+    std::atomic<std::size_t>          nextChunk{0U};
+    const auto                        worker = [&]() {
+        PauliEvaluator evaluator(prefixes);
+        for (auto c = nextChunk++; c * chunkSize < observable.size(); c = nextChunk++) {
+            for (std::size_t i = c * chunkSize; i < std::min(observable.size(), (c + 1U) * chunkSize); ++i) {
+                values[order[i]] = evaluator.evaluate(rootEdge, order[i]);
+            }
+        }
+    };
+
+    if (nThreads <= 1U || nChunks == 1U) {
+        worker();
+    } else {
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < std::min<std::size_t>(nThreads, nChunks); ++t) {
+            threads.emplace_back(worker);
+        }
+        for (auto& thread: threads) {
+            thread.join();
+        }
+    }
+
+    double result = 0.;
+    for (std::size_t i = 0; i < observable.size(); ++i) {
+        result += observable[i].coefficient * values[i].real();
+    }
+    return result;
+}
+
 template class Simulator<dd::Package<>>;
 template class Simulator<StochasticNoisePackage>;
+template class Simulator<DeepCircuitPackage>;
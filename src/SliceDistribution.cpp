@@ -0,0 +1,62 @@
+#include "SliceDistribution.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+SliceDistribution::SliceDistribution(MPI_Comm comm, std::int64_t nslices, std::int64_t blockSize, std::int64_t minBlocksPerBatch):
+    nslices(nslices), batchSize(std::min(blockSize, nslices)) {
+    int rank  = 0;
+    int ranks = 1;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &ranks);
+
+    // doubling keeps the batches aligned to the blocks as well as to each other
+    const auto target = nslices / (static_cast<std::int64_t>(ranks) * BATCHES_PER_RANK);
+    while (batchSize * 2 <= nslices && (batchSize < blockSize * minBlocksPerBatch || batchSize * 2 <= target)) {
+        batchSize *= 2;
+    }
+
+    const MPI_Aint bytes = rank == 0 ? static_cast<MPI_Aint>(sizeof(std::int64_t)) : 0;
+    MPI_Win_allocate(bytes, sizeof(std::int64_t), MPI_INFO_NULL, comm, &counter, &window);
+    if (rank == 0) {
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, window);
+        *counter = 0;
+        MPI_Win_unlock(0, window);
+    }
+    // no rank may fetch from the counter before it has been initialized
+    MPI_Barrier(comm);
+    MPI_Win_lock_all(0, window);
+}
+
+SliceDistribution::~SliceDistribution() {
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+}
+
+std::pair<std::int64_t, std::int64_t> SliceDistribution::next() {
+    std::int64_t first = 0;
+    MPI_Fetch_and_op(&batchSize, &first, MPI_INT64_T, 0, 0, MPI_SUM, window);
+    MPI_Win_flush(0, window);
+    if (first >= nslices) {
+        return {nslices, nslices};
+    }
+    return {first, std::min(first + batchSize, nslices)};
+}
+
+void SliceDistribution::allreduce(MPI_Comm comm, std::complex<dd::fp>* amplitudes, std::size_t size) {
+    static_assert(std::is_same_v<dd::fp, double>, "The amplitudes are reduced as MPI_CXX_DOUBLE_COMPLEX.");
+    // state vectors easily exceed the element count a single call can handle
+    constexpr auto maxCount = static_cast<std::size_t>(std::numeric_limits<int>::max());
+    for (std::size_t begin = 0; begin < size; begin += maxCount) {
+        const auto count = static_cast<int>(std::min(maxCount, size - begin));
+        MPI_Allreduce(MPI_IN_PLACE, amplitudes + begin, count, MPI_CXX_DOUBLE_COMPLEX, MPI_SUM, comm);
+    }
+}
+
+bool SliceDistribution::any(MPI_Comm comm, bool value) {
+    int flag = value ? 1 : 0;
+    MPI_Allreduce(MPI_IN_PLACE, &flag, 1, MPI_INT, MPI_LOR, comm);
+    return flag != 0;
+}
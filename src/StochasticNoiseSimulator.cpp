@@ -1,5 +1,11 @@
 #include "StochasticNoiseSimulator.hpp"
 
+#include "OperationCache.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
 #include <queue>
 #include <stdexcept>
 
@@ -90,51 +96,57 @@ void StochasticNoiseSimulator<DDPackage>::perfectSimulationRun() {
 
 template<class DDPackage>
 std::map<std::string, double> StochasticNoiseSimulator<DDPackage>::StochSimulate() {
-    // Generate a vector for each instance.
-    recordedPropertiesPerInstance.resize(maxInstances, std::vector<double>(recordedProperties.size(), 0.0));
-    classicalMeasurementsMaps.resize(maxInstances);
-    // the final vector stores the average of all runs and is calculated after the runs have finished
-    finalProperties.resize(recordedProperties.size(), 0);
-    //std::clog << "Conducting " << stochasticRuns << " runs using " << maxInstances << " cores...\n";
-    std::vector<std::thread> threadArray;
-    // The stochastic runs are applied in parallel
-    //std::clog << "Starting " << maxInstances << " threads\n";
+    // the final vectors store the sums over all runs and are turned into averages after the runs have finished
+    finalProperties.assign(recordedProperties.size(), 0);
+    finalPropertyErrors.assign(recordedProperties.size(), 0);
+    finalClassicalMeasurementsMap.clear();
+    std::vector<double> finalSquaredProperties(recordedProperties.size(), 0.0);
+    executedRuns            = 0U;
+    stochChunks             = 0U;
+    memoryLimitFidelityLoss = 0.;
+    // the memory limit only refers to the current simulation
+    Simulator<DDPackage>::memory_limit_exceeded = false;
+
+    // one package (and operation cache) per worker thread, created lazily by the first chunk executed on that worker
+    tf::Executor               executor(maxInstances);
+    std::vector<WorkerPackage> workerPackages(executor.num_workers());
+
+    // without a target error all runs are conducted in a single batch, otherwise the error bars are checked after every batch
+    const bool        adaptive  = targetError > 0.;
+    const std::size_t batchSize = adaptive ? std::max<std::size_t>(minimumBatchSize, static_cast<std::size_t>(maxInstances) * 8U) : stochasticRuns;
+    const double      zScore    = confidenceToZScore(confidenceLevel);
+
+    Simulator<DDPackage>::beginProgress(stochasticRuns);
     const auto t1Stoch = std::chrono::steady_clock::now();
-    for (std::size_t runID = 0U; runID < maxInstances; runID++) {
-        threadArray.emplace_back(&StochasticNoiseSimulator<DDPackage>::runStochSimulationForId,
-                                 this,
-                                 runID,
-                                 qc->getNqubits(),
-                                 std::ref(recordedPropertiesPerInstance[runID]),
-                                 std::ref(recordedProperties),
-                                 std::ref(classicalMeasurementsMaps[runID]),
-                                 static_cast<unsigned long long>(Simulator<DDPackage>::mt()));
-    }
-    // wait for threads to finish
-    for (auto& thread: threadArray) {
-        thread.join();
+    while (executedRuns < stochasticRuns) {
+        const std::size_t runs = std::min(batchSize, stochasticRuns - executedRuns);
+        executedRuns += runStochBatch(runs, executor, workerPackages, finalSquaredProperties);
+        Simulator<DDPackage>::checkCancellation();
+
+        // the runs finished before the memory limit was exceeded make up the (partial) result
+        if (Simulator<DDPackage>::memory_limit_exceeded) {
+            break;
+        }
+        if (adaptive && updatePropertyErrors(finalSquaredProperties, zScore) <= targetError) {
+            break;
+        }
     }
     const auto t2Stoch = std::chrono::steady_clock::now();
     stochRunTime       = std::chrono::duration<double>(t2Stoch - t1Stoch).count();
 
-    for (const auto& classicalMeasurementsMap: classicalMeasurementsMaps) {
-        for (const auto& [state, count]: classicalMeasurementsMap) {
-            finalClassicalMeasurementsMap[state] += count;
-        }
-    }
+    maxPropertyError = updatePropertyErrors(finalSquaredProperties, zScore);
 
     //std::clog <<"Calculating amplitudes from all runs...\n";
-    for (unsigned long j = 0U; j < recordedProperties.size(); j++) {
-        for (const auto& instanceProperties: recordedPropertiesPerInstance) {
-            finalProperties[j] += instanceProperties[j];
+    if (executedRuns > 0U) {
+        for (auto& property: finalProperties) {
+            property /= static_cast<double>(executedRuns);
         }
-        finalProperties[j] /= static_cast<double>(stochasticRuns);
     }
 
     // Adding the result of classical registers to the measureResult map
     std::map<std::string, double> measureResult;
     for (const auto& [state, count]: finalClassicalMeasurementsMap) {
-        const auto probability = count / static_cast<double>(stochasticRuns);
+        const auto probability = count / static_cast<double>(executedRuns);
         measureResult.emplace(state, probability); //todo maybe print both classical and quantum register ? classical register:"
     }
 
@@ -155,30 +167,147 @@ std::map<std::string, double> StochasticNoiseSimulator<DDPackage>::StochSimulate
 }
 
 template<class DDPackage>
-void StochasticNoiseSimulator<DDPackage>::runStochSimulationForId(std::size_t                                stochRun,
-                                                                  dd::Qubit                                  nQubits,
-                                                                  std::vector<double>&                       recordedPropertiesStorage,
-                                                                  std::vector<std::pair<long, std::string>>& recordedPropertiesList,
-                                                                  std::map<std::string, unsigned int>&       classicalMeasurementsMap,
-                                                                  unsigned long long                         localSeed) {
+std::size_t StochasticNoiseSimulator<DDPackage>::runStochBatch(std::size_t                 runs,
+                                                               tf::Executor&               executor,
+                                                               std::vector<WorkerPackage>& workerPackages,
+                                                               std::vector<double>&        squaredPropertySums) {
+    // The runs are split into chunks that are considerably smaller than an even share per thread. Idle workers of the
+    // executor steal pending chunks, so a few expensive trajectories no longer determine the wall time.
+    const std::size_t chunkSize = std::max<std::size_t>(1U, runs / (static_cast<std::size_t>(maxInstances) * 8U));
+    const std::size_t nChunks   = (runs + chunkSize - 1U) / chunkSize;
+    stochChunks += nChunks;
+
+    // Generate a vector for each chunk.
+    recordedPropertiesPerInstance.assign(nChunks, std::vector<double>(recordedProperties.size(), 0.0));
+    std::vector<std::vector<double>> squaredPropertiesPerInstance(nChunks, std::vector<double>(recordedProperties.size(), 0.0));
+    classicalMeasurementsMaps.assign(nChunks, {});
+    std::vector<std::size_t> completedRuns(nChunks, 0U);
+
+    // seeds are drawn up front so the result does not depend on the order in which the chunks are scheduled
+    std::vector<unsigned long long> chunkSeeds(nChunks);
+    for (auto& chunkSeed: chunkSeeds) {
+        chunkSeed = static_cast<unsigned long long>(Simulator<DDPackage>::mt());
+    }
+
+    for (std::size_t chunkID = 0U; chunkID < nChunks; chunkID++) {
+        const std::size_t numberOfRuns = std::min(chunkSize, runs - chunkID * chunkSize);
+        executor.silent_async([this, &executor, &workerPackages, &chunkSeeds, &squaredPropertiesPerInstance, &completedRuns, chunkID, numberOfRuns]() {
+            auto& worker = workerPackages.at(static_cast<std::size_t>(executor.this_worker_id()));
+            if (!worker.dd) {
+                worker.dd = std::make_unique<StochasticNoisePackage>(qc->getNqubits());
+            }
+            completedRuns[chunkID] = runStochSimulationForId(numberOfRuns,
+                                                             qc->getNqubits(),
+                                                             worker.dd,
+                                                             worker.opCache,
+                                                             recordedPropertiesPerInstance[chunkID],
+                                                             squaredPropertiesPerInstance[chunkID],
+                                                             recordedProperties,
+                                                             classicalMeasurementsMaps[chunkID],
+                                                             chunkSeeds[chunkID]);
+        });
+    }
+    executor.wait_for_all();
+
+    // pairwise tree reduction of the per-chunk results into the first chunk
+    for (std::size_t stride = 1U; stride < nChunks; stride *= 2U) {
+        for (std::size_t target = 0U; target + stride < nChunks; target += 2U * stride) {
+            executor.silent_async([this, &squaredPropertiesPerInstance, target, source = target + stride]() {
+                auto& targetProperties = recordedPropertiesPerInstance[target];
+                auto& sourceProperties = recordedPropertiesPerInstance[source];
+                std::transform(targetProperties.begin(), targetProperties.end(), sourceProperties.begin(), targetProperties.begin(), std::plus<>{});
+                auto& targetSquares = squaredPropertiesPerInstance[target];
+                auto& sourceSquares = squaredPropertiesPerInstance[source];
+                std::transform(targetSquares.begin(), targetSquares.end(), sourceSquares.begin(), targetSquares.begin(), std::plus<>{});
+                for (const auto& [state, count]: classicalMeasurementsMaps[source]) {
+                    classicalMeasurementsMaps[target][state] += count;
+                }
+            });
+        }
+        executor.wait_for_all();
+    }
+
+    if (nChunks == 0U) {
+        return 0U;
+    }
+    std::transform(finalProperties.begin(), finalProperties.end(), recordedPropertiesPerInstance.front().begin(), finalProperties.begin(), std::plus<>{});
+    std::transform(squaredPropertySums.begin(), squaredPropertySums.end(), squaredPropertiesPerInstance.front().begin(), squaredPropertySums.begin(), std::plus<>{});
+    for (const auto& [state, count]: classicalMeasurementsMaps.front()) {
+        finalClassicalMeasurementsMap[state] += count;
+    }
+    return std::accumulate(completedRuns.begin(), completedRuns.end(), std::size_t{0U});
+}
+
+template<class DDPackage>
+double StochasticNoiseSimulator<DDPackage>::updatePropertyErrors(const std::vector<double>& squaredPropertySums, double zScore) {
+    // finalProperties still holds the plain sums at this point
+    const auto n        = static_cast<double>(executedRuns);
+    double     maxError = 0.;
+    for (std::size_t i = 0U; i < recordedProperties.size(); i++) {
+        if (recordedProperties[i].first < 0 || executedRuns < 2U) {
+            finalPropertyErrors[i] = 0.;
+            continue;
+        }
+        const double mean     = finalProperties[i] / n;
+        const double variance = std::max(0., (squaredPropertySums[i] - n * mean * mean) / (n - 1.));
+        finalPropertyErrors[i] = zScore * std::sqrt(variance / n);
+        maxError               = std::max(maxError, finalPropertyErrors[i]);
+    }
+    return maxError;
+}
+
+template<class DDPackage>
+double StochasticNoiseSimulator<DDPackage>::confidenceToZScore(double confidence) {
+    // two-sided quantile of the standard normal distribution, i.e., the z with erf(z / sqrt(2)) = confidence
+    double lower = 0.;
+    double upper = 10.;
+    for (int i = 0; i < 64; i++) {
+        const double mid = (lower + upper) / 2.;
+        if (std::erf(mid / std::sqrt(2.)) < confidence) {
+            lower = mid;
+        } else {
+            upper = mid;
+        }
+    }
+    return (lower + upper) / 2.;
+}
+
+template<class DDPackage>
+std::size_t StochasticNoiseSimulator<DDPackage>::runStochSimulationForId(std::size_t                                numberOfRuns,
+                                                                         dd::Qubit                                  nQubits,
+                                                                         std::unique_ptr<StochasticNoisePackage>&   localDD,
+                                                                         OperationCache<StochasticNoisePackage>&    opCache,
+                                                                         std::vector<double>&                       recordedPropertiesStorage,
+                                                                         std::vector<double>&                       squaredPropertiesStorage,
+                                                                         std::vector<std::pair<long, std::string>>& recordedPropertiesList,
+                                                                         std::map<std::string, unsigned int>&       classicalMeasurementsMap,
+                                                                         unsigned long long                         localSeed) {
     std::mt19937_64                        generator(localSeed);
     std::uniform_real_distribution<dd::fp> dist(0.0, 1.0);
 
-    const unsigned long numberOfRuns = stochasticRuns / maxInstances + (stochRun < stochasticRuns % maxInstances ? 1U : 0U);
-    const int           approxMod    = std::ceil(static_cast<double>(qc->getNops()) / (stepNumber + 1));
+    const int approxMod = std::ceil(static_cast<double>(qc->getNops()) / (stepNumber + 1));
+
+    // the package is owned by the executing worker and reused for all of its runs. Between two runs all nodes are released
+    // and collected, which keeps the memory of the unique and complex tables allocated instead of building a new package every time.
+    auto stochasticNoiseFunctionality = dd::StochasticNoiseFunctionality<StochasticNoisePackage>(
+            localDD,
+            nQubits,
+            noiseProbability,
+            amplitudeDampingProb,
+            multiQubitGateFactor,
+            noiseEffects);
+
+    // the memory limit is shared evenly by the packages of all workers, but a limit that is set never drops to zero
+    const std::size_t memoryLimit       = Simulator<DDPackage>::memory_limit;
+    const std::size_t workerMemoryLimit = memoryLimit > 0U ? std::max<std::size_t>(1U, (memoryLimit + maxInstances - 1U) / maxInstances) : 0U;
+    std::size_t       completedRuns     = 0U;
+    double            fidelityLoss      = 0.;
 
     //printf("Running %d times and using the dd at %p, using the cn object at %p\n", numberOfRuns, (void *) &package, (void *) &package->cn);
-    for (std::size_t currentRun = 0U; currentRun < numberOfRuns; currentRun++) {
+    for (std::size_t currentRun = 0U; currentRun < numberOfRuns && !Simulator<DDPackage>::memory_limit_exceeded && !Simulator<DDPackage>::cancellationRequested(); currentRun++) {
         const auto t1 = std::chrono::steady_clock::now();
-
-        auto localDD                      = std::make_unique<StochasticNoisePackage>(qc->getNqubits());
-        auto stochasticNoiseFunctionality = dd::StochasticNoiseFunctionality<StochasticNoisePackage>(
-                localDD,
-                nQubits,
-                noiseProbability,
-                amplitudeDampingProb,
-                multiQubitGateFactor,
-                noiseEffects);
+        double     runFidelity = 1.;
+        bool       aborted     = false;
 
         std::map<std::size_t, bool> classicValues;
 
@@ -213,6 +342,7 @@ void StochasticNoiseSimulator<DDPackage>::runStochSimulationForId(std::size_t
                     throw std::runtime_error("Dynamic cast to NonUnitaryOperation failed.");
                 }
             } else {
+                const auto   span = Simulator<DDPackage>::traceBegin(localDD, localRootEdge);
                 dd::mEdge    operation{};
                 qc::Targets  targets;
                 dd::Controls controls;
@@ -230,7 +360,7 @@ void StochasticNoiseSimulator<DDPackage>::runStochSimulationForId(std::size_t
                             expValue = expValue >> 1U;
                         }
                     }
-                    operation = dd::getDD(classicOp->getOperation(), localDD);
+                    operation = opCache.get(classicOp->getOperation(), localDD);
                     targets   = classicOp->getOperation()->getTargets();
                     controls  = classicOp->getOperation()->getControls();
                     if (!executeOp) {
@@ -247,7 +377,7 @@ void StochasticNoiseSimulator<DDPackage>::runStochSimulationForId(std::size_t
                             localDD->stochasticNoiseOperationCache.insert(op->getType(), targets.front(), operation);
                         }
                     } else {
-                        operation = dd::getDD(op.get(), localDD);
+                        operation = opCache.get(op.get(), localDD);
                     }
                 }
 
@@ -268,13 +398,28 @@ void StochasticNoiseSimulator<DDPackage>::runStochSimulationForId(std::size_t
                     approxCount++;
                     Simulator<DDPackage>::ApproximateByFidelity(localDD, localRootEdge, stepFidelity, false, true);
                 }
+                Simulator<DDPackage>::traceEnd(span, localDD, localRootEdge, opCount, *op);
             }
             localDD->garbageCollect();
+            if (workerMemoryLimit > 0U && !Simulator<DDPackage>::EnforceMemoryLimit(localDD, localRootEdge, workerMemoryLimit, runFidelity)) {
+                Simulator<DDPackage>::memory_limit_exceeded = true;
+                aborted                                     = true;
+                break;
+            }
             opCount++;
         }
-        localDD->decRef(localRootEdge);
         const auto t2 = std::chrono::steady_clock::now();
 
+        if (aborted) {
+            // an incomplete run would bias the averages, so it is discarded
+            localDD->decRef(localRootEdge);
+            localDD->garbageCollect(true);
+            break;
+        }
+        fidelityLoss += 1. - runFidelity;
+        completedRuns++;
+        Simulator<DDPackage>::advanceProgress(localDD);
+
         if (!classicValues.empty()) {
             std::string classicRegisterString;
             for (const auto& [val, isSet]: classicValues) {
@@ -294,9 +439,23 @@ void StochasticNoiseSimulator<DDPackage>::runStochSimulationForId(std::size_t
                 const auto amplitude   = localDD->getValueByPath(localRootEdge, basisVector);
                 const auto prob        = amplitude.r * amplitude.r + amplitude.i * amplitude.i;
                 recordedPropertiesStorage[i] += prob;
+                squaredPropertiesStorage[i] += prob * prob;
             }
         }
+
+        // cheap reset for the next run: drop the final state and force a collection of everything that is unused
+        localDD->decRef(localRootEdge);
+        localDD->garbageCollect(true);
+        if (!packageReuse) {
+            opCache.clear(localDD);
+            localDD = std::make_unique<StochasticNoisePackage>(nQubits);
+        }
+    }
+    if (fidelityLoss > 0.) {
+        const std::lock_guard<std::mutex> lock(memoryLimitMutex);
+        memoryLimitFidelityLoss += fidelityLoss;
     }
+    return completedRuns;
 }
 
 template<class DDPackage>
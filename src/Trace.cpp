@@ -0,0 +1,86 @@
+#include "Trace.hpp"
+
+#include "nlohmann/json.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    const char* kindName(TraceEvent::Kind kind) {
+        switch (kind) {
+            case TraceEvent::Kind::Operation:
+                return "operation";
+            case TraceEvent::Kind::GarbageCollection:
+                return "garbage_collection";
+        }
+        return "unknown";
+    }
+
+    double hitRate(std::uint64_t hits, std::uint64_t lookups) {
+        return lookups == 0 ? 0. : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+} // namespace
+
+std::size_t Tracer::threadIndex() {
+    const auto            id = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    const std::lock_guard lock(mutex);
+    const auto            it = std::find(threads.begin(), threads.end(), id);
+    if (it != threads.end()) {
+        return static_cast<std::size_t>(std::distance(threads.begin(), it));
+    }
+    threads.emplace_back(id);
+    return threads.size() - 1;
+}
+
+void Tracer::writeChromeTrace(std::ostream& os) const {
+    nlohmann::json traceEvents = nlohmann::json::array();
+    for (const auto& event: getEvents()) {
+        // the trace event format expects microseconds
+        traceEvents.push_back({
+                {"name", event.name},
+                {"cat", kindName(event.kind)},
+                {"ph", "X"},
+                {"ts", static_cast<double>(event.start) / 1e3},
+                {"dur", static_cast<double>(event.duration) / 1e3},
+                {"pid", 0},
+                {"tid", event.thread},
+                {"args",
+                 {
+                         {"index", event.index},
+                         {"nodes_before", event.nodesBefore},
+                         {"nodes_after", event.nodesAfter},
+                         {"unique_table_lookups", event.uniqueLookups},
+                         {"unique_table_hit_rate", hitRate(event.uniqueHits, event.uniqueLookups)},
+                         {"compute_table_lookups", event.computeLookups},
+                         {"compute_table_hit_rate", hitRate(event.computeHits, event.computeLookups)},
+                 }},
+        });
+    }
+    os << nlohmann::json{{"traceEvents", traceEvents}, {"displayTimeUnit", "ns"}};
+}
+
+void Tracer::writeCSV(std::ostream& os) const {
+    os << "kind,name,index,thread,start_ns,duration_ns,nodes_before,nodes_after,unique_table_lookups,unique_table_hit_rate,compute_table_lookups,compute_table_hit_rate\n";
+    for (const auto& event: getEvents()) {
+        os << kindName(event.kind) << ',' << event.name << ',' << event.index << ',' << event.thread << ','
+           << event.start << ',' << event.duration << ',' << event.nodesBefore << ',' << event.nodesAfter << ','
+           << event.uniqueLookups << ',' << hitRate(event.uniqueHits, event.uniqueLookups) << ','
+           << event.computeLookups << ',' << hitRate(event.computeHits, event.computeLookups) << '\n';
+    }
+}
+
+void Tracer::write(const std::string& file) const {
+    std::ofstream ofs(file);
+    if (!ofs.good()) {
+        throw std::runtime_error("Cannot open trace file '" + file + "' for writing.");
+    }
+    const bool csv = file.size() >= 4 && file.compare(file.size() - 4, 4, ".csv") == 0;
+    if (csv) {
+        writeCSV(ofs);
+    } else {
+        writeChromeTrace(ofs);
+    }
+}
@@ -2,7 +2,10 @@
 
 #include "dd/FunctionalityConstruction.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <stdexcept>
+#include <taskflow/taskflow.hpp>
 
 template<class DDPackage>
 void UnitarySimulator<DDPackage>::Construct() {
@@ -12,9 +15,109 @@ void UnitarySimulator<DDPackage>::Construct() {
         e = dd::buildFunctionality(CircuitSimulator<DDPackage>::qc.get(), Simulator<DDPackage>::dd);
     } else if (mode == Mode::Recursive) {
         e = dd::buildFunctionalityRecursive(CircuitSimulator<DDPackage>::qc.get(), Simulator<DDPackage>::dd);
+    } else if (mode == Mode::ParallelRecursive) {
+        e = ConstructParallel();
     }
     auto end         = std::chrono::steady_clock::now();
     constructionTime = std::chrono::duration<double>(end - start).count();
 }
 
+template<class DDPackage>
+qc::MatrixDD UnitarySimulator<DDPackage>::ConstructParallel() {
+    const auto& circuit = CircuitSimulator<DDPackage>::qc;
+    const auto  nqubits = circuit->getNqubits();
+
+    // the leaves apply the operations as they are, so permuted layouts are left to the sequential construction
+    const auto isIdentity = [](const qc::Permutation& permutation) {
+        return std::all_of(permutation.begin(), permutation.end(), [](const auto& p) { return p.first == p.second; });
+    };
+    if (!isIdentity(circuit->initialLayout) || !isIdentity(circuit->outputPermutation) || circuit->getNancillae() > 0) {
+        return dd::buildFunctionalityRecursive(circuit.get(), Simulator<DDPackage>::dd);
+    }
+
+    std::vector<const qc::Operation*> ops;
+    for (const auto& op: *circuit) {
+        if (op->getType() == qc::Barrier) {
+            continue;
+        }
+        if (!op->isUnitary()) {
+            throw std::invalid_argument("Functionality not unitary.");
+        }
+        ops.push_back(op.get());
+    }
+
+    // a power of two number of leaves, so that every level halves the number of matrices
+    std::size_t nleaves = 1;
+    while (nleaves < nthreads && 2 * nleaves * MIN_OPS_PER_LEAF <= ops.size()) {
+        nleaves *= 2;
+    }
+
+    std::vector<std::unique_ptr<DDPackage>> packages(nleaves);
+    std::vector<qc::MatrixDD>               matrices(nleaves);
+    tf::Executor                            executor(std::min(nthreads, nleaves));
+
+    levelConstructionTimes.clear();
+    levelMaxNodeCounts.clear();
+    const auto finishLevel = [this, &packages](std::chrono::steady_clock::time_point start, std::size_t stride) {
+        levelConstructionTimes.emplace_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        std::size_t maxNodes = 0;
+        for (std::size_t i = 0; i < packages.size(); i += stride) {
+            maxNodes = std::max<std::size_t>(maxNodes, packages[i]->mUniqueTable.getPeakNodeCount());
+        }
+        levelMaxNodeCounts.emplace_back(maxNodes);
+        parallelMaxNodeCount = std::max(parallelMaxNodeCount, maxNodes);
+    };
+
+    auto levelStart = std::chrono::steady_clock::now();
+    for (std::size_t leaf = 0; leaf < nleaves; ++leaf) {
+        executor.silent_async([&, leaf]() {
+            auto& package = packages[leaf];
+            package       = std::make_unique<DDPackage>(nqubits);
+            auto matrix   = package->makeIdent(0, static_cast<dd::Qubit>(nqubits - 1));
+            package->incRef(matrix);
+            for (std::size_t i = leaf * ops.size() / nleaves; i < (leaf + 1) * ops.size() / nleaves; ++i) {
+                auto tmp = package->multiply(dd::getDD(ops[i], package), matrix);
+                package->incRef(tmp);
+                package->decRef(matrix);
+                matrix = tmp;
+                package->garbageCollect();
+            }
+            matrices[leaf] = matrix;
+        });
+    }
+    executor.wait_for_all();
+    finishLevel(levelStart, 1);
+
+    // the later operations of each pair are transferred into the package of the earlier ones, whose package is kept
+    for (std::size_t stride = 1; stride < nleaves; stride *= 2) {
+        levelStart = std::chrono::steady_clock::now();
+        for (std::size_t left = 0; left < nleaves; left += 2 * stride) {
+            executor.silent_async([&, left, stride]() {
+                auto&      package = packages[left];
+                const auto right   = left + stride;
+                auto       later   = package->transfer(matrices[right]);
+                package->incRef(later);
+                packages[right]->decRef(matrices[right]);
+
+                auto product = package->multiply(later, matrices[left]);
+                package->incRef(product);
+                package->decRef(later);
+                package->decRef(matrices[left]);
+                matrices[left] = product;
+                package->garbageCollect();
+            });
+        }
+        executor.wait_for_all();
+        finishLevel(levelStart, 2 * stride);
+        for (std::size_t left = 0; left < nleaves; left += 2 * stride) {
+            packages[left + stride].reset();
+        }
+    }
+
+    auto result = Simulator<DDPackage>::dd->transfer(matrices.front());
+    Simulator<DDPackage>::dd->incRef(result);
+    packages.front()->decRef(matrices.front());
+    return result;
+}
+
 template class UnitarySimulator<dd::Package<>>;
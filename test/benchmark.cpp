@@ -1,6 +1,7 @@
 #include "CircuitSimulator.hpp"
 #include "QuantumComputation.hpp"
 #include "Simulator.hpp"
+#include "StochasticNoiseSimulator.hpp"
 
 // clang format wants to put the following include to the top of the file
 // clang-format off
@@ -250,3 +251,44 @@ static void BM_extra_inst4x4_10_0(benchmark::State& state) {
 }
 
 BENCHMARK(BM_extra_inst4x4_10_0)->ComputeStatistics("min", min_estimator);
+
+/**
+ * Cost of setting up a fresh decision diagram package, which every stochastic run had to pay before the packages were
+ * reused across the runs of a worker.
+ */
+static void BM_stoch_package_construction(benchmark::State& state) {
+    const auto n_qubits = static_cast<dd::QubitCount>(state.range(0));
+    for (auto _: state) {
+        auto localDD = std::make_unique<StochasticNoisePackage>(n_qubits);
+        benchmark::DoNotOptimize(localDD);
+    }
+    state.SetLabel("stochastic package construction");
+}
+
+BENCHMARK(BM_stoch_package_construction)->Arg(20)->ComputeStatistics("min", min_estimator);
+
+/**
+ * Trajectories per second with the packages reused across the runs of a worker (second argument 1) and, as the baseline,
+ * with a fresh package for every run (second argument 0).
+ */
+static void BM_stoch_trajectories(benchmark::State& state) {
+    const auto        n_qubits = static_cast<dd::QubitCount>(state.range(0));
+    const bool        reuse    = state.range(1) != 0;
+    const std::size_t runs     = 1000;
+    for (auto _: state) {
+        auto qc = std::make_unique<qc::QuantumComputation>(n_qubits);
+        for (dd::Qubit i = 0; i < n_qubits; i++) {
+            qc->h(i);
+        }
+        for (dd::Qubit i = 0; i < n_qubits - 1; i++) {
+            qc->x(static_cast<dd::Qubit>(i + 1), dd::Control{i});
+        }
+        StochasticNoiseSimulator sim(qc, std::string("APD"), 0.001, std::optional<double>{}, 2, runs, std::string("0"), false, 1, 1.0, 42U);
+        sim.setPackageReuse(reuse);
+        sim.StochSimulate();
+    }
+    state.counters["trajectories"] = benchmark::Counter(static_cast<double>(runs * state.iterations()), benchmark::Counter::kIsRate);
+    state.SetLabel(reuse ? "stochastic trajectories, reused packages" : "stochastic trajectories, package per run");
+}
+
+BENCHMARK(BM_stoch_trajectories)->Args({20, 0})->Args({20, 1})->Unit(benchmark::kMillisecond);
@@ -0,0 +1,182 @@
+#include "CircuitSimulator.hpp"
+#include "DeterministicNoiseSimulator.hpp"
+#include "HybridSchrodingerFeynmanSimulator.hpp"
+#include "PathSimulator.hpp"
+#include "QuantumComputation.hpp"
+#include "ShorFastSimulator.hpp"
+#include "StochasticNoiseSimulator.hpp"
+#include "UnitarySimulator.hpp"
+
+// clang format wants to put the following include to the top of the file
+// clang-format off
+#include "benchmark/benchmark.h"
+// clang-format on
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Regression suite over all simulators. Every benchmark uses fixed circuits and seeds, so the reported times and counters
+ * of two releases are directly comparable. Benchmarks measure their time manually to exclude the construction of the
+ * circuit and the simulator. Run the ddsim_benchmark_suite_json target to obtain a JSON report.
+ */
+
+namespace {
+    auto min_estimator = [](const std::vector<double>& v) -> double {
+        return *(std::min_element(std::begin(v), std::end(v)));
+    };
+
+    // layers of Hadamards and rotations followed by a CNOT ladder, a stand-in for random circuits that is stable across runs
+    std::unique_ptr<qc::QuantumComputation> layeredCircuit(dd::QubitCount nqubits, std::size_t depth) {
+        auto qc = std::make_unique<qc::QuantumComputation>(nqubits);
+        for (dd::Qubit i = 0; i < static_cast<dd::Qubit>(nqubits); ++i) {
+            qc->h(i);
+        }
+        for (std::size_t d = 0; d < depth; ++d) {
+            for (dd::Qubit i = 0; i < static_cast<dd::Qubit>(nqubits); ++i) {
+                qc->rz(i, static_cast<dd::fp>(d + 1U) * dd::PI / static_cast<dd::fp>(i + 2));
+                qc->rx(i, dd::PI / static_cast<dd::fp>(d + 2U));
+            }
+            for (dd::Qubit i = static_cast<dd::Qubit>(d % 2U); i + 1 < static_cast<dd::Qubit>(nqubits); i += 2) {
+                qc->x(static_cast<dd::Qubit>(i + 1), dd::Control{i});
+            }
+        }
+        return qc;
+    }
+
+    std::unique_ptr<qc::QuantumComputation> ghzCircuit(dd::QubitCount nqubits) {
+        auto qc = std::make_unique<qc::QuantumComputation>(nqubits);
+        qc->h(0);
+        for (dd::Qubit i = 0; i + 1 < static_cast<dd::Qubit>(nqubits); ++i) {
+            qc->x(static_cast<dd::Qubit>(i + 1), dd::Control{i});
+        }
+        return qc;
+    }
+
+    template<class F>
+    double measure(F&& f) {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+} // namespace
+
+static void BM_suite_hybrid(benchmark::State& state) {
+    const auto mode     = static_cast<HybridSchrodingerFeynmanSimulator<>::Mode>(state.range(0));
+    const auto nthreads = static_cast<std::size_t>(state.range(1));
+    for (auto _: state) {
+        HybridSchrodingerFeynmanSimulator sim(layeredCircuit(16, 6), ApproximationInfo{}, 42U, mode, nthreads);
+        state.SetIterationTime(measure([&sim]() { sim.Simulate(1); }));
+    }
+    state.SetLabel(mode == HybridSchrodingerFeynmanSimulator<>::Mode::DD ? "hybrid dd" : "hybrid amplitude");
+}
+
+BENCHMARK(BM_suite_hybrid)
+        ->ArgsProduct({{static_cast<long>(HybridSchrodingerFeynmanSimulator<>::Mode::DD), static_cast<long>(HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude)}, {1, 2, 4, 8}})
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+
+static void BM_suite_path(benchmark::State& state) {
+    const auto mode = static_cast<PathSimulator<>::Configuration::Mode>(state.range(0));
+    for (auto _: state) {
+        PathSimulator sim(layeredCircuit(12, 6), PathSimulator<>::Configuration{mode, 2, 0, 42U});
+        state.SetIterationTime(measure([&sim]() { sim.Simulate(1); }));
+    }
+    state.SetLabel("path " + PathSimulator<>::Configuration::modeToString(mode));
+}
+
+// Cotengra paths are planned in Python and have to be passed in explicitly, so the mode is left out here
+BENCHMARK(BM_suite_path)
+        ->Arg(static_cast<long>(PathSimulator<>::Configuration::Mode::Sequential))
+        ->Arg(static_cast<long>(PathSimulator<>::Configuration::Mode::PairwiseRecursiveGrouping))
+        ->Arg(static_cast<long>(PathSimulator<>::Configuration::Mode::BracketGrouping))
+        ->Arg(static_cast<long>(PathSimulator<>::Configuration::Mode::Alternating))
+        ->Arg(static_cast<long>(PathSimulator<>::Configuration::Mode::Auto))
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+
+static void BM_suite_stochastic(benchmark::State& state) {
+    const std::size_t runs = 1000;
+    for (auto _: state) {
+        auto                     qc = layeredCircuit(static_cast<dd::QubitCount>(state.range(0)), 4);
+        StochasticNoiseSimulator sim(qc, std::string("APD"), 0.001, std::optional<double>{}, 2, runs, std::string("0"), false, 1, 1.0, 42U);
+        state.SetIterationTime(measure([&sim]() { sim.StochSimulate(); }));
+    }
+    state.counters["trajectories"] = benchmark::Counter(static_cast<double>(runs), benchmark::Counter::kIsIterationInvariantRate);
+    state.SetLabel("stochastic noise");
+}
+
+BENCHMARK(BM_suite_stochastic)->Arg(12)->Arg(20)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+static void BM_suite_deterministic(benchmark::State& state) {
+    for (auto _: state) {
+        auto                        qc = layeredCircuit(static_cast<dd::QubitCount>(state.range(0)), 4);
+        DeterministicNoiseSimulator sim(qc, std::string("APD"), 0.001, std::optional<double>{}, 2, false, 42U);
+        state.SetIterationTime(measure([&sim]() { benchmark::DoNotOptimize(sim.DeterministicSimulate()); }));
+        state.counters["max_nodes"] = static_cast<double>(sim.getMaxNodeCount());
+    }
+    state.SetLabel("deterministic noise");
+}
+
+BENCHMARK(BM_suite_deterministic)->DenseRange(4, 8, 2)->UseManualTime()->Unit(benchmark::kMillisecond);
+
+static void BM_suite_unitary(benchmark::State& state) {
+    const auto mode = static_cast<UnitarySimulator<>::Mode>(state.range(0));
+    for (auto _: state) {
+        UnitarySimulator sim(layeredCircuit(10, 40), ApproximationInfo{}, 42U, mode);
+        state.SetIterationTime(measure([&sim]() { sim.Construct(); }));
+        state.counters["final_nodes"] = static_cast<double>(sim.getFinalNodeCount());
+    }
+    static const std::array<std::string, 3> modes{"sequential", "recursive", "parallel_recursive"};
+    state.SetLabel("unitary " + modes.at(static_cast<std::size_t>(mode)));
+}
+
+BENCHMARK(BM_suite_unitary)
+        ->Arg(static_cast<long>(UnitarySimulator<>::Mode::Sequential))
+        ->Arg(static_cast<long>(UnitarySimulator<>::Mode::Recursive))
+        ->Arg(static_cast<long>(UnitarySimulator<>::Mode::ParallelRecursive))
+        ->UseManualTime()
+        ->Unit(benchmark::kMillisecond);
+
+static void BM_suite_shor_fast(benchmark::State& state) {
+    const auto composite = static_cast<int>(state.range(0));
+    const auto coprime   = static_cast<int>(state.range(1));
+    for (auto _: state) {
+        ShorFastSimulator sim(composite, coprime, 42ULL);
+        state.SetIterationTime(measure([&sim]() { sim.Simulate(1); }));
+    }
+    state.SetLabel("shor fast");
+}
+
+BENCHMARK(BM_suite_shor_fast)->Args({15, 2})->Args({55, 2})->Args({221, 2})->UseManualTime()->Unit(benchmark::kMillisecond);
+
+static void BM_suite_measure_all_non_collapsing(benchmark::State& state) {
+    CircuitSimulator sim(ghzCircuit(static_cast<dd::QubitCount>(state.range(0))), 42U);
+    sim.Simulate(1);
+    const auto shots = static_cast<unsigned int>(state.range(1));
+    for (auto _: state) {
+        benchmark::DoNotOptimize(sim.MeasureAllNonCollapsing(shots));
+    }
+    state.counters["shots"] = benchmark::Counter(static_cast<double>(shots * state.iterations()), benchmark::Counter::kIsRate);
+    state.SetLabel("sampling");
+}
+
+BENCHMARK(BM_suite_measure_all_non_collapsing)->ArgsProduct({{16, 32}, {1024, 1U << 16U}})->ComputeStatistics("min", min_estimator);
+
+static void BM_suite_get_vector_complex(benchmark::State& state) {
+    CircuitSimulator sim(layeredCircuit(static_cast<dd::QubitCount>(state.range(0)), 2), 42U);
+    sim.Simulate(1);
+    for (auto _: state) {
+        benchmark::DoNotOptimize(sim.getVectorComplex());
+    }
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * (std::int64_t{1} << state.range(0)) * static_cast<std::int64_t>(sizeof(std::complex<dd::fp>)));
+    state.SetLabel("state vector export");
+}
+
+BENCHMARK(BM_suite_get_vector_complex)->DenseRange(12, 20, 4)->Unit(benchmark::kMillisecond)->ComputeStatistics("min", min_estimator);
@@ -1,8 +1,13 @@
+import math
 import unittest
 
 from qiskit import QuantumCircuit, BasicAer
+from qiskit.compiler import assemble
+from qiskit.providers import JobStatus
+from mqt.ddsim.job import JobControl
 from mqt.ddsim.qasmsimulator import QasmSimulator
 from qiskit import execute
+from mqt import ddsim
 
 
 class MQTQasmSimulatorTest(unittest.TestCase):
@@ -74,3 +79,58 @@ class MQTQasmSimulatorTest(unittest.TestCase):
         for key in target.keys():
             self.assertIn(key, counts)
             self.assertLess(abs(target[key] - counts[key]), threshold)
+
+    def test_expectation_values(self):
+        """Test exact expectation values of Pauli observables."""
+        from qiskit.quantum_info import SparsePauliOp
+        bell = QuantumCircuit(2)
+        bell.h(1)
+        bell.cx(1, 0)
+        observable = SparsePauliOp.from_list([('ZZ', 1.0), ('XX', -0.5), ('YY', 2.0), ('IZ', 3.0)])
+        values = self.backend.expectation_values(bell, observable)
+        self.assertAlmostEqual(values[0], 1.0 - 0.5 - 2.0)
+
+        values = self.backend.expectation_values([bell, bell], [[('ZI', 1.0)], [('XX', 1.0)]])
+        self.assertAlmostEqual(values[0], 0.0)
+        self.assertAlmostEqual(values[1], 1.0)
+
+    def test_parameter_sweep(self):
+        """Test that bound instances of a parameterized circuit are simulated as one parameter sweep."""
+        from qiskit.circuit import Parameter
+        theta = Parameter('theta')
+        circuit = QuantumCircuit(2)
+        circuit.ry(theta, 0)
+        circuit.cx(0, 1)
+        circuit.measure_all()
+        shots = 1024
+        result = execute(circuit, self.backend, shots=shots, parameter_binds=[{theta: 0.0}, {theta: math.pi}]).result()
+        self.assertEqual(result.get_counts(0), {'00': shots})
+        self.assertEqual(result.get_counts(1), {'11': shots})
+
+        sweep = ddsim.ParameterSweep(circuit.bind_parameters({theta: 0.0}), nthreads=2)
+        all_counts = sweep.simulate([[0.0], [math.pi], [0.0]], shots)
+        self.assertEqual(all_counts[1], {'11': shots})
+        self.assertEqual(all_counts[2], {'00': shots})
+        with self.assertRaises(ValueError):
+            sweep.simulate_circuits([QuantumCircuit(2)], shots)
+
+    def test_cancellation(self):
+        """Test that cancelled simulations raise and that finished jobs cannot be cancelled anymore."""
+        sim = ddsim.CircuitSimulator(self.circuit, 42)
+        sim.cancel()
+        with self.assertRaises(ddsim.SimulationCancelled):
+            sim.simulate(1024)
+        counts = sim.simulate(1024)
+        self.assertEqual(sum(counts.values()), 1024)
+        self.assertEqual(sim.get_progress().done, sim.get_progress().total)
+
+        control = JobControl()
+        control.cancel()
+        with self.assertRaises(ddsim.SimulationCancelled):
+            self.backend._run_job('cancelled', assemble(self.circuit, self.backend), job_control=control)
+
+        job = execute(self.circuit, self.backend, shots=16)
+        job.result()
+        self.assertFalse(job.cancel())
+        self.assertEqual(job.status(), JobStatus.DONE)
+        self.assertIsNone(job.progress())
@@ -1,4 +1,9 @@
+import os
+import tempfile
 import unittest
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
 
 from qiskit import *
 
@@ -29,3 +34,80 @@ class MQTStandaloneSimulatorTests(unittest.TestCase):
         self.assertEqual(len(result.keys()), 2)
         self.assertIn('000', result.keys())
         self.assertIn('111', result.keys())
+
+    def test_standalone_get_vector(self):
+        circ = QuantumCircuit(3)
+        circ.h(0)
+        circ.cx(0, 1)
+        circ.cx(0, 2)
+
+        sim = ddsim.CircuitSimulator(circ, 1337)
+        sim.simulate(0)
+        vector = sim.get_vector()
+        self.assertEqual(vector.shape, (8,))
+        self.assertAlmostEqual(abs(vector[0]) ** 2, 0.5, places=5)
+        self.assertAlmostEqual(abs(vector[7]) ** 2, 0.5, places=5)
+        self.assertAlmostEqual(abs(vector[1:7]).sum(), 0.0, places=5)
+
+    def test_standalone_memory_mapped_vector(self):
+        circ = QuantumCircuit(3)
+        circ.h(0)
+        circ.cx(0, 1)
+        circ.cx(0, 2)
+
+        with tempfile.TemporaryDirectory() as directory:
+            sim = ddsim.CircuitSimulator(circ, 1337)
+            sim.simulate(0)
+            sim.export_vector(os.path.join(directory, 'vector.bin'))
+            vector = np.memmap(os.path.join(directory, 'vector.bin'), dtype=np.complex128, mode='r')
+            np.testing.assert_allclose(vector, sim.get_vector())
+            del vector
+
+            hybrid = ddsim.HybridCircuitSimulator(circ, mode=ddsim.HybridMode.shared_amplitude)
+            hybrid.set_amplitude_file(os.path.join(directory, 'amplitudes.bin'))
+            hybrid.simulate(0)
+            amplitudes = np.memmap(hybrid.get_amplitude_file(), dtype=np.complex128, mode='r')
+            np.testing.assert_allclose(amplitudes, hybrid.get_final_amplitudes())
+            self.assertAlmostEqual(abs(amplitudes[0]) ** 2, 0.5, places=5)
+            del amplitudes
+
+    def test_standalone_amplitudes(self):
+        circ = QuantumCircuit(3)
+        circ.h(0)
+        circ.cx(0, 1)
+        circ.cx(0, 2)
+
+        for sim in [ddsim.CircuitSimulator(circ, 1337), ddsim.HybridCircuitSimulator(circ, mode=ddsim.HybridMode.amplitude)]:
+            amplitudes = sim.simulate_amplitudes([0, 7, 3])
+            self.assertEqual(set(amplitudes.keys()), {0, 3, 7})
+            self.assertAlmostEqual(abs(amplitudes[0]) ** 2, 0.5, places=5)
+            self.assertAlmostEqual(abs(amplitudes[7]) ** 2, 0.5, places=5)
+            self.assertAlmostEqual(abs(amplitudes[3]), 0.0, places=5)
+
+    def test_standalone_concurrent_simulations(self):
+        circ = QuantumCircuit(3)
+        circ.h(0)
+        circ.cx(0, 1)
+        circ.cx(0, 2)
+
+        def run(seed):
+            return ddsim.CircuitSimulator(circ, seed).simulate(1000)
+
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            results = list(pool.map(run, range(8)))
+        for result in results:
+            self.assertEqual(set(result.keys()), {'000', '111'})
+            self.assertEqual(sum(result.values()), 1000)
+        self.assertEqual(results[3], run(3))
+
+    def test_standalone_deep_circuit_simulator(self):
+        circ = QuantumCircuit(3)
+        circ.h(0)
+        circ.cx(0, 1)
+        circ.cx(0, 2)
+
+        sim = ddsim.DeepCircuitSimulator(circ, 1337)
+        self.assertEqual(sim.simulate(1000), ddsim.CircuitSimulator(circ, 1337).simulate(1000))
+        vector = sim.get_vector()
+        self.assertAlmostEqual(abs(vector[0]) ** 2, 0.5, places=5)
+        self.assertAlmostEqual(abs(vector[7]) ** 2, 0.5, places=5)
@@ -1,8 +1,17 @@
 #include "CircuitSimulator.hpp"
+#include "ParameterSweep.hpp"
 #include "algorithms/Grover.hpp"
+#include "nlohmann/json.hpp"
 
+#include <array>
+#include <complex>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <memory>
+#include <numeric>
+#include <sstream>
 
 TEST(CircuitSimTest, SingleOneQubitGateOnTwoQubitCircuit) {
     auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
@@ -56,6 +65,89 @@ TEST(CircuitSimTest, SingleOneQubitMultiShots) {
     ASSERT_EQ("10", ddsim.AdditionalStatistics().at("single_shots"));
 }
 
+TEST(CircuitSimTest, SingleOneQubitShotBranching) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+    quantumComputation->emplace_back<qc::StandardOperation>(2, 0, qc::H);
+    quantumComputation->emplace_back<qc::NonUnitaryOperation>(2, 0, 0);
+    quantumComputation->emplace_back<qc::StandardOperation>(2, 0, qc::H);
+    CircuitSimulator ddsim(std::move(quantumComputation), ApproximationInfo(), 1337);
+    ddsim.setShotBranching(true);
+
+    const auto m = ddsim.Simulate(1000);
+    ASSERT_EQ("0", ddsim.AdditionalStatistics().at("single_shots"));
+    ASSERT_EQ("2", ddsim.AdditionalStatistics().at("branches"));
+    ASSERT_EQ(m.size(), 2);
+    EXPECT_EQ(m.at("00") + m.at("01"), 1000);
+    EXPECT_NEAR(m.at("01"), 500, 75);
+}
+
+TEST(CircuitSimTest, ShotBranchingKeepsFinalStateUnderGarbageCollection) {
+    for (const auto trigger: {GarbageCollectionPolicy::Trigger::EveryOperation, GarbageCollectionPolicy::Trigger::EveryNOperations}) {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+        quantumComputation->emplace_back<qc::StandardOperation>(2, 0, qc::H);
+        quantumComputation->emplace_back<qc::NonUnitaryOperation>(2, 0, 0);
+        quantumComputation->emplace_back<qc::StandardOperation>(2, 0, qc::H);
+        quantumComputation->emplace_back<qc::StandardOperation>(2, 1, qc::H);
+        CircuitSimulator ddsim(std::move(quantumComputation), ApproximationInfo(), 1337);
+        ddsim.setShotBranching(true);
+        ddsim.setGarbageCollectionPolicy({trigger, 1U});
+
+        // the second simulation releases the state kept by the first one
+        for (std::size_t run = 0; run < 2; ++run) {
+            ddsim.Simulate(1000);
+            const auto amplitudes = ddsim.getVector();
+            ASSERT_EQ(amplitudes.size(), 4);
+            for (const auto& amplitude: amplitudes) {
+                EXPECT_NEAR(amplitude.r * amplitude.r + amplitude.i * amplitude.i, 0.25, 1e-9);
+            }
+        }
+    }
+}
+
+TEST(CircuitSimTest, ClassicControlledOpShotBranching) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+    quantumComputation->emplace_back<qc::StandardOperation>(2, 0, qc::X);
+    quantumComputation->emplace_back<qc::NonUnitaryOperation>(2, 0, 0);
+    std::unique_ptr<qc::Operation> op(new qc::StandardOperation(2, 1, qc::X));
+    quantumComputation->emplace_back<qc::ClassicControlledOperation>(op, quantumComputation->getCregs().at("c"), 1);
+    quantumComputation->emplace_back<qc::NonUnitaryOperation>(2, 1, 1);
+
+    CircuitSimulator ddsim(std::move(quantumComputation), ApproximationInfo(), 42);
+    ddsim.setShotBranching(true);
+
+    const auto m = ddsim.Simulate(100);
+    ASSERT_EQ("1", ddsim.AdditionalStatistics().at("branches"));
+    ASSERT_EQ(m.size(), 1);
+    EXPECT_EQ(m.at("11"), 100);
+}
+
+TEST(CircuitSimTest, BatchedSamplingOfGHZState) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
+    quantumComputation->h(2);
+    quantumComputation->x(1, dd::Control{2});
+    quantumComputation->x(0, dd::Control{1});
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+
+    const auto m = ddsim.Simulate(100000);
+    ASSERT_EQ(m.size(), 2);
+    EXPECT_EQ(m.at("000") + m.at("111"), 100000);
+    EXPECT_NEAR(m.at("111"), 50000, 1000);
+}
+
+TEST(CircuitSimTest, BatchedSamplingBitOrder) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
+    quantumComputation->x(0);
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+
+    const auto m = ddsim.Simulate(10);
+    ASSERT_EQ(m.size(), 1);
+    EXPECT_EQ(m.at("001"), 10);
+
+    const auto indices = ddsim.SampleBasisStateIndices(10);
+    ASSERT_EQ(indices.size(), 1);
+    EXPECT_EQ(indices.at(1), 10);
+}
+
 TEST(CircuitSimTest, BarrierStatement) {
     auto quantumComputation = std::make_unique<qc::QuantumComputation>(1);
     quantumComputation->emplace_back<qc::StandardOperation>(1, 0, qc::H);
@@ -153,6 +245,43 @@ TEST(CircuitSimTest, DestructiveMeasurementOne) {
     }
 }
 
+TEST(CircuitSimTest, DenseExportMatchesPathWalks) {
+    // enough qubits to export in parallel, with shared nodes due to the product structure of the state
+    const dd::QubitCount nQubits            = 17;
+    auto                 quantumComputation = std::make_unique<qc::QuantumComputation>(nQubits);
+    for (dd::Qubit q = 0; q < static_cast<dd::Qubit>(nQubits); ++q) {
+        quantumComputation->h(q);
+        quantumComputation->t(q);
+    }
+    quantumComputation->x(1, dd::Control{static_cast<dd::Qubit>(nQubits - 1)});
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+    ddsim.Simulate(1);
+
+    std::vector<std::complex<dd::fp>> amplitudes(1ULL << nQubits);
+    ddsim.getVectorComplexInto(amplitudes.data(), 4);
+
+    std::string path(nQubits, '0');
+    for (std::size_t i = 0; i < amplitudes.size(); i += 997) {
+        for (dd::Qubit q = 0; q < static_cast<dd::Qubit>(nQubits); ++q) {
+            path[q] = ((i >> q) & 1U) ? '1' : '0';
+        }
+        const auto expected = ddsim.dd->getValueByPath(ddsim.rootEdge, path);
+        EXPECT_NEAR(amplitudes.at(i).real(), expected.r, 1e-12);
+        EXPECT_NEAR(amplitudes.at(i).imag(), expected.i, 1e-12);
+    }
+
+    std::size_t streamed = 0;
+    ddsim.streamVectorComplex(1024, [&](std::size_t offset, const std::complex<dd::fp>* data, std::size_t length) {
+        ASSERT_EQ(offset, streamed);
+        for (std::size_t i = 0; i < length; ++i) {
+            EXPECT_NEAR(std::abs(data[i] - amplitudes.at(offset + i)), 0., 1e-12);
+        }
+        streamed += length;
+    });
+    EXPECT_EQ(streamed, amplitudes.size());
+    EXPECT_THROW(ddsim.streamVectorComplex(1000, [](std::size_t, const std::complex<dd::fp>*, std::size_t) {}), std::invalid_argument);
+}
+
 TEST(CircuitSimTest, ApproximateByFidelity) {
     auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
     quantumComputation->emplace_back<qc::StandardOperation>(3, 0, qc::H);
@@ -244,3 +373,671 @@ TEST(CircuitSimTest, TestingProperties) {
     EXPECT_EQ(ddsim.getMatrixActiveNodeCount(), 0);
     EXPECT_EQ(ddsim.countNodesFromRoot(), 7);
 }
+
+TEST(CircuitSimTest, GateFusionMatchesUnfusedSimulation) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    CircuitSimulator ddsimFused(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    ddsimFused.setGateFusion(2);
+
+    ddsim.Simulate(0);
+    ddsimFused.Simulate(0);
+
+    EXPECT_GT(std::stoul(ddsimFused.AdditionalStatistics()["fused_ops"]), 0U);
+    EXPECT_EQ(ddsim.AdditionalStatistics()["fused_ops"], "0");
+
+    const auto reference = ddsim.getVectorComplex();
+    const auto fused     = ddsimFused.getVectorComplex();
+    ASSERT_EQ(reference.size(), fused.size());
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(reference[i].real(), fused[i].real(), 1e-6);
+        EXPECT_NEAR(reference[i].imag(), fused[i].imag(), 1e-6);
+    }
+}
+
+TEST(CircuitSimTest, GateFusionStopsAtMeasurements) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(2, 2);
+    quantumComputation->emplace_back<qc::StandardOperation>(2, 0, qc::H);
+    quantumComputation->emplace_back<qc::StandardOperation>(2, 0, qc::H);
+    quantumComputation->emplace_back<qc::NonUnitaryOperation>(2, 0, 0);
+    quantumComputation->emplace_back<qc::StandardOperation>(2, 1, qc::X);
+    quantumComputation->emplace_back<qc::StandardOperation>(2, dd::Controls{dd::Control{1}}, 0, qc::X);
+    quantumComputation->emplace_back<qc::NonUnitaryOperation>(2, 0, 1);
+
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+    ddsim.setGateFusion(2);
+    const auto result = ddsim.Simulate(16);
+
+    // H*H is the identity, so qubit 0 is always measured as 0 first and as 1 after the CNOT
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result.begin()->first, "10");
+    EXPECT_EQ(result.begin()->second, 16);
+}
+
+TEST(CircuitSimTest, RepeatedOperationsAreTakenFromCache) {
+    auto quantumComputation = [] {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
+        for (int i = 0; i < 4; ++i) {
+            quantumComputation->emplace_back<qc::StandardOperation>(3, 0, qc::H);
+            quantumComputation->emplace_back<qc::StandardOperation>(3, dd::Controls{dd::Control{0}}, 1, qc::X);
+            quantumComputation->emplace_back<qc::StandardOperation>(3, 2, qc::RZ, 0.25 * i);
+        }
+        return quantumComputation;
+    };
+
+    CircuitSimulator ddsim(quantumComputation());
+    ddsim.Simulate(0);
+    // H and CX are built once and reused three times, every RZ angle is distinct
+    EXPECT_EQ(ddsim.AdditionalStatistics()["op_cache_hits"], "6");
+    EXPECT_EQ(ddsim.AdditionalStatistics()["op_cache_misses"], "6");
+
+    CircuitSimulator ddsimUncached(quantumComputation());
+    ddsimUncached.setOperationCacheCapacity(0);
+    ddsimUncached.Simulate(0);
+    EXPECT_EQ(ddsimUncached.AdditionalStatistics()["op_cache_hits"], "0");
+
+    const auto cached   = ddsim.getVectorComplex();
+    const auto uncached = ddsimUncached.getVectorComplex();
+    for (std::size_t i = 0; i < cached.size(); ++i) {
+        EXPECT_NEAR(cached[i].real(), uncached[i].real(), 1e-9);
+        EXPECT_NEAR(cached[i].imag(), uncached[i].imag(), 1e-9);
+    }
+}
+
+TEST(CircuitSimTest, GarbageCollectionEveryNOperations) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+    for (int i = 0; i < 9; ++i) {
+        quantumComputation->emplace_back<qc::StandardOperation>(2, i % 2, qc::H);
+    }
+    CircuitSimulator ddsim(std::move(quantumComputation));
+    ddsim.setGarbageCollectionPolicy({GarbageCollectionPolicy::Trigger::EveryNOperations, 3U});
+    ddsim.Simulate(0);
+
+    const auto stats = ddsim.AdditionalStatistics();
+    EXPECT_EQ(stats.at("gc_policy"), "every_n_operations");
+    EXPECT_EQ(stats.at("gc_runs"), "3");
+    EXPECT_GT(std::stoul(stats.at("gc_freed_nodes")), 0U);
+}
+
+TEST(CircuitSimTest, GarbageCollectionNodeLimitKeepsResult) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    CircuitSimulator ddsimLimited(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    ddsimLimited.setGarbageCollectionPolicy({GarbageCollectionPolicy::Trigger::NodeLimit, 1U, 256U});
+    EXPECT_THROW(ddsimLimited.setGarbageCollectionPolicy({GarbageCollectionPolicy::Trigger::Adaptive, 1U, 256U, 1.}), std::invalid_argument);
+
+    ddsim.Simulate(0);
+    ddsimLimited.Simulate(0);
+    EXPECT_GT(std::stoul(ddsimLimited.AdditionalStatistics().at("gc_runs")), 0U);
+
+    const auto reference = ddsim.getVectorComplex();
+    const auto limited   = ddsimLimited.getVectorComplex();
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(reference[i].real(), limited[i].real(), 1e-9);
+        EXPECT_NEAR(reference[i].imag(), limited[i].imag(), 1e-9);
+    }
+}
+
+TEST(CircuitSimTest, GarbageCollectionNodeLimitBelowLiveState) {
+    const auto circuit = [] {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(8);
+        for (int layer = 0; layer < 3; ++layer) {
+            for (dd::Qubit q = 0; q < 8; ++q) {
+                quantumComputation->h(q);
+                quantumComputation->rz(q, 0.1 * (q + 1) + layer);
+            }
+            for (dd::Qubit q = 0; q < 7; ++q) {
+                quantumComputation->x(static_cast<dd::Qubit>(q + 1), dd::Control{q});
+            }
+        }
+        // flipping the top qubit only creates a new root node, if any
+        for (int i = 0; i < 200; ++i) {
+            quantumComputation->x(7);
+        }
+        return quantumComputation;
+    };
+    CircuitSimulator ddsim(circuit());
+    CircuitSimulator ddsimLimited(circuit());
+    ddsimLimited.setGarbageCollectionPolicy({GarbageCollectionPolicy::Trigger::NodeLimit, 1U, 32U});
+
+    ddsim.Simulate(0);
+    ddsimLimited.Simulate(0);
+    ASSERT_GT(ddsimLimited.countNodesFromRoot(), 32U);
+    // the tables only grow by a few nodes per flip, so the collections do not follow every operation
+    EXPECT_LT(std::stoul(ddsimLimited.AdditionalStatistics().at("gc_runs")), 100U);
+
+    const auto reference = ddsim.getVectorComplex();
+    const auto limited   = ddsimLimited.getVectorComplex();
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(reference[i].real(), limited[i].real(), 1e-9);
+        EXPECT_NEAR(reference[i].imag(), limited[i].imag(), 1e-9);
+    }
+}
+
+TEST(CircuitSimTest, MemoryLimitStopsSimulationEarly) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    ddsim.setMemoryLimit(1U);
+
+    EXPECT_NO_THROW(ddsim.Simulate(0));
+    EXPECT_TRUE(ddsim.memoryLimitExceeded());
+    EXPECT_EQ(ddsim.AdditionalStatistics().at("memory_limit_aborted_shots"), "1");
+
+    // the next simulation starts afresh
+    ddsim.setMemoryLimit(0U);
+    ddsim.Simulate(0);
+    EXPECT_FALSE(ddsim.memoryLimitExceeded());
+}
+
+TEST(CircuitSimTest, GenerousMemoryLimitKeepsExactResult) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    ddsim.setMemoryLimit(std::size_t{1} << 34U);
+
+    ddsim.Simulate(0);
+    EXPECT_FALSE(ddsim.memoryLimitExceeded());
+    EXPECT_EQ(ddsim.AdditionalStatistics().at("memory_limit_approximations"), "0");
+    EXPECT_DOUBLE_EQ(std::stod(ddsim.AdditionalStatistics().at("final_fidelity")), 1.0);
+}
+
+TEST(CircuitSimTest, ApproximationFidelityMatchesOverlap) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    ddsim.Simulate(0);
+
+    auto original = ddsim.rootEdge;
+    ddsim.dd->incRef(original);
+
+    const double fidelity = ddsim.ApproximateByFidelity(0.9, true, true);
+    EXPECT_LE(fidelity, 1.0 + 1e-9);
+    EXPECT_NEAR(fidelity, ddsim.dd->fidelity(original, ddsim.rootEdge), 1e-6);
+    ddsim.dd->decRef(original);
+}
+
+TEST(CircuitSimTest, ResumeFromCheckpointMatchesFullSimulation) {
+    const auto file = (std::filesystem::temp_directory_path() / "ddsim_test_checkpoint.ckp").string();
+
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), 42U);
+    ddsim.setCheckpointing(file, ddsim.getNumberOfOps() * 2 / 3);
+    ddsim.Simulate(0);
+    ASSERT_EQ(ddsim.getCheckpointsWritten(), 1U);
+    ASSERT_LT(Checkpoint::read(file).opIndex, ddsim.getNumberOfOps());
+
+    CircuitSimulator resumed(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), 42U);
+    resumed.resumeFrom(file);
+    resumed.Simulate(0);
+
+    const auto reference = ddsim.getVectorComplex();
+    const auto result    = resumed.getVectorComplex();
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(reference[i].real(), result[i].real(), 1e-9);
+        EXPECT_NEAR(reference[i].imag(), result[i].imag(), 1e-9);
+    }
+    std::filesystem::remove(file);
+}
+
+TEST(CircuitSimTest, CheckpointsAreWrittenWithGateFusion) {
+    const auto file = (std::filesystem::temp_directory_path() / "ddsim_test_fused_checkpoint.ckp").string();
+
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), 42U);
+    ddsim.setGateFusion(3U);
+    ddsim.setCheckpointing(file, ddsim.getNumberOfOps() / 2);
+    ddsim.Simulate(0);
+    ASSERT_EQ(ddsim.getCheckpointsWritten(), 1U);
+
+    CircuitSimulator resumed(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), 42U);
+    resumed.setGateFusion(3U);
+    resumed.resumeFrom(file);
+    resumed.Simulate(0);
+
+    const auto reference = ddsim.getVectorComplex();
+    const auto result    = resumed.getVectorComplex();
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(reference[i].real(), result[i].real(), 1e-9);
+        EXPECT_NEAR(reference[i].imag(), result[i].imag(), 1e-9);
+    }
+    std::filesystem::remove(file);
+}
+
+TEST(CircuitSimTest, CheckpointOfAnotherCircuitIsRejected) {
+    const auto file    = (std::filesystem::temp_directory_path() / "ddsim_test_other_checkpoint.ckp").string();
+    const auto circuit = [](dd::fp angle) {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+        quantumComputation->h(0);
+        quantumComputation->rz(0, angle);
+        quantumComputation->x(1, dd::Control{0});
+        quantumComputation->h(1);
+        return quantumComputation;
+    };
+
+    CircuitSimulator ddsim(circuit(0.5), 42U);
+    ddsim.setCheckpointing(file, 2U);
+    ddsim.Simulate(0);
+    ASSERT_GE(ddsim.getCheckpointsWritten(), 1U);
+
+    // same number of qubits and operations, but another angle
+    CircuitSimulator edited(circuit(0.25), 42U);
+    edited.resumeFrom(file);
+    EXPECT_THROW(edited.Simulate(0), std::invalid_argument);
+
+    auto longer = circuit(0.5);
+    longer->x(0);
+    CircuitSimulator extended(std::move(longer), 42U);
+    extended.resumeFrom(file);
+    EXPECT_THROW(extended.Simulate(0), std::invalid_argument);
+    std::filesystem::remove(file);
+}
+
+TEST(CircuitSimTest, MappedVectorMatchesVector) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), 42U);
+    ddsim.Simulate(0);
+    const auto reference = ddsim.getVectorComplex();
+
+    const auto file       = (std::filesystem::temp_directory_path() / "ddsim_test_vector.bin").string();
+    auto       anonymous  = ddsim.getVectorComplexMapped({}, 3U);
+    auto       fileBacked = ddsim.getVectorComplexMapped(file, 3U);
+    EXPECT_FALSE(anonymous.isFileBacked());
+    EXPECT_EQ(fileBacked.getFile(), file);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(anonymous.data()) % AmplitudeBuffer::ALIGNMENT, 0U);
+    ASSERT_EQ(anonymous.size(), reference.size());
+    ASSERT_EQ(fileBacked.size(), reference.size());
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_EQ(anonymous[i], reference[i]);
+        EXPECT_EQ(fileBacked[i], reference[i]);
+    }
+
+    // sampling from the chunk-wise prefix sums (of a state spanning several chunks) agrees with sampling from the vector
+    const auto uniform = [] {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(18);
+        for (dd::Qubit q = 0; q < 18; ++q) {
+            quantumComputation->h(q);
+        }
+        return quantumComputation;
+    };
+    CircuitSimulator chunked(uniform(), 42U);
+    CircuitSimulator sequential(uniform(), 42U);
+    chunked.Simulate(0);
+    sequential.Simulate(0);
+    auto chunkedAmplitudes    = chunked.getVectorComplexMapped({}, 2U);
+    auto sequentialAmplitudes = sequential.getVectorComplex();
+    EXPECT_EQ(chunked.SampleFromAmplitudeVectorInPlace(chunkedAmplitudes, 1000U), sequential.SampleFromAmplitudeVectorInPlace(sequentialAmplitudes, 1000U));
+
+    fileBacked.flush();
+    EXPECT_EQ(std::filesystem::file_size(file), reference.size() * sizeof(std::complex<dd::fp>));
+    fileBacked = AmplitudeBuffer{};
+    std::filesystem::remove(file);
+}
+
+TEST(CircuitSimTest, InvalidCheckpointIsRejected) {
+    const auto file = (std::filesystem::temp_directory_path() / "ddsim_test_invalid.ckp").string();
+    std::ofstream(file) << "not a checkpoint";
+
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>(2));
+    EXPECT_THROW(ddsim.resumeFrom(file), std::runtime_error);
+    EXPECT_THROW(ddsim.setCheckpointing(file, 0U), std::invalid_argument);
+    std::filesystem::remove(file);
+}
+
+TEST(CircuitSimTest, TracingRecordsEveryOperation) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
+    quantumComputation->h(0);
+    quantumComputation->x(1, dd::Control{0});
+    quantumComputation->x(2, dd::Control{1});
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+
+    if constexpr (!Tracer::ENABLED) {
+        EXPECT_THROW(ddsim.enableTracing(), std::runtime_error);
+        GTEST_SKIP() << "built without DDSIM_TRACING";
+    }
+    ddsim.enableTracing();
+    ddsim.Simulate(1);
+
+    std::vector<TraceEvent> operations;
+    for (const auto& event: ddsim.getTracer().getEvents()) {
+        if (event.kind == TraceEvent::Kind::Operation) {
+            operations.emplace_back(event);
+        }
+    }
+    ASSERT_EQ(operations.size(), 3);
+    for (std::size_t i = 0; i < operations.size(); ++i) {
+        EXPECT_EQ(operations[i].index, i);
+        EXPECT_GE(operations[i].duration, 0);
+    }
+    // the GHZ state needs more nodes than the initial basis state
+    EXPECT_LT(operations.front().nodesBefore, operations.back().nodesAfter);
+}
+
+TEST(CircuitSimTest, TraceExportFormats) {
+    Tracer     tracer;
+    TraceEvent event{};
+    event.name           = "h";
+    event.duration       = 1500;
+    event.nodesBefore    = 3;
+    event.nodesAfter     = 4;
+    event.computeLookups = 4;
+    event.computeHits    = 1;
+    tracer.record(event);
+
+    std::stringstream csv;
+    tracer.writeCSV(csv);
+    std::string line;
+    std::getline(csv, line);
+    EXPECT_EQ(line.rfind("kind,name,index", 0), 0);
+    std::getline(csv, line);
+    EXPECT_EQ(line, "operation,h,0,0,0,1500,3,4,0,0,4,0.25");
+
+    std::stringstream json;
+    tracer.writeChromeTrace(json);
+    const auto trace = nlohmann::json::parse(json.str());
+    ASSERT_EQ(trace.at("traceEvents").size(), 1);
+    EXPECT_EQ(trace.at("traceEvents").at(0).at("ph"), "X");
+    EXPECT_DOUBLE_EQ(trace.at("traceEvents").at(0).at("dur").get<double>(), 1.5);
+}
+
+TEST(CircuitSimTest, ExpectationValuesOfBellState) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+    quantumComputation->h(1);
+    quantumComputation->x(0, dd::Control{1});
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+    ddsim.Simulate(0);
+
+    EXPECT_NEAR(ddsim.expectationValue({{1., "ZZ"}}), 1., 1e-9);
+    EXPECT_NEAR(ddsim.expectationValue({{1., "XX"}}), 1., 1e-9);
+    EXPECT_NEAR(ddsim.expectationValue({{1., "YY"}}), -1., 1e-9);
+    EXPECT_NEAR(ddsim.expectationValue({{1., "ZI"}}), 0., 1e-9);
+    EXPECT_NEAR(ddsim.expectationValue({{0.5, "II"}, {-2., "XX"}, {0.25, "YY"}}), 0.5 - 2. - 0.25, 1e-9);
+
+    EXPECT_THROW(ddsim.expectationValue({{1., "Z"}}), std::invalid_argument);
+    EXPECT_THROW(ddsim.expectationValue({{1., "ZA"}}), std::invalid_argument);
+}
+
+TEST(CircuitSimTest, ExpectationValueMatchesStateVector) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
+    quantumComputation->h(0);
+    quantumComputation->rx(1, 0.3);
+    quantumComputation->ry(2, 1.1);
+    quantumComputation->x(1, dd::Control{0});
+    quantumComputation->t(2);
+    quantumComputation->x(2, dd::Control{1});
+    quantumComputation->s(0);
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+    ddsim.Simulate(0);
+    const auto amplitudes = ddsim.getVectorComplex();
+
+    // all 64 Pauli strings on three qubits, evaluated on multiple threads
+    PauliSum                                   observable;
+    std::vector<double>                        expected;
+    const std::string                          paulis = "IXYZ";
+    const std::complex<dd::fp>                 i{0., 1.};
+    const std::array<std::complex<dd::fp>, 16> matrices{1., 0., 0., 1., 0., 1., 1., 0., 0., -i, i, 0., 1., 0., 0., -1.};
+    for (std::size_t code = 0; code < 64; ++code) {
+        std::string label(3, 'I');
+        for (std::size_t q = 0; q < 3; ++q) {
+            label[2 - q] = paulis[(code >> (2 * q)) & 3U];
+        }
+        // <psi|P|psi> = sum over k, l of conj(psi_k) P_kl psi_l, where P_kl is the product of the single-qubit entries
+        std::complex<dd::fp> value{};
+        for (std::size_t k = 0; k < amplitudes.size(); ++k) {
+            for (std::size_t l = 0; l < amplitudes.size(); ++l) {
+                std::complex<dd::fp> entry = 1.;
+                for (std::size_t q = 0; q < 3; ++q) {
+                    const auto p = (code >> (2 * q)) & 3U;
+                    entry *= matrices.at(4 * p + 2 * ((k >> q) & 1U) + ((l >> q) & 1U));
+                }
+                value += std::conj(amplitudes[k]) * entry * amplitudes[l];
+            }
+        }
+        observable.push_back({static_cast<double>(code % 7) - 3., label});
+        expected.push_back((static_cast<double>(code % 7) - 3.) * value.real());
+    }
+
+    for (std::size_t t = 0; t < observable.size(); ++t) {
+        EXPECT_NEAR(ddsim.expectationValue({observable[t]}, 1), expected[t], 1e-9) << observable[t].pauli;
+    }
+    EXPECT_NEAR(ddsim.expectationValue(observable, 4), std::accumulate(expected.begin(), expected.end(), 0.), 1e-9);
+}
+
+namespace {
+    std::unique_ptr<qc::QuantumComputation> variationalCircuit(dd::fp a, dd::fp b, dd::fp c) {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+        quantumComputation->h(0);
+        quantumComputation->rx(0, a);
+        quantumComputation->x(1, dd::Control{0});
+        quantumComputation->ry(1, b);
+        quantumComputation->rz(0, c);
+        return quantumComputation;
+    }
+} // namespace
+
+TEST(CircuitSimTest, ParameterSweepMatchesIndividualSimulations) {
+    const std::vector<std::vector<dd::fp>> parameters{{0.1, 0.2, 0.3}, {1.4, -0.7, 2.}, {0., dd::PI, 0.5}, {0.1, 0.2, 0.3}, {2.5, 0.4, -1.}};
+    const PauliSum                         observable{{1., "ZZ"}, {-0.5, "XI"}, {2., "YX"}};
+
+    ParameterSweep sweep(variationalCircuit(0., 0., 0.), std::size_t{2});
+    ASSERT_EQ(sweep.getNumberOfParameters(), 3);
+    const auto values = sweep.ExpectationValues(parameters, observable);
+    ASSERT_EQ(values.size(), parameters.size());
+    for (std::size_t i = 0; i < parameters.size(); ++i) {
+        CircuitSimulator ddsim(variationalCircuit(parameters[i][0], parameters[i][1], parameters[i][2]), 42);
+        ddsim.Simulate(0);
+        EXPECT_NEAR(values[i], ddsim.expectationValue(observable), 1e-9) << "parameter set " << i;
+    }
+    EXPECT_EQ(sweep.parametersOf(*variationalCircuit(1.4, -0.7, 2.)), parameters[1]);
+
+    // the workers are kept, so a second call starts with warm operation caches
+    static_cast<void>(sweep.ExpectationValues(parameters, observable));
+    const auto stats = sweep.AdditionalStatistics();
+    EXPECT_EQ(stats.at("workers"), "2");
+    EXPECT_EQ(stats.at("parameter_sets"), std::to_string(2 * parameters.size()));
+    EXPECT_GT(std::stoull(stats.at("op_cache_hits")), 0U);
+}
+
+TEST(CircuitSimTest, BindingParametersEvictsReplacedOperations) {
+    CircuitSimulator ddsim(variationalCircuit(0., 0., 0.), 42);
+    ddsim.setOperationCacheCapacity(8);
+
+    // many more parameter sets than the cache can hold; the second simulation of every set is served from the cache
+    for (std::size_t i = 0; i < 20; ++i) {
+        const auto angle = 0.1 * static_cast<dd::fp>(i + 1);
+        ddsim.setParameters({angle, 2. * angle, 3. * angle});
+        ddsim.Simulate(0);
+        const auto hitsBefore = std::stoull(ddsim.AdditionalStatistics()["op_cache_hits"]);
+        ddsim.Simulate(0);
+        auto stats = ddsim.AdditionalStatistics();
+        EXPECT_EQ(std::stoull(stats["op_cache_hits"]) - hitsBefore, 5U) << "parameter set " << i;
+        EXPECT_EQ(stats["op_cache_size"], "5") << "parameter set " << i;
+    }
+}
+
+TEST(CircuitSimTest, ParameterSweepIsReproducibleAndChecksItsInput) {
+    const std::vector<std::vector<dd::fp>> parameters{{0.1, 0.2, 0.3}, {1.4, -0.7, 2.}, {0.6, 1.2, 0.5}};
+
+    ParameterSweep first(variationalCircuit(0., 0., 0.), 42ULL, 3);
+    ParameterSweep second(variationalCircuit(0., 0., 0.), 42ULL, 3);
+    EXPECT_EQ(first.Simulate(parameters, 256), second.Simulate(parameters, 256));
+
+    EXPECT_THROW(first.Simulate({{0.1, 0.2}}, 16), std::invalid_argument);
+    auto other = variationalCircuit(0.1, 0.2, 0.3);
+    other->x(0);
+    EXPECT_THROW(static_cast<void>(first.parametersOf(*other)), std::invalid_argument);
+}
+
+TEST(CircuitSimTest, AmplitudeQueriesMatchStateVector) {
+    auto circuit = [] {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(4);
+        for (dd::Qubit q = 0; q < 4; ++q) {
+            quantumComputation->h(q);
+            quantumComputation->rz(q, 0.3 * (q + 1));
+        }
+        for (dd::Qubit q = 0; q < 3; ++q) {
+            quantumComputation->x(static_cast<dd::Qubit>(q + 1), dd::Control{q});
+            quantumComputation->ry(q, 0.7);
+        }
+        quantumComputation->emplace_back<qc::NonUnitaryOperation>(4, 2, qc::Barrier);
+        quantumComputation->t(3);
+        return quantumComputation;
+    };
+    CircuitSimulator reference(circuit(), 42);
+    reference.Simulate(0);
+    const auto amplitudes = reference.getVectorComplex();
+
+    const std::vector<std::size_t> indices{0, 3, 5, 10, 15};
+    for (const std::size_t layers: {0U, 1U, 3U, 100U}) {
+        CircuitSimulator ddsim(circuit(), 42);
+        const auto       result = ddsim.SimulateAmplitudes(indices, layers);
+        ASSERT_EQ(result.size(), indices.size());
+        for (const auto index: indices) {
+            EXPECT_NEAR(result.at(index).real(), amplitudes.at(index).real(), 1e-9) << index << " with " << layers << " layers";
+            EXPECT_NEAR(result.at(index).imag(), amplitudes.at(index).imag(), 1e-9) << index << " with " << layers << " layers";
+        }
+        if (layers == 0) {
+            // without projection, the queries are plain lookups in the final state
+            for (const auto& [index, amplitude]: ddsim.getAmplitudes(indices)) {
+                EXPECT_NEAR(std::abs(amplitude - result.at(index)), 0., 1e-9) << index;
+            }
+        }
+    }
+}
+
+TEST(CircuitSimTest, SessionAppliesOnlyAppendedOperations) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>(2), 42);
+    auto&            circuit = ddsim.getCircuit();
+    circuit.h(0);
+    EXPECT_EQ(ddsim.advance(), 1);
+    circuit.x(1, dd::Control{0});
+    circuit.rz(1, 0.4);
+    EXPECT_EQ(ddsim.advance(), 2);
+    EXPECT_EQ(ddsim.advance(), 0);
+    EXPECT_EQ(ddsim.getAppliedOperations(), 3);
+
+    auto reference = std::make_unique<qc::QuantumComputation>(2);
+    reference->h(0);
+    reference->x(1, dd::Control{0});
+    reference->rz(1, 0.4);
+    CircuitSimulator referenceSim(std::move(reference), 42);
+    referenceSim.Simulate(0);
+
+    const auto amplitudes          = ddsim.getVectorComplex();
+    const auto referenceAmplitudes = referenceSim.getVectorComplex();
+    for (std::size_t i = 0; i < amplitudes.size(); ++i) {
+        EXPECT_NEAR(std::abs(amplitudes[i] - referenceAmplitudes[i]), 0., 1e-9) << i;
+    }
+}
+
+TEST(CircuitSimTest, SessionSnapshotsShareTheirState) {
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>(2), 42);
+    auto&            circuit = ddsim.getCircuit();
+    circuit.h(0);
+    circuit.x(1, dd::Control{0});
+    ddsim.advance();
+    const auto bell = ddsim.snapshot();
+
+    // first continuation: |00> - |11> up to normalization
+    circuit.z(0);
+    ddsim.advance();
+    auto amplitudes = ddsim.getVectorComplex();
+    EXPECT_NEAR(amplitudes[3].real(), -dd::SQRT2_2, 1e-9);
+
+    // second continuation from the same state: |01> + |10>
+    ddsim.restore(bell);
+    EXPECT_EQ(circuit.getNops(), 2);
+    EXPECT_EQ(ddsim.getAppliedOperations(), 2);
+    circuit.x(0);
+    EXPECT_EQ(ddsim.advance(), 1);
+    amplitudes = ddsim.getVectorComplex();
+    EXPECT_NEAR(amplitudes[1].real(), dd::SQRT2_2, 1e-9);
+    EXPECT_NEAR(amplitudes[2].real(), dd::SQRT2_2, 1e-9);
+    EXPECT_NEAR(std::abs(amplitudes[0]), 0., 1e-9);
+
+    ddsim.restore(bell);
+    amplitudes = ddsim.getVectorComplex();
+    EXPECT_NEAR(amplitudes[0].real(), dd::SQRT2_2, 1e-9);
+    EXPECT_NEAR(amplitudes[3].real(), dd::SQRT2_2, 1e-9);
+
+    ddsim.releaseSnapshot(bell);
+    EXPECT_THROW(ddsim.restore(bell), std::invalid_argument);
+}
+
+TEST(CircuitSimTest, StreamMatchesMaterializedCircuit) {
+    auto reference = std::make_unique<qc::QuantumComputation>(4);
+    for (std::size_t layer = 0; layer < 50; ++layer) {
+        for (dd::Qubit q = 0; q < 4; ++q) {
+            reference->h(q);
+            reference->rz(q, 0.1 * static_cast<dd::fp>(layer + 1));
+        }
+        for (dd::Qubit q = 0; q + 1 < 4; ++q) {
+            reference->x(static_cast<dd::Qubit>(q + 1), dd::Control{q});
+        }
+    }
+
+    // a queue of only four operations forces producer and consumer to alternate
+    std::size_t next   = 0;
+    const auto  source = [&reference, &next]() -> std::unique_ptr<qc::Operation> {
+        return next < reference->getNops() ? reference->at(next++)->clone() : nullptr;
+    };
+    CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>(4), 42);
+    ddsim.SimulateStream(source, 0, 4);
+    EXPECT_EQ(ddsim.getStreamedOperations(), reference->getNops());
+    EXPECT_EQ(ddsim.getNumberOfOps(), 0);
+
+    CircuitSimulator referenceSim(std::move(reference), 42);
+    referenceSim.Simulate(0);
+    const auto amplitudes          = ddsim.getVectorComplex();
+    const auto referenceAmplitudes = referenceSim.getVectorComplex();
+    for (std::size_t i = 0; i < amplitudes.size(); ++i) {
+        EXPECT_NEAR(std::abs(amplitudes[i] - referenceAmplitudes[i]), 0., 1e-9) << i;
+    }
+}
+
+TEST(CircuitSimTest, StreamQasmInChunks) {
+    const std::string qasm = "OPENQASM 2.0;\n"
+                             "include \"qelib1.inc\";\n"
+                             "qreg q[3];\n"
+                             "creg c[3];\n"
+                             "h q[0]; // a comment; with a semicolon\n"
+                             "gate bell a, b { h a; cx a, b; }\n"
+                             "cx q[0], q[1];\n"
+                             "cx q[1], q[2];\n"
+                             "barrier q;\n"
+                             "measure q -> c;\n";
+
+    std::istringstream  is(qasm);
+    QasmOperationReader reader(is, 2);
+    CircuitSimulator    ddsim(reader.circuit(), 42);
+    ASSERT_EQ(ddsim.getNumberOfQubits(), 3);
+
+    const auto counts = ddsim.SimulateStream(reader.source(), 1000);
+    EXPECT_EQ(reader.getStatementsRead(), 5);
+    ASSERT_EQ(counts.size(), 2);
+    EXPECT_EQ(counts.at("000") + counts.at("111"), 1000);
+
+    // a measurement followed by further gates collapses the single pass, which cannot be repeated for more shots
+    const std::string   intermediate = "OPENQASM 2.0;\ninclude \"qelib1.inc\";\nqreg q[1];\ncreg c[1];\nh q[0];\nmeasure q[0] -> c[0];\nx q[0];\n";
+    std::istringstream  first(intermediate);
+    QasmOperationReader firstReader(first);
+    CircuitSimulator    intermediateSim(firstReader.circuit(), 42);
+    EXPECT_THROW(intermediateSim.SimulateStream(firstReader.source(), 2), std::invalid_argument);
+
+    std::istringstream  second(intermediate);
+    QasmOperationReader secondReader(second);
+    const auto          single = intermediateSim.SimulateStream(secondReader.source(), 1);
+    ASSERT_EQ(single.size(), 1);
+    EXPECT_EQ(single.begin()->second, 1);
+}
+
+TEST(CircuitSimTest, CancelledSimulationThrowsAndCanBeRepeated) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
+    quantumComputation->h(0);
+    quantumComputation->x(1, dd::Control{0});
+    quantumComputation->x(2, dd::Control{1});
+    CircuitSimulator ddsim(std::move(quantumComputation), 42);
+
+    ddsim.cancel();
+    EXPECT_TRUE(ddsim.cancellationRequested());
+    EXPECT_THROW(ddsim.Simulate(1000), SimulationCancelled);
+    // the request is consumed by the cancelled simulation
+    EXPECT_FALSE(ddsim.cancellationRequested());
+
+    const auto counts = ddsim.SimulateAsync(1000).get();
+    ASSERT_EQ(counts.size(), 2);
+    EXPECT_EQ(counts.at("000") + counts.at("111"), 1000);
+    const auto progress = ddsim.getProgress();
+    EXPECT_EQ(progress.done, 3);
+    EXPECT_EQ(progress.total, 3);
+    EXPECT_GT(progress.nodes, 0);
+}
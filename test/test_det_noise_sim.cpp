@@ -2,6 +2,7 @@
 #include "nlohmann/json.hpp"
 
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <memory>
 
 using namespace dd::literals;
@@ -288,3 +289,67 @@ TEST(DeterministicNoiseSimTest, sampleFromProbabilityMap2) {
         EXPECT_NEAR(result.second, (dd::fp)sampledShots.find(result.first)->second / shots, tolerance);
     }
 }
+
+TEST(DeterministicNoiseSimTest, SparseProbabilitiesOfBellState) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+    quantumComputation->h(0);
+    quantumComputation->x(1, 0_pc);
+    auto ddsim = std::make_unique<DeterministicNoiseSimulator<>>(quantumComputation, std::string("A"), 0, 0, 1);
+
+    const auto sparse = ddsim->DeterministicSimulateSparse();
+
+    ASSERT_EQ(sparse.size(), 2);
+    EXPECT_EQ(sparse[0].first, 0);
+    EXPECT_EQ(sparse[1].first, 3);
+    EXPECT_NEAR(sparse[0].second, 0.5, 1e-12);
+    EXPECT_NEAR(sparse[1].second, 0.5, 1e-12);
+}
+
+TEST(DeterministicNoiseSimTest, SparseProbabilitiesSimulateAdder4Track_D) {
+    auto quantumComputation = detGetAdder4Circuit();
+    auto ddsim              = std::make_unique<DeterministicNoiseSimulator<>>(quantumComputation, std::string("D"), 0.01, std::optional<double>{}, 2);
+
+    const auto sparse = ddsim->DeterministicSimulateSparse();
+
+    for (std::size_t i = 1; i < sparse.size(); ++i) {
+        EXPECT_LT(sparse[i - 1].first, sparse[i].first);
+    }
+    for (const auto& [index, probability]: sparse) {
+        EXPECT_GT(probability, ddsim->getMeasurementThreshold());
+    }
+
+    // indices are little endian, e.g., 9 is the bitstring "1001" with qubit 0 first
+    const auto probabilityOf = [&sparse](std::uint64_t index) {
+        const auto it = std::lower_bound(sparse.begin(), sparse.end(), index, [](const auto& entry, std::uint64_t value) { return entry.first < value; });
+        return (it != sparse.end() && it->first == index) ? it->second : 0.;
+    };
+    double tolerance = 1e-10;
+    EXPECT_NEAR(probabilityOf(0), 0.0332328704931, tolerance);
+    EXPECT_NEAR(probabilityOf(8), 0.0328434857577, tolerance);
+    EXPECT_NEAR(probabilityOf(4), 0.0129643065735, tolerance);
+    EXPECT_NEAR(probabilityOf(1), 0.0683938280189, tolerance);
+    EXPECT_NEAR(probabilityOf(9), 0.7370101351171, tolerance);
+    EXPECT_NEAR(probabilityOf(5), 0.0107812802908, tolerance);
+    EXPECT_NEAR(probabilityOf(13), 0.0275086747656, tolerance);
+    EXPECT_NEAR(probabilityOf(3), 0.0117061689898, tolerance);
+    EXPECT_NEAR(probabilityOf(11), 0.0186346925411, tolerance);
+    EXPECT_NEAR(probabilityOf(7), 0.0160082331009, tolerance);
+}
+
+TEST(DeterministicNoiseSimTest, MeasurementThresholdControlsSparsity) {
+    auto quantumComputation = detGetAdder4Circuit();
+    auto ddsim              = std::make_unique<DeterministicNoiseSimulator<>>(quantumComputation, std::string("APD"), 0.01, std::optional<double>{}, 2);
+
+    EXPECT_THROW(ddsim->setMeasurementThreshold(-1.), std::invalid_argument);
+
+    const auto coarse = ddsim->DeterministicSimulateSparse();
+    ddsim->setMeasurementThreshold(0.);
+    const auto all = ddsim->DeterministicSimulateSparse();
+
+    EXPECT_GT(all.size(), coarse.size());
+    dd::fp total = 0.;
+    for (const auto& [index, probability]: all) {
+        total += probability;
+    }
+    EXPECT_NEAR(total, 1., 1e-6);
+}
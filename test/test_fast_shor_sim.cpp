@@ -1,5 +1,8 @@
+#include "ModularArithmeticCache.hpp"
 #include "ShorFastSimulator.hpp"
+#include "ShorSimulator.hpp"
 
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <memory>
 
@@ -65,4 +68,76 @@ TEST(FastShorSimTest, Factorize221Test) {
 
     ASSERT_EQ(ddsim.getFactors().first, 13);
     ASSERT_EQ(ddsim.getFactors().second, 17);
-}
\ No newline at end of file
+}
+
+// the cache is shared by the whole process, so every test leaves it disabled and empty, even if an assertion fails
+class ModularArithmeticCacheTest: public testing::Test {
+protected:
+    ModularArithmeticCache& cache = ModularArithmeticCache::instance();
+
+    void SetUp() override { cache.clear(); }
+
+    void TearDown() override {
+        cache.setEnabled(false);
+        cache.clear();
+    }
+};
+
+TEST_F(ModularArithmeticCacheTest, IsDisabledByDefault) {
+    ASSERT_FALSE(cache.isEnabled());
+
+    ShorFastSimulator ddsim(15, 2, 5ull);
+    ddsim.Simulate(1);
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.getMisses(), 0);
+}
+
+TEST_F(ModularArithmeticCacheTest, IsSharedBetweenRuns) {
+    cache.setEnabled(true);
+
+    // a single run already looks up some adders repeatedly, but builds each of them only once
+    ShorFastSimulator first(55, 2, 3ull);
+    first.Simulate(1);
+    const auto entries = cache.size();
+    ASSERT_GT(entries, 0);
+    ASSERT_EQ(cache.getMisses(), entries);
+
+    // the second run builds nothing and still finds the factors
+    const auto hits = cache.getHits();
+    ShorFastSimulator second(55, 2, 3ull);
+    second.Simulate(1);
+    EXPECT_EQ(cache.size(), entries);
+    EXPECT_EQ(cache.getMisses(), entries);
+    EXPECT_EQ(cache.getHits() - hits, hits + entries);
+    EXPECT_EQ(second.getFactors().first, 11);
+    EXPECT_EQ(second.getFactors().second, 5);
+
+    // the adders are shared with the emulation of ShorSimulator
+    const auto totalHits = cache.getHits();
+    ShorSimulator emulated(55, 2, 3ull, true, false, false);
+    emulated.Simulate(1);
+    EXPECT_GT(cache.getHits(), totalHits);
+}
+
+TEST_F(ModularArithmeticCacheTest, RoundTripsThroughDisk) {
+    cache.setEnabled(true);
+    ShorFastSimulator ddsim(15, 2, 5ull);
+    ddsim.Simulate(1);
+    const auto entries = cache.size();
+
+    const auto directory = std::filesystem::temp_directory_path() / "ddsim_modular_arithmetic_cache";
+    std::filesystem::remove_all(directory);
+    cache.save(directory.string());
+    cache.clear();
+    ASSERT_EQ(cache.load(directory.string()), entries);
+    EXPECT_EQ(cache.size(), entries);
+
+    ShorFastSimulator reloaded(15, 2, 5ull);
+    reloaded.Simulate(1);
+    EXPECT_EQ(cache.getMisses(), 0);
+    EXPECT_EQ(cache.size(), entries);
+    EXPECT_EQ(reloaded.getFactors().first, 3);
+    EXPECT_EQ(reloaded.getFactors().second, 5);
+
+    std::filesystem::remove_all(directory);
+}
@@ -24,3 +24,28 @@ TEST(GroverSimTest, EmulatedFixedOracleTest) {
     EXPECT_EQ(ddsim.getName(), "emulated_grover_7");
     ASSERT_EQ(ddsim.getPathOfLeastResistance().second.substr(1), ddsim.AdditionalStatistics().at("oracle"));
 }
+
+TEST(GroverSimTest, RepeatedSquaringFindsOracle) {
+    GroverSimulator ddsim("0110011101", 0);
+    ddsim.setIterationStrategy(GroverSimulator::IterationStrategy::RepeatedSquaring);
+    ddsim.Simulate(1);
+
+    ASSERT_EQ(ddsim.getPathOfLeastResistance().second.substr(1), ddsim.AdditionalStatistics().at("oracle"));
+    EXPECT_GT(std::stoul(ddsim.AdditionalStatistics().at("matrix_squarings")), 0U);
+    EXPECT_LT(std::stoul(ddsim.AdditionalStatistics().at("state_multiplications")), GroverSimulator::CalculateIterations(10));
+}
+
+TEST(GroverSimTest, AdaptiveStrategyMatchesUnrolled) {
+    GroverSimulator unrolled("1011001", 0);
+    GroverSimulator adaptive("1011001", 0);
+    adaptive.setIterationStrategy(GroverSimulator::IterationStrategy::Adaptive);
+    unrolled.Simulate(1);
+    adaptive.Simulate(1);
+
+    const auto reference = unrolled.getVectorComplex();
+    const auto result    = adaptive.getVectorComplex();
+    for (std::size_t i = 0; i < reference.size(); ++i) {
+        EXPECT_NEAR(reference[i].real(), result[i].real(), 1e-6);
+        EXPECT_NEAR(reference[i].imag(), result[i].imag(), 1e-6);
+    }
+}
@@ -1,7 +1,11 @@
 #include "HybridSchrodingerFeynmanSimulator.hpp"
 
+#include <complex>
+#include <filesystem>
+#include <fstream>
 #include <gtest/gtest.h>
 #include <memory>
+#include <vector>
 
 using namespace dd::literals;
 
@@ -105,6 +109,29 @@ TEST(HybridSimTest, GRCSTestDD) {
     EXPECT_TRUE(equal);
 }
 
+TEST(HybridSimTest, GRCSTestDDSpilledPartialSums) {
+    auto qc1 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto qc2 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid_dd(std::move(qc1), HybridSchrodingerFeynmanSimulator<>::Mode::DD, 4);
+    CircuitSimulator                  ddsim(std::move(qc2));
+
+    // a budget of a single byte forces every waiting partial sum to be spilled
+    ddsim_hybrid_dd.setMemoryBudget(1);
+    ddsim_hybrid_dd.Simulate(1);
+    ddsim.Simulate(1);
+
+    EXPECT_NE(ddsim_hybrid_dd.AdditionalStatistics().at("spilled_partial_sums"), "0");
+
+    const auto refAmplitudes    = ddsim.getVectorComplex();
+    const auto resultAmplitudes = ddsim_hybrid_dd.getVectorComplex();
+    ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+    for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+        EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+        EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+    }
+}
+
 TEST(HybridSimTest, GRCSTestAmplitudes) {
     auto qc1 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
     auto qc2 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
@@ -129,6 +156,139 @@ TEST(HybridSimTest, GRCSTestAmplitudes) {
     EXPECT_TRUE(equal);
 }
 
+TEST(HybridSimTest, GRCSTestAmplitudesNonPowerOfTwoThreads) {
+    auto qc1 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto qc2 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid_amp(std::move(qc1), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, 3);
+    CircuitSimulator                  ddsim(std::move(qc2));
+
+    ddsim_hybrid_amp.Simulate(0);
+    ddsim.Simulate(0);
+
+    // without a communicator, all slices are simulated by this process
+    const auto stats = ddsim_hybrid_amp.AdditionalStatistics();
+    EXPECT_EQ(std::stoull(stats.at("local_slices")), 1ULL << std::stoull(stats.at("decisions")));
+
+    const auto  refAmplitudes    = ddsim.getVectorComplex();
+    const auto& resultAmplitudes = ddsim_hybrid_amp.getFinalAmplitudes();
+    ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+    for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+        EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+        EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+    }
+}
+
+TEST(HybridSimTest, FewDecisionsNonPowerOfTwoThreads) {
+    // 16 slices that do not split evenly among 3 threads
+    auto quantumComputation = [] {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(4);
+        for (dd::Qubit q = 0; q < 4; ++q) {
+            quantumComputation->emplace_back<qc::StandardOperation>(4, q, qc::H);
+        }
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 1_pc, 2, qc::X);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 2, qc::T);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 2_pc, 1, qc::X);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 1, qc::H);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 0_pc, 3, qc::X);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 3, qc::S);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 3_pc, 0, qc::X);
+        return quantumComputation;
+    };
+
+    CircuitSimulator ddsim(quantumComputation());
+    ddsim.Simulate(0);
+    const auto refAmplitudes = ddsim.getVectorComplex();
+
+    for (const auto mode: {HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, HybridSchrodingerFeynmanSimulator<>::Mode::SharedAmplitude}) {
+        HybridSchrodingerFeynmanSimulator ddsim_hybrid_amp(quantumComputation(), mode, 3);
+        ddsim_hybrid_amp.setSplitQubit(2);
+        ddsim_hybrid_amp.Simulate(0);
+        ASSERT_EQ(ddsim_hybrid_amp.AdditionalStatistics().at("decisions"), "4");
+
+        const auto& resultAmplitudes = ddsim_hybrid_amp.getFinalAmplitudes();
+        ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+        for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+            EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+            EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+        }
+    }
+}
+
+TEST(HybridSimTest, GRCSTestSharedAmplitudes) {
+    auto qc1 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto qc2 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid_amp(std::move(qc1), HybridSchrodingerFeynmanSimulator<>::Mode::SharedAmplitude, 5);
+    CircuitSimulator                  ddsim(std::move(qc2));
+
+    ddsim_hybrid_amp.Simulate(0);
+    ddsim.Simulate(0);
+
+    const auto  refAmplitudes    = ddsim.getVectorComplex();
+    const auto& resultAmplitudes = ddsim_hybrid_amp.getFinalAmplitudes();
+    ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+    for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+        EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+        EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+    }
+}
+
+TEST(HybridSimTest, GRCSTestSharedAmplitudesMappedToFile) {
+    const auto file = (std::filesystem::temp_directory_path() / "ddsim_test_amplitudes.bin").string();
+    auto       qc1  = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto       qc2  = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid_amp(std::move(qc1), HybridSchrodingerFeynmanSimulator<>::Mode::SharedAmplitude, 4);
+    ddsim_hybrid_amp.setAmplitudeFile(file);
+    CircuitSimulator ddsim(std::move(qc2));
+
+    ddsim_hybrid_amp.Simulate(0);
+    ddsim.Simulate(0);
+
+    const auto  refAmplitudes    = ddsim.getVectorComplex();
+    const auto& resultAmplitudes = ddsim_hybrid_amp.getFinalAmplitudes();
+    ASSERT_TRUE(resultAmplitudes.isFileBacked());
+    ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+    for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+        EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+        EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+    }
+
+    // the file holds the raw amplitudes and nothing else
+    ASSERT_EQ(std::filesystem::file_size(file), refAmplitudes.size() * sizeof(std::complex<dd::fp>));
+    std::vector<std::complex<dd::fp>> fileAmplitudes(refAmplitudes.size());
+    std::ifstream(file, std::ios::binary).read(reinterpret_cast<char*>(fileAmplitudes.data()), static_cast<std::streamsize>(std::filesystem::file_size(file)));
+    for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+        EXPECT_EQ(fileAmplitudes[i], resultAmplitudes[i]);
+    }
+    std::filesystem::remove(file);
+}
+
+TEST(HybridSimTest, GRCSTestAmplitudesMappedToFile) {
+    const auto file = (std::filesystem::temp_directory_path() / "ddsim_test_amplitudes_amp.bin").string();
+    auto       qc1  = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto       qc2  = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid_amp(std::move(qc1), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, 4);
+    ddsim_hybrid_amp.setAmplitudeFile(file);
+    CircuitSimulator ddsim(std::move(qc2));
+
+    ddsim_hybrid_amp.Simulate(0);
+    ddsim.Simulate(0);
+
+    const auto  refAmplitudes    = ddsim.getVectorComplex();
+    const auto& resultAmplitudes = ddsim_hybrid_amp.getFinalAmplitudes();
+    ASSERT_TRUE(resultAmplitudes.isFileBacked());
+    ASSERT_EQ(std::filesystem::file_size(file), refAmplitudes.size() * sizeof(std::complex<dd::fp>));
+    ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+    for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+        EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+        EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+    }
+    std::filesystem::remove(file);
+}
+
 TEST(HybridSimTest, GRCSTestFixedSeed) {
     auto qc1 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
     auto qc2 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
@@ -165,3 +325,172 @@ TEST(HybridSimTest, NonStandardOperation) {
     HybridSchrodingerFeynmanSimulator ddsim(std::move(quantumComputation));
     EXPECT_THROW(ddsim.Simulate(0), std::invalid_argument);
 }
+
+TEST(HybridSimTest, AutomaticSplitQubitAvoidsDecisions) {
+    auto quantumComputation = [] {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(4);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 1, qc::H);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 1_pc, 2, qc::X);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 2_pc, 1, qc::X);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 1_pc, 2, qc::X);
+        return quantumComputation;
+    };
+
+    HybridSchrodingerFeynmanSimulator ddsim(quantumComputation(), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude);
+    EXPECT_EQ(ddsim.getNDecisions(2), 3);
+    EXPECT_EQ(ddsim.getNDecisions(1), 0);
+    EXPECT_EQ(ddsim.findBestSplitQubit(), 1);
+
+    ddsim.Simulate(0);
+    EXPECT_EQ(ddsim.AdditionalStatistics().at("split_qubit"), "1");
+    EXPECT_EQ(ddsim.AdditionalStatistics().at("decisions"), "0");
+
+    HybridSchrodingerFeynmanSimulator ddsimFixed(quantumComputation(), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude);
+    ddsimFixed.setSplitQubit(2);
+    ddsimFixed.Simulate(0);
+    EXPECT_EQ(ddsimFixed.AdditionalStatistics().at("split_qubit"), "2");
+    EXPECT_EQ(ddsimFixed.AdditionalStatistics().at("decisions"), "3");
+
+    const auto& amplitudes      = ddsim.getFinalAmplitudes();
+    const auto& fixedAmplitudes = ddsimFixed.getFinalAmplitudes();
+    ASSERT_EQ(amplitudes.size(), fixedAmplitudes.size());
+    for (std::size_t i = 0; i < amplitudes.size(); ++i) {
+        EXPECT_NEAR(amplitudes[i].real(), fixedAmplitudes[i].real(), 1e-6);
+        EXPECT_NEAR(amplitudes[i].imag(), fixedAmplitudes[i].imag(), 1e-6);
+    }
+}
+
+TEST(HybridSimTest, AutomaticSplitQubitSkipsUnsupportedCuts) {
+    auto quantumComputation = [] {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(4);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 0, qc::H);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 1, qc::H);
+        quantumComputation->emplace_back<qc::StandardOperation>(4, 3, qc::H);
+        // both controls end up in the control slice if cut at qubit 2, which is the cheapest cut otherwise
+        quantumComputation->emplace_back<qc::StandardOperation>(4, dd::Controls{0_pc, 1_pc}, 2, qc::X);
+        for (std::size_t i = 0; i < 3; ++i) {
+            quantumComputation->emplace_back<qc::StandardOperation>(4, 2_pc, 3, qc::X);
+            quantumComputation->emplace_back<qc::StandardOperation>(4, 3, qc::T);
+        }
+        return quantumComputation;
+    };
+
+    HybridSchrodingerFeynmanSimulator ddsim(quantumComputation(), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude);
+    EXPECT_EQ(ddsim.findBestSplitQubit(), 1);
+    ddsim.Simulate(0);
+
+    CircuitSimulator reference(quantumComputation());
+    reference.Simulate(0);
+    const auto  refAmplitudes    = reference.getVectorComplex();
+    const auto& resultAmplitudes = ddsim.getFinalAmplitudes();
+    ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+    for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+        EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+        EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+    }
+
+    HybridSchrodingerFeynmanSimulator ddsimFixed(quantumComputation(), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude);
+    ddsimFixed.setSplitQubit(2);
+    EXPECT_THROW(ddsimFixed.Simulate(0), std::invalid_argument);
+}
+
+TEST(HybridSimTest, CheckpointsAreRejected) {
+    HybridSchrodingerFeynmanSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+    EXPECT_FALSE(ddsim.supportsCheckpoints());
+    EXPECT_THROW(ddsim.resumeFrom("ddsim_test_checkpoint.ckp"), std::invalid_argument);
+}
+
+TEST(HybridSimTest, InvalidSplitQubit) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(4);
+    quantumComputation->emplace_back<qc::StandardOperation>(4, 1, qc::H);
+
+    HybridSchrodingerFeynmanSimulator ddsim(std::move(quantumComputation), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude);
+    ddsim.setSplitQubit(4);
+    EXPECT_THROW(ddsim.Simulate(0), std::invalid_argument);
+}
+
+TEST(HybridSimTest, GRCSTestAmplitudeQueries) {
+    auto qc1 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto qc2 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid(std::move(qc1), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, 4);
+    CircuitSimulator                  ddsim(std::move(qc2));
+    ddsim.Simulate(0);
+    const auto refAmplitudes = ddsim.getVectorComplex();
+
+    const std::vector<std::size_t> indices{0, 1, 0xFFFF, 0x1234, 0x8001, 0x1234, 0x00F0};
+    const auto                     amplitudes = ddsim_hybrid.SimulateAmplitudes(indices);
+    ASSERT_EQ(amplitudes.size(), 6);
+    for (const auto& [index, amplitude]: amplitudes) {
+        EXPECT_NEAR(refAmplitudes.at(index).real(), amplitude.real(), 1e-6) << index;
+        EXPECT_NEAR(refAmplitudes.at(index).imag(), amplitude.imag(), 1e-6) << index;
+    }
+    EXPECT_THROW(ddsim_hybrid.SimulateAmplitudes({1U << 16U}), std::invalid_argument);
+}
+
+TEST(HybridSimTest, FewDecisionsFiveThreads) {
+    // alternating CNOTs across the cut at qubit 2, each one being a decision
+    const auto quantumComputation = [](std::size_t ndecisions) {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(4);
+        for (dd::Qubit q = 0; q < 4; ++q) {
+            quantumComputation->emplace_back<qc::StandardOperation>(4, q, qc::H);
+        }
+        for (std::size_t d = 0; d < ndecisions; ++d) {
+            const auto control = static_cast<dd::Qubit>(d % 2 == 0 ? 1 : 2);
+            const auto target  = static_cast<dd::Qubit>(d % 2 == 0 ? 2 : 1);
+            quantumComputation->emplace_back<qc::StandardOperation>(4, dd::Control{control}, target, qc::X);
+            quantumComputation->emplace_back<qc::StandardOperation>(4, target, qc::T);
+            quantumComputation->emplace_back<qc::StandardOperation>(4, static_cast<dd::Qubit>(3 - d % 4), qc::H);
+        }
+        return quantumComputation;
+    };
+
+    // fewer slices than threads, and more slices than threads that are no multiple of them
+    for (const std::size_t ndecisions: {2U, 3U, 5U}) {
+        CircuitSimulator ddsim(quantumComputation(ndecisions));
+        ddsim.Simulate(0);
+        const auto refAmplitudes = ddsim.getVectorComplex();
+
+        HybridSchrodingerFeynmanSimulator ddsim_hybrid_amp(quantumComputation(ndecisions), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, 5);
+        ddsim_hybrid_amp.setSplitQubit(2);
+        ddsim_hybrid_amp.Simulate(0);
+        ASSERT_EQ(ddsim_hybrid_amp.AdditionalStatistics().at("decisions"), std::to_string(ndecisions));
+        const auto& resultAmplitudes = ddsim_hybrid_amp.getFinalAmplitudes();
+        ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+        for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+            EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6) << ndecisions;
+            EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6) << ndecisions;
+        }
+
+        HybridSchrodingerFeynmanSimulator ddsim_hybrid(quantumComputation(ndecisions), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, 5);
+        ddsim_hybrid.setSplitQubit(2);
+        for (const auto& [index, amplitude]: ddsim_hybrid.SimulateAmplitudes({0, 5, 10, 15})) {
+            EXPECT_NEAR(refAmplitudes.at(index).real(), amplitude.real(), 1e-6) << ndecisions;
+            EXPECT_NEAR(refAmplitudes.at(index).imag(), amplitude.imag(), 1e-6) << ndecisions;
+        }
+    }
+}
+
+TEST(HybridSimTest, GRCSTestSlicePackageConfigurations) {
+    auto qc1 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto qc2 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+    auto qc3 = std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt");
+
+    // slices in tuned packages, in default packages, and a plain simulation in a package for deep circuits
+    HybridSchrodingerFeynmanSimulator                               tuned(std::move(qc1), ApproximationInfo{}, 42U, HybridSchrodingerFeynmanSimulator<>::Mode::DD, 4);
+    HybridSchrodingerFeynmanSimulator<dd::Package<>, dd::Package<>> plain(std::move(qc2), ApproximationInfo{}, 42U, HybridSchrodingerFeynmanSimulator<dd::Package<>, dd::Package<>>::Mode::DD, 4);
+    CircuitSimulator<DeepCircuitPackage>                            deep(std::move(qc3), ApproximationInfo{}, 42U);
+
+    tuned.Simulate(0);
+    plain.Simulate(0);
+    deep.Simulate(0);
+
+    const auto tunedAmplitudes = tuned.getVectorComplex();
+    const auto plainAmplitudes = plain.getVectorComplex();
+    const auto deepAmplitudes  = deep.getVectorComplex();
+    ASSERT_EQ(tunedAmplitudes.size(), deepAmplitudes.size());
+    for (std::size_t i = 0; i < deepAmplitudes.size(); ++i) {
+        EXPECT_NEAR(std::abs(tunedAmplitudes[i] - deepAmplitudes[i]), 0., 1e-6);
+        EXPECT_NEAR(std::abs(plainAmplitudes[i] - deepAmplitudes[i]), 0., 1e-6);
+    }
+}
@@ -0,0 +1,92 @@
+#include "CircuitSimulator.hpp"
+#include "HybridSchrodingerFeynmanSimulator.hpp"
+
+#include <complex>
+#include <cstddef>
+#include <gtest/gtest.h>
+#include <memory>
+#include <mpi.h>
+#include <string>
+#include <vector>
+
+namespace {
+    std::vector<std::complex<dd::fp>> referenceAmplitudes() {
+        CircuitSimulator ddsim(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"));
+        ddsim.Simulate(0);
+        return ddsim.getVectorComplex();
+    }
+
+    void checkDistributedAmplitudes(HybridSchrodingerFeynmanSimulator<>::Mode mode) {
+        HybridSchrodingerFeynmanSimulator ddsim_hybrid(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), mode, 2);
+        ddsim_hybrid.setCommunicator(MPI_COMM_WORLD);
+        ddsim_hybrid.Simulate(0);
+
+        // every rank holds the complete result
+        const auto  refAmplitudes    = referenceAmplitudes();
+        const auto& resultAmplitudes = ddsim_hybrid.getFinalAmplitudes();
+        ASSERT_EQ(refAmplitudes.size(), resultAmplitudes.size());
+        for (std::size_t i = 0; i < refAmplitudes.size(); ++i) {
+            EXPECT_NEAR(refAmplitudes[i].real(), resultAmplitudes[i].real(), 1e-6);
+            EXPECT_NEAR(refAmplitudes[i].imag(), resultAmplitudes[i].imag(), 1e-6);
+        }
+
+        // every slice is simulated by exactly one rank
+        auto               stats       = ddsim_hybrid.AdditionalStatistics();
+        unsigned long long localSlices = std::stoull(stats["local_slices"]);
+        unsigned long long totalSlices = 0;
+        MPI_Allreduce(&localSlices, &totalSlices, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+        EXPECT_EQ(totalSlices, 1ULL << std::stoull(stats["decisions"]));
+    }
+} // namespace
+
+TEST(HybridSimMPITest, GRCSTestAmplitudes) {
+    checkDistributedAmplitudes(HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude);
+}
+
+TEST(HybridSimMPITest, GRCSTestSharedAmplitudes) {
+    checkDistributedAmplitudes(HybridSchrodingerFeynmanSimulator<>::Mode::SharedAmplitude);
+}
+
+TEST(HybridSimMPITest, GRCSTestAmplitudeQueries) {
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, 2);
+    ddsim_hybrid.setCommunicator(MPI_COMM_WORLD);
+
+    const auto refAmplitudes = referenceAmplitudes();
+    const auto amplitudes    = ddsim_hybrid.SimulateAmplitudes({0, 1, 0xFFFF, 0x1234, 0x8001});
+    ASSERT_EQ(amplitudes.size(), 5);
+    for (const auto& [index, amplitude]: amplitudes) {
+        EXPECT_NEAR(refAmplitudes.at(index).real(), amplitude.real(), 1e-6) << index;
+        EXPECT_NEAR(refAmplitudes.at(index).imag(), amplitude.imag(), 1e-6) << index;
+    }
+}
+
+TEST(HybridSimMPITest, CancellationOnOneRankCancelsAllRanks) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), HybridSchrodingerFeynmanSimulator<>::Mode::Amplitude, 2);
+    ddsim_hybrid.setCommunicator(MPI_COMM_WORLD);
+    if (rank == 0) {
+        ddsim_hybrid.cancel();
+    }
+    EXPECT_THROW(ddsim_hybrid.Simulate(0), SimulationCancelled);
+
+    // the ranks agree again on the next simulation
+    EXPECT_NO_THROW(ddsim_hybrid.Simulate(0));
+}
+
+TEST(HybridSimMPITest, DistributedDDModeIsRejected) {
+    HybridSchrodingerFeynmanSimulator ddsim_hybrid(std::make_unique<qc::QuantumComputation>("circuits/inst_4x4_10_0.txt"), HybridSchrodingerFeynmanSimulator<>::Mode::DD, 2);
+    ddsim_hybrid.setCommunicator(MPI_COMM_WORLD);
+    EXPECT_THROW(ddsim_hybrid.Simulate(0), std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+    // the slices are only distributed from the thread that initialized MPI
+    int provided = 0;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    ::testing::InitGoogleTest(&argc, argv);
+    const auto result = RUN_ALL_TESTS();
+    MPI_Finalize();
+    return result;
+}
@@ -14,12 +14,14 @@ TEST(TaskBasedSimTest, Configuration) {
     EXPECT_EQ(PathSimulator<>::Configuration::modeToString(PathSimulator<>::Configuration::Mode::BracketGrouping), "bracket");
     EXPECT_EQ(PathSimulator<>::Configuration::modeToString(PathSimulator<>::Configuration::Mode::Alternating), "alternating");
     EXPECT_EQ(PathSimulator<>::Configuration::modeToString(PathSimulator<>::Configuration::Mode::Cotengra), "cotengra");
+    EXPECT_EQ(PathSimulator<>::Configuration::modeToString(PathSimulator<>::Configuration::Mode::Auto), "auto");
 
     EXPECT_EQ(PathSimulator<>::Configuration::modeFromString("sequential"), PathSimulator<>::Configuration::Mode::Sequential);
     EXPECT_EQ(PathSimulator<>::Configuration::modeFromString("pairwise_recursive"), PathSimulator<>::Configuration::Mode::PairwiseRecursiveGrouping);
     EXPECT_EQ(PathSimulator<>::Configuration::modeFromString("bracket"), PathSimulator<>::Configuration::Mode::BracketGrouping);
     EXPECT_EQ(PathSimulator<>::Configuration::modeFromString("alternating"), PathSimulator<>::Configuration::Mode::Alternating);
     EXPECT_EQ(PathSimulator<>::Configuration::modeFromString("cotengra"), PathSimulator<>::Configuration::Mode::Cotengra);
+    EXPECT_EQ(PathSimulator<>::Configuration::modeFromString("auto"), PathSimulator<>::Configuration::Mode::Auto);
 
     auto config = PathSimulator<>::Configuration{};
     config.seed = 12345U;
@@ -189,6 +191,55 @@ TEST(TaskBasedSimTest, GroverCircuitPairwiseGrouping) {
     }
 }
 
+TEST(TaskBasedSimTest, GroverCircuitPairwiseGroupingParallel) {
+    std::unique_ptr<qc::QuantumComputation> qc          = std::make_unique<qc::Grover>(4, 12345);
+    auto                                    grover      = dynamic_cast<qc::Grover*>(qc.get());
+    auto                                    targetValue = grover->targetValue;
+
+    // construct simulator and generate pairwise recursive contraction plan that is executed by multiple threads
+    auto config     = PathSimulator<>::Configuration{};
+    config.mode     = PathSimulator<>::Configuration::Mode::PairwiseRecursiveGrouping;
+    config.nthreads = 4;
+    PathSimulator tbs(std::move(qc), config);
+
+    // simulate circuit
+    auto counts = tbs.Simulate(4096);
+
+    const auto target = targetValue.to_ullong() | (1ULL << 4);
+    auto       c      = tbs.dd->getValueByPath(tbs.rootEdge, target);
+    auto       prob   = c.r * c.r + c.i * c.i;
+    EXPECT_GT(prob, 0.9);
+
+    std::size_t totalCounts = 0;
+    for (const auto& [state, count]: counts) {
+        totalCounts += count;
+    }
+    EXPECT_EQ(totalCounts, 4096);
+}
+
+TEST(TaskBasedSimTest, GroverCircuitAuto) {
+    std::unique_ptr<qc::QuantumComputation> qc          = std::make_unique<qc::Grover>(4, 12345);
+    auto                                    grover      = dynamic_cast<qc::Grover*>(qc.get());
+    auto                                    targetValue = grover->targetValue;
+    const auto                              nops        = qc->getNops();
+
+    // construct simulator and let the planner determine the contraction plan
+    auto config = PathSimulator<>::Configuration{};
+    config.mode = PathSimulator<>::Configuration::Mode::Auto;
+    PathSimulator tbs(std::move(qc), config);
+
+    // every operation is consumed exactly once
+    EXPECT_EQ(tbs.getSimulationPath().components.size(), nops);
+
+    // simulate circuit
+    tbs.Simulate(4096);
+
+    const auto target = targetValue.to_ullong() | (1ULL << 4);
+    auto       c      = tbs.dd->getValueByPath(tbs.rootEdge, target);
+    auto       prob   = c.r * c.r + c.i * c.i;
+    EXPECT_GT(prob, 0.9);
+}
+
 TEST(TaskBasedSimTest, EmptyCircuit) {
     auto qc = std::make_unique<qc::QuantumComputation>(2);
 
@@ -215,6 +215,48 @@ TEST(StochNoiseSimTest, SimulateClassicControlledOpWithError) {
     EXPECT_NEAR(m.find("11")->second, 0.0208816, tolerance);
 }
 
+TEST(StochNoiseSimTest, ChunkedRunsAreMergedCompletely) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(2);
+    quantumComputation->h(0);
+    quantumComputation->measure(0, 0);
+    quantumComputation->measure(1, 1);
+
+    StochasticNoiseSimulator ddsim(quantumComputation, std::string("APD"), 0.01, std::optional<double>{}, 2, 997, std::string("0-3"), false, 1, 1);
+
+    ddsim.StochSimulate();
+
+    unsigned int totalCount = 0U;
+    for (const auto& [state, count]: ddsim.finalClassicalMeasurementsMap) {
+        totalCount += count;
+    }
+    EXPECT_EQ(totalCount, 997U);
+    EXPECT_GE(std::stoul(ddsim.AdditionalStatistics().at("stoch_chunks")), 1U);
+}
+
+TEST(StochNoiseSimTest, AdaptiveRunsStopAtTargetError) {
+    auto                     quantumComputation = stochGetAdder4Circuit();
+    StochasticNoiseSimulator ddsim(quantumComputation, std::string("APD"), 0.001, std::optional<double>{}, 2, 100000, std::string("0-15"), false, 1, 1);
+    ddsim.setTargetError(0.01);
+
+    auto m = ddsim.StochSimulate();
+
+    const auto statistics   = ddsim.AdditionalStatistics();
+    const auto executedRuns = std::stoul(statistics.at("executed_stoch_runs"));
+    EXPECT_LT(executedRuns, 100000U);
+    EXPECT_LE(std::stod(statistics.at("max_error_bar")), 0.01);
+    EXPECT_NEAR(m.find("1001")->second, 0.9, 0.1);
+    for (const auto error: ddsim.finalPropertyErrors) {
+        EXPECT_LE(error, 0.01);
+    }
+}
+
+TEST(StochNoiseSimTest, AdaptiveRunsWithBadParameters) {
+    auto                     quantumComputation = stochGetAdder4Circuit();
+    StochasticNoiseSimulator ddsim(quantumComputation, 1, 1);
+    EXPECT_THROW(ddsim.setTargetError(-0.1), std::invalid_argument);
+    EXPECT_THROW(ddsim.setTargetError(0.01, 1.0), std::invalid_argument);
+}
+
 TEST(StochNoiseSimTest, SimulateAdder4WithoutNoise) {
     auto                     quantumComputation = stochGetAdder4Circuit();
     StochasticNoiseSimulator ddsim(quantumComputation, 1, 1);
@@ -445,3 +487,35 @@ TEST(StochNoiseSimTest, TestingSimulatorFunctionality) {
     EXPECT_EQ(ddsim.countNodesFromRoot(), 0);
     std::cout << ddsim.getName() << "\n";
 }
+
+TEST(StochNoiseSimTest, MemoryLimitDiscardsIncompleteRuns) {
+    auto                     quantumComputation = stochGetAdder4Circuit();
+    StochasticNoiseSimulator ddsim(quantumComputation, std::string("APD"), 0.1, std::optional<double>{}, 2, 1000, std::string("0-15"), false, 1, 1);
+    // a limit below the number of workers must still be enforced in every one of them, however many cores there are
+    ddsim.setMemoryLimit(1U);
+
+    EXPECT_NO_THROW(ddsim.StochSimulate());
+    EXPECT_TRUE(ddsim.memoryLimitExceeded());
+    EXPECT_EQ(ddsim.AdditionalStatistics().at("executed_stoch_runs"), "0");
+
+    // the next simulation starts afresh
+    ddsim.setMemoryLimit(0U);
+    ddsim.StochSimulate();
+    EXPECT_FALSE(ddsim.memoryLimitExceeded());
+    EXPECT_EQ(ddsim.AdditionalStatistics().at("executed_stoch_runs"), "1000");
+}
+
+TEST(StochNoiseSimTest, FreshPackagePerRunGivesSameResult) {
+    auto                     quantumComputation = stochGetAdder4Circuit();
+    StochasticNoiseSimulator reused(quantumComputation, std::string("APD"), 0.1, std::optional<double>{}, 2, 1000, std::string("0-15"), false, 1, 1, 42U);
+    StochasticNoiseSimulator fresh(quantumComputation, std::string("APD"), 0.1, std::optional<double>{}, 2, 1000, std::string("0-15"), false, 1, 1, 42U);
+    fresh.setPackageReuse(false);
+    EXPECT_TRUE(reused.getPackageReuse());
+
+    const auto expected = reused.StochSimulate();
+    const auto result   = fresh.StochSimulate();
+    ASSERT_EQ(expected.size(), result.size());
+    for (const auto& [property, value]: expected) {
+        EXPECT_NEAR(result.at(property), value, 1e-9) << property;
+    }
+}
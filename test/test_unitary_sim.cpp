@@ -1,4 +1,5 @@
 #include "UnitarySimulator.hpp"
+#include "dd/FunctionalityConstruction.hpp"
 
 #include <gtest/gtest.h>
 #include <memory>
@@ -63,3 +64,38 @@ TEST(UnitarySimTest, NonStandardOperation) {
     EXPECT_TRUE(ddsim.getMode() == UnitarySimulator<>::Mode::Recursive);
     EXPECT_THROW(ddsim.Construct(), std::invalid_argument);
 }
+
+TEST(UnitarySimTest, ConstructParallelRecursiveMatchesSequential) {
+    const auto buildCircuit = []() {
+        auto quantumComputation = std::make_unique<qc::QuantumComputation>(3);
+        for (std::size_t i = 0; i < 128; ++i) {
+            quantumComputation->emplace_back<qc::StandardOperation>(3, i % 3, qc::H);
+            quantumComputation->emplace_back<qc::StandardOperation>(3, dd::Controls{dd::Control{static_cast<dd::Qubit>(i % 3)}}, (i + 1) % 3, qc::X);
+            quantumComputation->emplace_back<qc::StandardOperation>(3, (i + 2) % 3, qc::T);
+            quantumComputation->emplace_back<qc::StandardOperation>(3, (i + 1) % 3, qc::RZ, 0.1 * static_cast<dd::fp>(i));
+        }
+        return quantumComputation;
+    };
+
+    UnitarySimulator ddsim(buildCircuit(), UnitarySimulator<>::Mode::ParallelRecursive);
+    ddsim.setThreads(4);
+    ASSERT_NO_THROW(ddsim.Construct());
+    EXPECT_EQ(ddsim.getLevelConstructionTimes().size(), 3U);
+    EXPECT_EQ(ddsim.getLevelMaxNodeCounts().size(), 3U);
+    EXPECT_GT(ddsim.getMaxNodeCount(), 0U);
+
+    const auto circuit   = buildCircuit();
+    const auto reference = dd::buildFunctionality(circuit.get(), ddsim.dd);
+    EXPECT_EQ(ddsim.getConstructedDD(), reference);
+}
+
+TEST(UnitarySimTest, ParallelRecursiveRejectsNonUnitaryOperations) {
+    auto quantumComputation = std::make_unique<qc::QuantumComputation>(1);
+    quantumComputation->emplace_back<qc::StandardOperation>(1, 0, qc::H);
+    quantumComputation->emplace_back<qc::NonUnitaryOperation>(1, 0, 0);
+    quantumComputation->emplace_back<qc::StandardOperation>(1, 0, qc::H);
+    quantumComputation->emplace_back<qc::NonUnitaryOperation>(1, 0, 0);
+
+    UnitarySimulator ddsim(std::move(quantumComputation), UnitarySimulator<>::Mode::ParallelRecursive);
+    EXPECT_THROW(ddsim.Construct(), std::invalid_argument);
+}